@@ -2,15 +2,10 @@
 #define MASTER_H_
 
 #include <conexion.h>
-
-// ORDEN CORRECTO para evitar deadlocks: queries -> workers -> planificacion
-#define LOCK_QUERIES() pthread_mutex_lock(&mutex_queries)
-#define LOCK_WORKERS() pthread_mutex_lock(&mutex_workers)  
-#define LOCK_PLANIFICACION() pthread_mutex_lock(&mutex_planificacion)
-
-#define UNLOCK_QUERIES() pthread_mutex_unlock(&mutex_queries)
-#define UNLOCK_WORKERS() pthread_mutex_unlock(&mutex_workers)
-#define UNLOCK_PLANIFICACION() pthread_mutex_unlock(&mutex_planificacion)
+#include <trama.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 
 // ==================== ESTRUCTURAS ====================
@@ -33,15 +28,46 @@ typedef struct {
     int64_t tiempo_ingreso_ready;
     bool cancelada;
     int ciclos_en_ready;
+    int indice_ready;            // Posición en la cola READY (-1 si no está encolada)
+    bool en_envejecidas;         // Heap de la cola READY donde está la query
+    uint64_t orden_llegada;      // Desempate FIFO dentro de la cola READY
+    uint64_t tick_ingreso_ready; // Tick de aging en el que se fijó 'prioridad'
 } t_query;
 
+typedef struct {
+    t_query** queries;
+    int cantidad;
+    int capacidad;
+} t_heap_queries;
+
+// Cola READY con aging perezoso: 'pendientes' se ordena por (prioridad + tick de
+// ingreso, orden de llegada) y 'envejecidas' (prioridad efectiva 0) por orden de
+// llegada. Con FIFO solo se usa 'pendientes' ordenada por llegada.
+typedef struct {
+    t_heap_queries pendientes;
+    t_heap_queries envejecidas;
+    bool por_prioridad;
+    uint64_t proximo_orden;
+    uint64_t ticks_aging;
+} t_cola_ready;
+
+// Un slot de un proceso Worker: el Worker anuncia en el handshake cuántas queries puede
+// ejecutar a la vez y el Master planifica cada slot como un worker independiente.
+// Los slots de un mismo proceso comparten worker_id y socket.
 typedef struct {
     int worker_id;
     char* worker_id_str; // ID como string (opcional)
+    int slot;            // 0..capacidad-1 dentro del proceso Worker
     int socket_worker;
     bool ocupado;
     bool conectado;
     int query_actual;
+    bool en_pila_libres;         // Está en la pila de workers libres
+    int indice_ejecucion;        // Posición en el heap de workers ocupados (-1 si no está)
+    int prioridad_query_actual;  // Prioridad de la query en ejecución (clave del heap)
+    bool desalojo_pendiente;     // Se pidió DESALOJAR_QUERY y todavía no llegó el contexto
+    const char* motivo_desalojo;
+    t_list* archivos_recientes;  // Solo slot 0: file:tags que el proceso usó últimamente (el más reciente al final)
 } t_worker;
 
 typedef struct {
@@ -51,24 +77,71 @@ typedef struct {
     char* log_level;
 } t_config_master;
 
+// Qué se espera leer de cada descriptor registrado en el epoll del Master
+typedef enum {
+    CONEXION_ESCUCHA,
+    CONEXION_EVENTOS,         // eventfd del planificador
+    CONEXION_AGING,           // timerfd del aging
+    CONEXION_HANDSHAKE,       // Cliente nuevo: falta el código de módulo
+    CONEXION_QUERY_CONTROL,   // Solicitudes [tam_path][path][prioridad]
+    CONEXION_WORKER_ID,       // Worker que todavía no mandó su ID
+    CONEXION_WORKER           // Mensajes [cod_op]([size][paquete])
+} t_tipo_conexion;
+
+// READ de una query que el Master pausó en su Worker (ver frenar_si_saturada)
+typedef struct {
+    uint32_t query_id;
+    int socket_worker;
+} t_lectura_frenada;
+
 typedef struct {
-    int socket_cliente;
-    op_code tipo_modulo;
-} t_args_hilo;
+    int socket;
+    t_tipo_conexion tipo;
+    char* buffer;       // Bytes recibidos que todavía no forman un mensaje completo
+    size_t usados;
+    size_t capacidad;
+    char* salida;       // Bytes por enviar que el socket todavía no aceptó
+    size_t salida_enviados; // Prefijo de 'salida' ya enviado
+    size_t salida_usados;
+    size_t salida_capacidad;
+    uint32_t eventos;       // Eventos registrados en epoll (EPOLLIN/EPOLLOUT)
+    t_list* frenadas;       // Solo Query Control: t_lectura_frenada por su cola de salida
+    t_worker* worker;   // Solo para CONEXION_WORKER: slot 0 del proceso
+    t_list* slots;      // Solo para CONEXION_WORKER: todos los slots (t_worker*)
+} t_conexion;
+
+typedef enum {
+    EVENTO_QUERY_NUEVA,
+    EVENTO_WORKER_LIBRE,
+    EVENTO_WORKER_CONECTADO,
+    EVENTO_WORKER_DESCONECTADO,
+    EVENTO_CAMBIO_PRIORIDAD
+} t_evento_planificacion;
+
+typedef struct {
+    t_evento_planificacion tipo;
+    int id;  // Query o Worker que originó el evento (-1 si no aplica)
+} t_evento_planificador;
+
+// Tope de queries simultáneas que se aceptan de un Worker
+#define MAX_QUERIES_POR_WORKER 64
+
+// File:tags recientes que se recuerdan por Worker para despachar por localidad
+#define MAX_ARCHIVOS_RECIENTES 16
+// Scripts de los que se recuerdan los file:tags (se olvida el que corrió hace más tiempo)
+#define MAX_SCRIPTS_CON_LOCALIDAD 64
+// Workers libres (desde el tope de la pila) que se comparan al despachar por localidad
+#define MAX_CANDIDATOS_LOCALIDAD 8
 
 // ==================== VARIABLES GLOBALES ====================
 
 extern t_log* logger;
 extern t_config_master* config_global;
-extern t_list* lista_queries_ready;
+extern t_cola_ready* cola_ready;
 extern t_list* lista_workers;
 extern t_queue* cola_queries_ready;
 extern int contador_query_id;
 extern int contador_worker_id;
-extern pthread_mutex_t mutex_queries;
-extern pthread_mutex_t mutex_workers;
-extern pthread_mutex_t mutex_planificacion;
-extern pthread_t hilo_aging;
 extern bool sistema_activo;
 
 // ==================== CONFIGURACIÓN ====================
@@ -82,23 +155,43 @@ void inicializar_estructuras_master(void);
 void destruir_estructuras_master(void);
 void iniciar_servidor_master(void);
 
-// ==================== HILOS ====================
+// ==================== CONEXIONES ====================
 
-void* atender_query_control(void* args);
-void* atender_worker(void* args);
-void* proceso_aging(void* args);
+int procesar_solicitud_query_control(int socket_qc, char* path_query, int prioridad);
+bool procesar_lote_query_control(int socket_qc, const char* datos, uint32_t size);
+t_list* registrar_worker(int socket_worker, char* worker_id, uint32_t capacidad);
+void procesar_mensaje_worker(t_worker* worker, op_code cod_op, const t_vista_paquete* vista);
 
 // ==================== PLANIFICACIÓN ====================
 
+void notificar_planificador(t_evento_planificacion evento, int id);
+void detener_planificador(void);
 void planificar_siguiente_query(void);
 void enviar_query_a_worker(t_query* query, t_worker* worker);
 void desalojar_query_de_worker(t_worker* worker, const char* motivo);
 t_worker* obtener_worker_libre(void);
+t_worker* obtener_worker_libre_para(t_query* query);
 t_worker* seleccionar_worker_prioridades(t_query* query_nueva);
 t_worker* obtener_worker_con_menor_prioridad(void);
 t_query* obtener_query_mayor_prioridad(void);
 void actualizar_prioridad_query(t_query* query, int nueva_prioridad);
 
+// ==================== COLA READY ====================
+
+t_cola_ready* cola_ready_crear(bool por_prioridad);
+void cola_ready_destruir(t_cola_ready* cola);
+bool cola_ready_insertar(t_cola_ready* cola, t_query* query);
+t_query* cola_ready_primera(t_cola_ready* cola);
+t_query* cola_ready_extraer_primera(t_cola_ready* cola);
+bool cola_ready_quitar(t_cola_ready* cola, t_query* query);
+void cola_ready_actualizar(t_cola_ready* cola, t_query* query);
+bool cola_ready_envejecer(t_cola_ready* cola);
+int cola_ready_prioridad_efectiva(t_cola_ready* cola, t_query* query);
+int cola_ready_materializar(t_cola_ready* cola, t_query* query);
+int cola_ready_cantidad(t_cola_ready* cola);
+t_query* cola_ready_obtener(t_cola_ready* cola, int indice);
+t_query** cola_ready_copiar(t_cola_ready* cola, int* cantidad);
+
 // ==================== GESTIÓN DE QUERIES ====================
 
 t_query* crear_query(char* path_query, int prioridad, int socket_qc);
@@ -112,28 +205,31 @@ void eliminar_query(t_query* query);
 
 // ==================== GESTIÓN DE WORKERS ====================
 
-void procesar_mensaje_lectura(t_worker* worker);
-void procesar_resultado_read(t_worker* worker);
+void procesar_mensaje_lectura(t_worker* worker, const t_vista_paquete* vista);
+void procesar_resultado_read(t_worker* worker, const t_vista_paquete* vista);
+void procesar_metricas_memoria(t_worker* worker, const t_vista_paquete* vista);
 void procesar_end_worker(t_worker* worker);
-void mostrar_resultado_read_consola(uint32_t query_id, int worker_id, const char* file_tag, uint32_t size_datos, char* datos);
 
 t_worker* crear_worker(int socket_worker);
 void agregar_worker(t_worker* worker);
 void eliminar_worker(t_worker* worker);
 t_worker* buscar_worker_por_id(int worker_id);
-void procesar_mensajes_worker(t_worker* worker);
+t_worker* buscar_worker_por_query(int query_id);
+void worker_pasar_a_libre(t_worker* worker);
+void worker_pasar_a_ocupado(t_worker* worker, t_query* query);
+void worker_quitar_de_indices(t_worker* worker);
+int cantidad_workers_libres(void);
 void procesar_lectura_worker(t_log* logger, t_worker* worker, void* buffer);
-void procesar_finalizacion_worker(t_worker* worker);
-void procesar_error_worker(t_worker* worker);
+void procesar_finalizacion_worker(t_worker* worker, const t_vista_paquete* vista);
+void procesar_error_worker(t_worker* worker, const t_vista_paquete* vista);
+void procesar_contexto_desalojo(t_worker* worker, const t_vista_paquete* vista);
 void manejar_desconexion_worker_inmediata(t_worker* worker);
 
 // ==================== COMUNICACIÓN ====================
 
-void recibir_solicitud_query_control(int socket_qc, char** path_query, int* prioridad);
 void enviar_query_a_ejecutar(t_worker* worker, t_query* query);
 void solicitar_desalojo_worker(t_worker* worker);
-int recibir_contexto_desalojo(t_worker* worker);
-void enviar_finalizacion_a_query_control(int socket_qc, const char* motivo);
+void enviar_finalizacion_a_query_control(int socket_qc, int query_id, const char* motivo);
 
 // ==================== LOGGING ====================
 
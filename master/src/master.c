@@ -5,131 +5,551 @@
 // VARIABLES GLOBALES
 t_log* logger = NULL;
 t_config_master* config_global = NULL;
-t_list* lista_queries_ready = NULL;
+t_cola_ready* cola_ready = NULL;
 t_list* lista_workers = NULL;
 t_queue* cola_queries_ready = NULL;
 int contador_query_id = 0;
 int contador_worker_id = 0;
-pthread_mutex_t mutex_queries;
-pthread_mutex_t mutex_workers;
-pthread_mutex_t mutex_planificacion;
-pthread_t hilo_aging;
 bool sistema_activo = true;
 t_list* lista_todas_queries = NULL;  // Lista para todas las queries
 
-// FUNCIONES AUXILIARES
-void* proceso_aging(void* args) {
-    (void)args;  // no usado
-    log_info(logger, "Proceso de aging iniciado");
-    
-    while (sistema_activo) {
-        usleep(config_global->tiempo_aging * 1000); // Convertir ms a microsegundos
-        
-        pthread_mutex_lock(&mutex_queries);
+// Índices hash para búsquedas O(1): queries por id y por socket de Query Control
+// y workers por id. Todo el estado del Master lo usa solo el hilo del reactor: no hay locks.
+static t_dictionary* queries_por_id = NULL;       // "id" -> t_query*
+static t_dictionary* queries_por_socket = NULL;   // "socket" -> t_list* de t_query*
+static t_dictionary* workers_por_id = NULL;       // "id" -> t_worker* (slot 0 del proceso)
+static t_dictionary* workers_por_query = NULL;    // "query_id" -> t_worker* (slot que la ejecuta)
+
+// Localidad: file:tags que tocó cada script en su última
+// ejecución, según las métricas de memoria que informa el Worker al terminarla
+static t_dictionary* archivos_por_script = NULL;  // "path_query" -> t_list* de char*
+static t_list* scripts_por_antiguedad = NULL;     // Claves de archivos_por_script, el más viejo primero
+static char* clave_indice(int id, char* buffer, size_t tamanio);
+static bool enviar_a_conexion(int socket, const struct iovec* iov, int cantidad);
+static void enviar_paquete_a_conexion(t_paquete* paquete, int socket);
+static void frenar_si_saturada(int socket_qc, uint32_t query_id, int socket_worker);
+static void destruir_lista_archivos(t_list* archivos);
+
+// Índices de workers: pila de workers libres y
+// heap de workers ocupados con la query de menor prioridad (mayor número) arriba
+static t_list* pila_workers_libres = NULL;
+static t_worker** workers_en_ejecucion = NULL;
+static int cantidad_en_ejecucion = 0;
+static int capacidad_en_ejecucion = 0;
+
+// Eventos pendientes para el planificador; el eventfd despierta al reactor
+static t_queue* cola_eventos_planificacion = NULL;
+static int fd_eventos_planificacion = -1;
+
+// COLA READY
+// Dos heaps binarios de queries en READY. Cada query guarda su posición (indice_ready),
+// así quitarla o reubicarla tras un cambio de prioridad es O(log n) sin recorrer la cola.
+//
+// El aging es perezoso: un tick solo incrementa ticks_aging. La prioridad efectiva de una
+// query es max(0, prioridad - (ticks_aging - tick_ingreso_ready)), y como prioridad +
+// tick_ingreso_ready no cambia con los ticks, 'pendientes' se ordena por esa clave.
+// Las que ya llegaron a 0 pasan a 'envejecidas', donde solo importa el orden de llegada.
+t_cola_ready* cola_ready_crear(bool por_prioridad) {
+    t_cola_ready* cola = malloc(sizeof(t_cola_ready));
+    if (cola == NULL) return NULL;
+
+    t_heap_queries* heaps[] = { &cola->pendientes, &cola->envejecidas };
+    for (int i = 0; i < 2; i++) {
+        heaps[i]->capacidad = 16;
+        heaps[i]->cantidad = 0;
+        heaps[i]->queries = malloc(heaps[i]->capacidad * sizeof(t_query*));
+    }
+    if (cola->pendientes.queries == NULL || cola->envejecidas.queries == NULL) {
+        free(cola->pendientes.queries);
+        free(cola->envejecidas.queries);
+        free(cola);
+        return NULL;
+    }
 
-        bool hubo_cambios = false;
-        int cantidad_queries_ready = 0;
-        
-        // Incrementar ciclos y aplicar aging a queries en READY
-        for (int i = 0; i < list_size(lista_queries_ready); i++) {
-            t_query* query = list_get(lista_queries_ready, i);
-            
-            if (query->estado == QUERY_READY) {
-                cantidad_queries_ready++;
-                
-                // Incrementar contador de ciclos
-                query->ciclos_en_ready++;
-                
-                // Solo aplicar aging si tiene prioridad > 0
-                if (query->prioridad > 0) {
-                    // Aplicar aging cada ciclo (reducir en 1)
-                    if (query->ciclos_en_ready >= 1) {
-                        int prioridad_anterior = query->prioridad;
-                        int nueva_prioridad = query->prioridad - 1;
-                        
-                        if (nueva_prioridad < 0) {
-                            nueva_prioridad = 0;  // No puede ser menor que 0
-                        }
-                        
-                        actualizar_prioridad_query(query, nueva_prioridad);
-                        query->ciclos_en_ready = 0; // Reiniciar contador
-                        
-                        hubo_cambios = true;
-                        
-                        log_info(logger, "┌────────────────────────────────────────┐");
-                        log_info(logger, "│         AGING APLICADO                 │");
-                        log_info(logger, "├────────────────────────────────────────┤");
-                        log_info(logger, "│ Query ID:  %-27d │", query->query_id);
-                        log_info(logger, "│ Prioridad: %d -> %-21d │", prioridad_anterior, nueva_prioridad);
-                        log_info(logger, "└────────────────────────────────────────┘");
-                    }
-                } else {
-                    log_debug(logger, "Query %d ya tiene prioridad 0 (máxima)", query->query_id);
-                }
-            }
+    cola->por_prioridad = por_prioridad;
+    cola->proximo_orden = 0;
+    cola->ticks_aging = 0;
+    return cola;
+}
+
+// No libera las queries: pertenecen a lista_todas_queries
+void cola_ready_destruir(t_cola_ready* cola) {
+    if (cola == NULL) return;
+    for (int i = 0; i < cola_ready_cantidad(cola); i++) {
+        cola_ready_obtener(cola, i)->indice_ready = -1;
+    }
+    free(cola->pendientes.queries);
+    free(cola->envejecidas.queries);
+    free(cola);
+}
+
+static int64_t clave_aging(t_query* query) {
+    return (int64_t)query->prioridad + (int64_t)query->tick_ingreso_ready;
+}
+
+// En 'pendientes' manda la clave de aging (menor = más prioritaria); a igual clave, y
+// siempre en 'envejecidas' o con FIFO, la que llegó antes
+static bool cola_ready_precede(t_cola_ready* cola, t_heap_queries* heap, t_query* a, t_query* b) {
+    if (cola->por_prioridad && heap == &cola->pendientes && clave_aging(a) != clave_aging(b)) {
+        return clave_aging(a) < clave_aging(b);
+    }
+    return a->orden_llegada < b->orden_llegada;
+}
+
+static void heap_ubicar(t_heap_queries* heap, int indice, t_query* query) {
+    heap->queries[indice] = query;
+    query->indice_ready = indice;
+}
+
+static void heap_subir(t_cola_ready* cola, t_heap_queries* heap, int indice) {
+    t_query* query = heap->queries[indice];
+    while (indice > 0) {
+        int padre = (indice - 1) / 2;
+        if (!cola_ready_precede(cola, heap, query, heap->queries[padre])) break;
+        heap_ubicar(heap, indice, heap->queries[padre]);
+        indice = padre;
+    }
+    heap_ubicar(heap, indice, query);
+}
+
+static void heap_bajar(t_cola_ready* cola, t_heap_queries* heap, int indice) {
+    t_query* query = heap->queries[indice];
+    while (true) {
+        int hijo = 2 * indice + 1;
+        if (hijo >= heap->cantidad) break;
+        if (hijo + 1 < heap->cantidad && cola_ready_precede(cola, heap, heap->queries[hijo + 1], heap->queries[hijo])) {
+            hijo++;
         }
-        
-        pthread_mutex_unlock(&mutex_queries);
-        
-        // Replanificar solo si hubo cambios de prioridad
-        if (hubo_cambios) {
-            log_info(logger, "Aging: Replanificando por cambios de prioridad...");
-            planificar_siguiente_query();
-        } else if (cantidad_queries_ready > 0) {
-            log_debug(logger, "Aging: %d queries en READY pero sin cambios de prioridad", 
-                     cantidad_queries_ready);
+        if (!cola_ready_precede(cola, heap, heap->queries[hijo], query)) break;
+        heap_ubicar(heap, indice, heap->queries[hijo]);
+        indice = hijo;
+    }
+    heap_ubicar(heap, indice, query);
+}
+
+static bool heap_insertar(t_cola_ready* cola, t_heap_queries* heap, t_query* query) {
+    if (heap->cantidad == heap->capacidad) {
+        t_query** ampliada = realloc(heap->queries, 2 * heap->capacidad * sizeof(t_query*));
+        if (ampliada == NULL) {
+            log_error(logger, "Error al ampliar la cola READY");
+            return false;
         }
+        heap->queries = ampliada;
+        heap->capacidad *= 2;
     }
-    
-    log_info(logger, "Proceso de aging finalizado");
+
+    query->en_envejecidas = (heap == &cola->envejecidas);
+    heap_ubicar(heap, heap->cantidad, query);
+    heap->cantidad++;
+    heap_subir(cola, heap, query->indice_ready);
+    return true;
+}
+
+static void heap_quitar(t_cola_ready* cola, t_heap_queries* heap, t_query* query) {
+    int indice = query->indice_ready;
+    query->indice_ready = -1;
+    heap->cantidad--;
+    if (indice == heap->cantidad) return;
+
+    // El último ocupa el hueco y se reubica hacia arriba o hacia abajo
+    t_query* movida = heap->queries[heap->cantidad];
+    heap_ubicar(heap, indice, movida);
+    heap_subir(cola, heap, indice);
+    heap_bajar(cola, heap, movida->indice_ready);
+}
+
+static t_heap_queries* heap_de(t_cola_ready* cola, t_query* query) {
+    t_heap_queries* heap = query->en_envejecidas ? &cola->envejecidas : &cola->pendientes;
+    int indice = query->indice_ready;
+    if (indice < 0 || indice >= heap->cantidad || heap->queries[indice] != query) return NULL;
+    return heap;
+}
+
+// Ubica la query según su prioridad actual, conservando su orden de llegada
+static bool cola_ready_ubicar(t_cola_ready* cola, t_query* query) {
+    query->tick_ingreso_ready = cola->ticks_aging;
+    if (cola->por_prioridad && query->prioridad <= 0) {
+        return heap_insertar(cola, &cola->envejecidas, query);
+    }
+    return heap_insertar(cola, &cola->pendientes, query);
+}
+
+// Pasa a 'envejecidas' las queries cuya prioridad efectiva ya llegó a 0.
+// Cada query migra una sola vez, así que el costo se amortiza entre los ticks.
+static void cola_ready_migrar_envejecidas(t_cola_ready* cola) {
+    if (!cola->por_prioridad) return;
+
+    while (cola->pendientes.cantidad > 0 &&
+           clave_aging(cola->pendientes.queries[0]) <= (int64_t)cola->ticks_aging) {
+        t_query* query = cola->pendientes.queries[0];
+        heap_quitar(cola, &cola->pendientes, query);
+        heap_insertar(cola, &cola->envejecidas, query);
+    }
+}
+
+// Devuelve false si la query ya estaba encolada
+bool cola_ready_insertar(t_cola_ready* cola, t_query* query) {
+    if (query->indice_ready >= 0) return false;
+
+    query->orden_llegada = cola->proximo_orden++;
+    query->tiempo_ingreso_ready = temporal_get_timestamp();
+    return cola_ready_ubicar(cola, query);
+}
+
+t_query* cola_ready_primera(t_cola_ready* cola) {
+    cola_ready_migrar_envejecidas(cola);
+    if (cola->envejecidas.cantidad > 0) return cola->envejecidas.queries[0];
+    if (cola->pendientes.cantidad > 0) return cola->pendientes.queries[0];
     return NULL;
 }
 
-t_query* obtener_query_mayor_prioridad(void) {
-    if (list_is_empty(lista_queries_ready)) {
+t_query* cola_ready_extraer_primera(t_cola_ready* cola) {
+    t_query* primera = cola_ready_primera(cola);
+    if (primera != NULL) {
+        cola_ready_quitar(cola, primera);
+    }
+    return primera;
+}
+
+bool cola_ready_quitar(t_cola_ready* cola, t_query* query) {
+    t_heap_queries* heap = heap_de(cola, query);
+    if (heap == NULL) return false;
+
+    // Al salir de READY la query se lleva el aging acumulado
+    query->prioridad = cola_ready_prioridad_efectiva(cola, query);
+    heap_quitar(cola, heap, query);
+    return true;
+}
+
+// Reubica la query después de asignarle una nueva prioridad (decrease-key / increase-key)
+void cola_ready_actualizar(t_cola_ready* cola, t_query* query) {
+    t_heap_queries* heap = heap_de(cola, query);
+    if (heap == NULL) return;
+
+    heap_quitar(cola, heap, query);
+    cola_ready_ubicar(cola, query);
+}
+
+// Tick de aging: O(1), las prioridades se recalculan recién al consultarlas.
+// Devuelve true si alguna query en READY todavía tenía prioridad mayor a 0.
+bool cola_ready_envejecer(t_cola_ready* cola) {
+    cola_ready_migrar_envejecidas(cola);
+    cola->ticks_aging++;
+    return cola->pendientes.cantidad > 0;
+}
+
+int cola_ready_prioridad_efectiva(t_cola_ready* cola, t_query* query) {
+    if (!cola->por_prioridad || query->indice_ready < 0) return query->prioridad;
+
+    int64_t efectiva = clave_aging(query) - (int64_t)cola->ticks_aging;
+    return efectiva > 0 ? (int)efectiva : 0;
+}
+
+// Vuelca el aging acumulado en query->prioridad sin moverla de la cola (la clave no cambia)
+int cola_ready_materializar(t_cola_ready* cola, t_query* query) {
+    if (heap_de(cola, query) == NULL) return query->prioridad;
+
+    query->prioridad = cola_ready_prioridad_efectiva(cola, query);
+    query->tick_ingreso_ready = cola->ticks_aging;
+    return query->prioridad;
+}
+
+int cola_ready_cantidad(t_cola_ready* cola) {
+    return cola->envejecidas.cantidad + cola->pendientes.cantidad;
+}
+
+// Acceso en orden de heap (no ordenado), para recorrer la cola
+t_query* cola_ready_obtener(t_cola_ready* cola, int indice) {
+    if (indice < 0) return NULL;
+    if (indice < cola->envejecidas.cantidad) return cola->envejecidas.queries[indice];
+    indice -= cola->envejecidas.cantidad;
+    if (indice < cola->pendientes.cantidad) return cola->pendientes.queries[indice];
+    return NULL;
+}
+
+// Copia de los punteros encolados, para recorrer mientras la cola se modifica
+t_query** cola_ready_copiar(t_cola_ready* cola, int* cantidad) {
+    *cantidad = cola_ready_cantidad(cola);
+    if (*cantidad == 0) return NULL;
+
+    t_query** copia = malloc(*cantidad * sizeof(t_query*));
+    if (copia == NULL) {
+        *cantidad = 0;
         return NULL;
     }
-    
-    t_query* query_mayor = NULL;
-    int index_mayor = -1;
-    int mayor_prioridad = 999999;
-   
-    // Buscar la query con MENOR número (mayor prioridad)
-    // En caso de empate, se toma la primera (orden de llegada)
-    for (int i = 0; i < list_size(lista_queries_ready); i++) {
-        t_query* query = list_get(lista_queries_ready, i);
-        
-        if (query->estado == QUERY_READY && query->prioridad < mayor_prioridad) {
-            mayor_prioridad = query->prioridad;
-            query_mayor = query;
-            index_mayor = i;
+    for (int i = 0; i < *cantidad; i++) {
+        copia[i] = cola_ready_obtener(cola, i);
+    }
+    return copia;
+}
+
+// FUNCIONES AUXILIARES
+// Tick de aging (timerfd del reactor). Es O(1): cada query descuenta los ticks
+// transcurridos al consultarse.
+static void aplicar_tick_aging(void) {
+    bool hubo_cambios = cola_ready_envejecer(cola_ready);
+    int cantidad_queries_ready = cola_ready_cantidad(cola_ready);
+    
+    // Replanificar solo si hubo cambios de prioridad
+    if (hubo_cambios) {
+        log_debug(logger, "Aging: tick aplicado a %d queries en READY, replanificando...",
+                  cantidad_queries_ready);
+        notificar_planificador(EVENTO_CAMBIO_PRIORIDAD, -1);
+    } else if (cantidad_queries_ready > 0) {
+        log_debug(logger, "Aging: %d queries en READY pero sin cambios de prioridad", 
+                 cantidad_queries_ready);
+    }
+}
+
+// ÍNDICES DE WORKERS
+static void ejecucion_ubicar(int indice, t_worker* worker) {
+    workers_en_ejecucion[indice] = worker;
+    worker->indice_ejecucion = indice;
+}
+
+static void ejecucion_subir(int indice) {
+    t_worker* worker = workers_en_ejecucion[indice];
+    while (indice > 0) {
+        int padre = (indice - 1) / 2;
+        if (workers_en_ejecucion[padre]->prioridad_query_actual >= worker->prioridad_query_actual) break;
+        ejecucion_ubicar(indice, workers_en_ejecucion[padre]);
+        indice = padre;
+    }
+    ejecucion_ubicar(indice, worker);
+}
+
+static void ejecucion_bajar(int indice) {
+    t_worker* worker = workers_en_ejecucion[indice];
+    while (true) {
+        int hijo = 2 * indice + 1;
+        if (hijo >= cantidad_en_ejecucion) break;
+        if (hijo + 1 < cantidad_en_ejecucion &&
+            workers_en_ejecucion[hijo + 1]->prioridad_query_actual > workers_en_ejecucion[hijo]->prioridad_query_actual) {
+            hijo++;
         }
+        if (workers_en_ejecucion[hijo]->prioridad_query_actual <= worker->prioridad_query_actual) break;
+        ejecucion_ubicar(indice, workers_en_ejecucion[hijo]);
+        indice = hijo;
     }
-    
-    if (query_mayor != NULL && index_mayor != -1) {
-        list_remove(lista_queries_ready, index_mayor);
+    ejecucion_ubicar(indice, worker);
+}
+
+static void ejecucion_quitar(t_worker* worker) {
+    int indice = worker->indice_ejecucion;
+    if (indice < 0 || indice >= cantidad_en_ejecucion || workers_en_ejecucion[indice] != worker) return;
+
+    worker->indice_ejecucion = -1;
+    cantidad_en_ejecucion--;
+    if (indice == cantidad_en_ejecucion) return;
+
+    t_worker* movido = workers_en_ejecucion[cantidad_en_ejecucion];
+    ejecucion_ubicar(indice, movido);
+    ejecucion_subir(indice);
+    ejecucion_bajar(movido->indice_ejecucion);
+}
+
+static void ejecucion_insertar(t_worker* worker) {
+    if (cantidad_en_ejecucion == capacidad_en_ejecucion) {
+        int nueva_capacidad = capacidad_en_ejecucion > 0 ? 2 * capacidad_en_ejecucion : 16;
+        t_worker** ampliado = realloc(workers_en_ejecucion, nueva_capacidad * sizeof(t_worker*));
+        if (ampliado == NULL) {
+            log_error(logger, "Error al ampliar el índice de workers en ejecución");
+            return;
+        }
+        workers_en_ejecucion = ampliado;
+        capacidad_en_ejecucion = nueva_capacidad;
+    }
+    ejecucion_ubicar(cantidad_en_ejecucion, worker);
+    cantidad_en_ejecucion++;
+    ejecucion_subir(worker->indice_ejecucion);
+}
+
+static void pila_libres_quitar(t_worker* worker) {
+    if (!worker->en_pila_libres) return;
+
+    // Casi siempre es el tope (recién liberado o recién sacado para asignarlo)
+    int ultimo = list_size(pila_workers_libres) - 1;
+    if (ultimo >= 0 && list_get(pila_workers_libres, ultimo) == worker) {
+        list_remove(pila_workers_libres, ultimo);
+    } else {
+        list_remove_element(pila_workers_libres, worker);
+    }
+    worker->en_pila_libres = false;
+}
+
+static void olvidar_query_del_worker(t_worker* worker) {
+    if (worker->query_actual < 0) return;
+
+    char clave[16];
+    clave_indice(worker->query_actual, clave, sizeof(clave));
+    if (dictionary_get(workers_por_query, clave) == worker) {
+        dictionary_remove(workers_por_query, clave);
     }
-    
-    return query_mayor;
+}
+
+// El worker terminó, fue desalojado o se acaba de conectar
+void worker_pasar_a_libre(t_worker* worker) {
+    ejecucion_quitar(worker);
+    olvidar_query_del_worker(worker);
+    worker->ocupado = false;
+    worker->query_actual = -1;
+    worker->desalojo_pendiente = false;
+
+    if (worker->conectado && !worker->en_pila_libres) {
+        list_add(pila_workers_libres, worker);
+        worker->en_pila_libres = true;
+    }
+}
+
+void worker_pasar_a_ocupado(t_worker* worker, t_query* query) {
+    pila_libres_quitar(worker);
+    worker->ocupado = true;
+    worker->query_actual = query->query_id;
+    worker->prioridad_query_actual = query->prioridad;
+
+    char clave[16];
+    dictionary_put(workers_por_query, clave_indice(query->query_id, clave, sizeof(clave)), worker);
+
+    ejecucion_quitar(worker);
+    ejecucion_insertar(worker);
+}
+
+// Desconexión: el worker deja de estar disponible y de ser candidato a desalojo
+void worker_quitar_de_indices(t_worker* worker) {
+    pila_libres_quitar(worker);
+    ejecucion_quitar(worker);
+    olvidar_query_del_worker(worker);
+}
+
+int cantidad_workers_libres(void) {
+    return list_size(pila_workers_libres);
+}
+
+// PLANIFICADOR
+static const char* nombre_evento_planificacion(t_evento_planificacion evento) {
+    switch (evento) {
+        case EVENTO_QUERY_NUEVA:          return "QUERY_NUEVA";
+        case EVENTO_WORKER_LIBRE:         return "WORKER_LIBRE";
+        case EVENTO_WORKER_CONECTADO:     return "WORKER_CONECTADO";
+        case EVENTO_WORKER_DESCONECTADO:  return "WORKER_DESCONECTADO";
+        case EVENTO_CAMBIO_PRIORIDAD:     return "CAMBIO_PRIORIDAD";
+        default:                          return "DESCONOCIDO";
+    }
+}
+
+// Los manejadores solo encolan el evento; el reactor planifica una vez por ráfaga
+void notificar_planificador(t_evento_planificacion evento, int id) {
+    t_evento_planificador* nuevo = malloc(sizeof(t_evento_planificador));
+    nuevo->tipo = evento;
+    nuevo->id = id;
+
+    queue_push(cola_eventos_planificacion, nuevo);
+
+    uint64_t uno = 1;
+    if (write(fd_eventos_planificacion, &uno, sizeof(uno)) < 0 && errno != EAGAIN) {
+        log_error(logger, "Error al notificar al planificador: %s", strerror(errno));
+    }
+}
+
+// Corta el bucle del reactor
+void detener_planificador(void) {
+    sistema_activo = false;
+    uint64_t uno = 1;
+    if (fd_eventos_planificacion >= 0) {
+        write(fd_eventos_planificacion, &uno, sizeof(uno));
+    }
+}
+
+static void atender_eventos_planificacion(void) {
+    uint64_t notificaciones;
+    if (read(fd_eventos_planificacion, &notificaciones, sizeof(notificaciones)) < 0 && errno != EAGAIN) {
+        log_error(logger, "Error al leer eventos del planificador: %s", strerror(errno));
+    }
+
+    // Una ráfaga de eventos se resuelve con una sola pasada de planificación
+    int cantidad_eventos = 0;
+    while (!queue_is_empty(cola_eventos_planificacion)) {
+        t_evento_planificador* evento = queue_pop(cola_eventos_planificacion);
+        log_debug(logger, "Planificador: evento %s (id %d)",
+                  nombre_evento_planificacion(evento->tipo), evento->id);
+        free(evento);
+        cantidad_eventos++;
+    }
+
+    if (cantidad_eventos > 0 && sistema_activo) {
+        log_debug(logger, "Planificador: %d eventos coalescidos en una pasada", cantidad_eventos);
+        planificar_siguiente_query();
+    }
+}
+
+t_query* obtener_query_mayor_prioridad(void) {
+    // La cola ya está ordenada por (prioridad, orden de llegada)
+    return cola_ready_extraer_primera(cola_ready);
 }
 
 void actualizar_prioridad_query(t_query* query, int nueva_prioridad) {
     int prioridad_anterior = query->prioridad;
     query->prioridad = nueva_prioridad;
+    cola_ready_actualizar(cola_ready, query);
     
     logging_cambio_prioridad(query->query_id, prioridad_anterior, nueva_prioridad);
 }
 
 
-// Versión SIN LOCK - usar solo cuando ya se tiene el mutex
+// Clave de los índices hash (el diccionario copia la clave al insertar)
+static char* clave_indice(int id, char* buffer, size_t tamanio) {
+    snprintf(buffer, tamanio, "%d", id);
+    return buffer;
+}
+
 t_query* buscar_query_por_id_unsafe(int query_id) {
-    for (int i = 0; i < list_size(lista_todas_queries); i++) {
-        t_query* query = list_get(lista_todas_queries, i);
-        if (query->query_id == query_id) {
-            return query;
+    char clave[16];
+    return dictionary_get(queries_por_id, clave_indice(query_id, clave, sizeof(clave)));
+}
+
+static void indexar_query(t_query* query) {
+    char clave[16];
+    dictionary_put(queries_por_id, clave_indice(query->query_id, clave, sizeof(clave)), query);
+
+    clave_indice(query->socket_query_control, clave, sizeof(clave));
+    t_list* del_socket = dictionary_get(queries_por_socket, clave);
+    if (del_socket == NULL) {
+        del_socket = list_create();
+        dictionary_put(queries_por_socket, clave, del_socket);
+    }
+    list_add(del_socket, query);
+}
+
+static void desindexar_query(t_query* query) {
+    char clave[16];
+    clave_indice(query->query_id, clave, sizeof(clave));
+    if (dictionary_get(queries_por_id, clave) == query) {
+        dictionary_remove(queries_por_id, clave);
+    }
+
+    clave_indice(query->socket_query_control, clave, sizeof(clave));
+    t_list* del_socket = dictionary_get(queries_por_socket, clave);
+    if (del_socket != NULL) {
+        list_remove_element(del_socket, query);
+        if (list_is_empty(del_socket)) {
+            dictionary_remove_and_destroy(queries_por_socket, clave, (void*)list_destroy);
         }
     }
-    return NULL;
+}
+
+// El Query Control se desconectó: su socket puede
+// reutilizarse, así que sus queries dejan de apuntarlo.
+static void olvidar_socket_query_control(int socket_qc) {
+    char clave[16];
+    clave_indice(socket_qc, clave, sizeof(clave));
+    t_list* del_socket = dictionary_remove(queries_por_socket, clave);
+    if (del_socket == NULL) return;
+
+    for (int i = 0; i < list_size(del_socket); i++) {
+        t_query* query = list_get(del_socket, i);
+        query->socket_query_control = -1;
+    }
+    list_destroy(del_socket);
 }
 
 
@@ -143,18 +563,47 @@ void logging_desalojo(int query_id, int worker_id, int pc_recuperado, const char
 }
 
 
+// Se llama desde la planificación y desde cancelar_query.
+// Solo pide el desalojo: el Worker responde con su contexto como otro mensaje del
+// reactor y recién ahí se libera (procesar_contexto_desalojo).
 void desalojar_query_de_worker(t_worker* worker, const char* motivo_log) {
-    int query_id_desalojada = worker->query_actual;
-    int pc_recuperado = 0;
+    if (worker->desalojo_pendiente) {
+        return;
+    }
 
     log_warning(logger, "🚀 DESALOJANDO Query %d de Worker %d por motivo: %s",
-                query_id_desalojada, worker->worker_id, motivo_log);
+                worker->query_actual, worker->worker_id, motivo_log);
+
+    worker->desalojo_pendiente = true;
+    worker->motivo_desalojo = motivo_log;
+    solicitar_desalojo_worker(worker); // Envía DESALOJAR_QUERY
+}
 
-    // 1. Enviar señal de desalojo al Worker
-    solicitar_desalojo_worker(worker); // Usa la función provista: envía DESALOJAR_QUERY
+// Contexto que el Worker devuelve al desalojar: [pc][query_id], con pc la próxima
+// instrucción a ejecutar
+void procesar_contexto_desalojo(t_worker* worker, const t_vista_paquete* vista) {
+    int pc_recuperado = 0;
+    uint32_t pc_campo;
+    uint32_t query_id_contexto;
+    bool tiene_query_id = vista != NULL && vista->cantidad >= 2 &&
+                          campo_leer_uint32(&vista->campos[1], &query_id_contexto);
+
+    if (vista == NULL || vista->cantidad == 0 || !campo_leer_uint32(&vista->campos[0], &pc_campo)) {
+        log_error(logger, "Error al recibir contexto de desalojo del Worker %d", worker->worker_id);
+    } else {
+        pc_recuperado = (int)pc_campo;
+    }
 
-    // 2. Recibir el PC (contexto) desde el Worker
-    pc_recuperado = recibir_contexto_desalojo(worker);
+
+    // Si la query terminó antes de leer el pedido, el contexto llega tarde y se descarta
+    if (!worker->desalojo_pendiente ||
+        (tiene_query_id && (int)query_id_contexto != worker->query_actual)) {
+        log_info(logger, "Contexto de desalojo del Worker %d sin desalojo pendiente - Ignorando",
+                 worker->worker_id);
+        return;
+    }
+
+    int query_id_desalojada = worker->query_actual;
 
     if (pc_recuperado < 0) { // Manejo de error básico si no se recibió un PC válido
         log_error(logger, "Error: PC inválido (%d) recibido para Query %d. Reiniciando PC a 0.",
@@ -165,11 +614,10 @@ void desalojar_query_de_worker(t_worker* worker, const char* motivo_log) {
                  query_id_desalojada, pc_recuperado);
     }
     
-    // 3. Actualizar el estado de la Query
-    pthread_mutex_lock(&mutex_queries);
+    // Actualizar el estado de la Query
     t_query* query = buscar_query_por_id_unsafe(query_id_desalojada);
 
-    if (query != NULL) {
+    if (query != NULL && query->estado == QUERY_EXEC && !query->cancelada) {
         // A. Actualizar PC: ESTE ES EL PASO MÁS CRÍTICO
         query->pc = pc_recuperado; 
         
@@ -177,40 +625,38 @@ void desalojar_query_de_worker(t_worker* worker, const char* motivo_log) {
         query->estado = QUERY_READY;
         query->worker_asignado = -1;
         
-        // C. Reingresar a la lista de queries listas (si ya no está, para asegurar su re-planificación)
-        list_add(lista_queries_ready, query); 
+        // C. Reingresar a la cola de queries listas (si ya no está, para asegurar su re-planificación)
+        cola_ready_insertar(cola_ready, query);
 
-        logging_desalojo(query_id_desalojada, worker->worker_id, pc_recuperado, motivo_log);
+        logging_desalojo(query_id_desalojada, worker->worker_id, pc_recuperado, worker->motivo_desalojo);
         
     } else {
         log_warning(logger, "Query %d no encontrada para desalojo (ya fue finalizada?)", 
                      query_id_desalojada);
     }
-    pthread_mutex_unlock(&mutex_queries);
 
-    // 4. Liberar el Worker para re-asignación inmediata
-    worker->ocupado = false;
-    worker->query_actual = -1;
+    // Liberar el Worker para re-asignación inmediata
+    worker_pasar_a_libre(worker);
     log_info(logger, "Worker %d liberado y listo para nueva asignación.", worker->worker_id);
 
-    // El hilo llamador (probablemente planificar_siguiente_query o atender_worker)
-    // continuará con la asignación de la query de mayor prioridad.
+
+    notificar_planificador(EVENTO_WORKER_LIBRE, worker->worker_id);
 }
 
 void debug_mostrar_estado_queries(void) {
-    //pthread_mutex_lock(&mutex_queries);
     
     log_info(logger, "=== DEBUG: ESTADO COMPLETO DE QUERIES ===");
-    log_info(logger, "Queries en READY: %d", list_size(lista_queries_ready));
+    log_info(logger, "Queries en READY: %d", cola_ready_cantidad(cola_ready));
     log_info(logger, "Queries totales: %d", list_size(lista_todas_queries));
     
     // Mostrar queries en READY con más detalle
-    if (list_size(lista_queries_ready) > 0) {
+    if (cola_ready_cantidad(cola_ready) > 0) {
         log_info(logger, "--- QUERIES EN READY ---");
-        for (int i = 0; i < list_size(lista_queries_ready); i++) {
-            t_query* q = list_get(lista_queries_ready, i);
+        for (int i = 0; i < cola_ready_cantidad(cola_ready); i++) {
+            t_query* q = cola_ready_obtener(cola_ready, i);
             log_info(logger, "  [%d] Query %d: path='%s', prioridad=%d, estado=%d, worker=%d", 
-                     i, q->query_id, q->path_query, q->prioridad, q->estado, q->worker_asignado);
+                     i, q->query_id, q->path_query, cola_ready_prioridad_efectiva(cola_ready, q),
+                     q->estado, q->worker_asignado);
         }
     } else {
         log_info(logger, "--- NO HAY QUERIES EN READY ---");
@@ -230,7 +676,6 @@ void debug_mostrar_estado_queries(void) {
     
     log_info(logger, "=== FIN DEBUG ===");
     
-    //pthread_mutex_unlock(&mutex_queries);
 }
 
 // INICIALIZACION Y CLEANUP
@@ -331,32 +776,52 @@ void destruir_config_master(t_config_master* config) {
 }
 
 void inicializar_estructuras_master(void) {
-    lista_queries_ready = list_create();
+    cola_ready = cola_ready_crear(strcmp(config_global->algoritmo_planificacion, "PRIORIDADES") == 0);
     lista_workers = list_create();
     lista_todas_queries = list_create();
+    pila_workers_libres = list_create();
+    queries_por_id = dictionary_create();
+    queries_por_socket = dictionary_create();
+    workers_por_id = dictionary_create();
+    workers_por_query = dictionary_create();
+    archivos_por_script = dictionary_create();
+    scripts_por_antiguedad = list_create();
     
     // Verificar que las listas se crearon correctamente
-    if (lista_queries_ready == NULL || lista_workers == NULL || lista_todas_queries == NULL) {
+    if (cola_ready == NULL || lista_workers == NULL || lista_todas_queries == NULL) {
         log_error(logger, "Error crítico: No se pudieron crear las listas");
         exit(EXIT_FAILURE);
     }
     
     log_info(logger, "Estructuras inicializadas:");
-    log_info(logger, "   - lista_queries_ready: %p (size: %d)", lista_queries_ready, list_size(lista_queries_ready));
+    log_info(logger, "   - cola_ready: %p (size: %d, orden: %s)", cola_ready, cola_ready_cantidad(cola_ready),
+             cola_ready->por_prioridad ? "prioridad" : "llegada");
     log_info(logger, "   - lista_todas_queries: %p (size: %d)", lista_todas_queries, list_size(lista_todas_queries));
     log_info(logger, "   - lista_workers: %p (size: %d)", lista_workers, list_size(lista_workers));
     
-    pthread_mutex_init(&mutex_queries, NULL);
-    pthread_mutex_init(&mutex_workers, NULL);
-    pthread_mutex_init(&mutex_planificacion, NULL);
+    cola_eventos_planificacion = queue_create();
+    fd_eventos_planificacion = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd_eventos_planificacion < 0) {
+        log_error(logger, "Error crítico: No se pudo crear el eventfd del planificador: %s", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
     
     log_info(logger, "Mutex inicializados");
 }
 
 void destruir_estructuras_master(void) {
-pthread_mutex_lock(&mutex_queries);
-    if (lista_queries_ready != NULL) {
-        list_destroy_and_destroy_elements(lista_queries_ready, (void*)eliminar_query);
+    if (queries_por_id != NULL) {
+        dictionary_destroy(queries_por_id);
+        queries_por_id = NULL;
+    }
+    if (queries_por_socket != NULL) {
+        dictionary_destroy_and_destroy_elements(queries_por_socket, (void*)list_destroy);
+        queries_por_socket = NULL;
+    }
+    if (cola_ready != NULL) {
+        // Las queries encoladas se liberan junto con lista_todas_queries
+        cola_ready_destruir(cola_ready);
+        cola_ready = NULL;
     }
     if (lista_todas_queries != NULL) { 
         list_destroy_and_destroy_elements(lista_todas_queries, (void*)eliminar_query);
@@ -364,245 +829,787 @@ pthread_mutex_lock(&mutex_queries);
     if (cola_queries_ready != NULL) {
         queue_destroy(cola_queries_ready);
     }
-    pthread_mutex_unlock(&mutex_queries);
+    if (cola_eventos_planificacion != NULL) {
+        queue_destroy_and_destroy_elements(cola_eventos_planificacion, free);
+        cola_eventos_planificacion = NULL;
+    }
+    if (fd_eventos_planificacion >= 0) {
+        close(fd_eventos_planificacion);
+        fd_eventos_planificacion = -1;
+    }
     
-    pthread_mutex_lock(&mutex_workers);
+    if (pila_workers_libres != NULL) {
+        list_destroy(pila_workers_libres);
+        pila_workers_libres = NULL;
+    }
+    free(workers_en_ejecucion);
+    workers_en_ejecucion = NULL;
+    cantidad_en_ejecucion = 0;
     if (lista_workers != NULL) {
         list_destroy_and_destroy_elements(lista_workers, (void*)eliminar_worker);
     }
-    pthread_mutex_unlock(&mutex_workers);
+    if (workers_por_id != NULL) {
+        dictionary_destroy(workers_por_id);
+        workers_por_id = NULL;
+    }
+    if (workers_por_query != NULL) {
+        dictionary_destroy(workers_por_query);
+        workers_por_query = NULL;
+    }
+    if (archivos_por_script != NULL) {
+        dictionary_destroy_and_destroy_elements(archivos_por_script, (void*)destruir_lista_archivos);
+        archivos_por_script = NULL;
+    }
+    if (scripts_por_antiguedad != NULL) {
+        list_destroy_and_destroy_elements(scripts_por_antiguedad, free);
+        scripts_por_antiguedad = NULL;
+    }
     
-    pthread_mutex_destroy(&mutex_queries);
-    pthread_mutex_destroy(&mutex_workers);
-    pthread_mutex_destroy(&mutex_planificacion);
     
     log_info(logger, "Estructuras del Master destruidas");
 }
 
-void iniciar_servidor_master(void) {
-    int socket_servidor = iniciar_servidor(logger, config_global->puerto_escucha);
-    
-    if (socket_servidor == -1) {
-        log_error(logger, "Error al iniciar el servidor Master");
-        return;
+// SERVIDOR
+// Un único hilo atiende todas las conexiones con epoll. Cada descriptor acumula
+// lo recibido en su t_conexion y los mensajes se procesan recién cuando llegan
+// completos. Los envíos tampoco bloquean: lo que el socket no acepta queda en la
+// cola de salida de la conexión y se vacía con EPOLLOUT, así un cliente lento no
+// frena al resto.
+#define MASTER_MAX_EVENTOS 64
+#define MASTER_TAM_LECTURA 4096
+#define MASTER_TAM_MAX_PAQUETE (10 * 1024 * 1024)
+// Si la cola de salida de un Query Control pasa SALIDA_ALTA, se le pide al Worker que pause
+// el READ de esa query hasta que la cola baje de SALIDA_BAJA. MAX_SALIDA es el límite duro de
+// cualquier conexión: pasado ese punto el cliente no consume y se corta.
+#define MASTER_SALIDA_ALTA (4 * 1024 * 1024)
+#define MASTER_SALIDA_BAJA (1 * 1024 * 1024)
+#define MASTER_MAX_SALIDA_PENDIENTE (64 * 1024 * 1024)
+
+static int fd_epoll = -1;
+static t_dictionary* conexiones_por_socket = NULL; // "socket" -> t_conexion* (solo clientes)
+
+static t_conexion* nueva_conexion(int socket, t_tipo_conexion tipo) {
+    t_conexion* conexion = malloc(sizeof(t_conexion));
+    conexion->socket = socket;
+    conexion->tipo = tipo;
+    conexion->buffer = NULL;
+    conexion->usados = 0;
+    conexion->capacidad = 0;
+    conexion->salida = NULL;
+    conexion->salida_enviados = 0;
+    conexion->salida_usados = 0;
+    conexion->salida_capacidad = 0;
+    conexion->eventos = EPOLLIN;
+    conexion->frenadas = NULL;
+    conexion->worker = NULL;
+    conexion->slots = NULL;
+    return conexion;
+}
+
+static bool registrar_conexion(t_conexion* conexion) {
+    struct epoll_event evento = { .events = conexion->eventos, .data.ptr = conexion };
+    if (epoll_ctl(fd_epoll, EPOLL_CTL_ADD, conexion->socket, &evento) < 0) {
+        log_error(logger, "Error al registrar socket %d en epoll: %s", conexion->socket, strerror(errno));
+        return false;
     }
-    
-    log_info(logger, "Servidor Master iniciado en puerto %d", config_global->puerto_escucha);
-    log_info(logger, "Esperando conexiones de Query Control y Workers...");
-    
-    while (sistema_activo) {
-        int socket_cliente = esperar_cliente(logger, socket_servidor);
-        
-        if (socket_cliente == -1) {
-            log_error(logger, "Error al aceptar cliente");
-            continue;
+    return true;
+}
+
+static t_conexion* conexion_de_socket(int socket) {
+    if (conexiones_por_socket == NULL) return NULL;
+    char clave[16];
+    return dictionary_get(conexiones_por_socket, clave_indice(socket, clave, sizeof(clave)));
+}
+
+static size_t salida_pendiente(const t_conexion* conexion) {
+    return conexion->salida_usados - conexion->salida_enviados;
+}
+
+// Siempre EPOLLIN; EPOLLOUT solo mientras haya algo en la cola de salida
+static bool actualizar_eventos(t_conexion* conexion) {
+    uint32_t eventos = EPOLLIN | (salida_pendiente(conexion) > 0 ? EPOLLOUT : 0);
+    if (eventos == conexion->eventos) return true;
+
+    struct epoll_event evento = { .events = eventos, .data.ptr = conexion };
+    if (epoll_ctl(fd_epoll, EPOLL_CTL_MOD, conexion->socket, &evento) < 0) {
+        log_error(logger, "Error al actualizar socket %d en epoll: %s", conexion->socket, strerror(errno));
+        return false;
+    }
+    conexion->eventos = eventos;
+    return true;
+}
+
+// PAUSAR_LECTURA / REANUDAR_LECTURA [query_id] al Worker que ejecuta la query
+static void enviar_control_lectura(int socket_worker, op_code cod_op, uint32_t query_id) {
+    if (conexion_de_socket(socket_worker) == NULL) return; // El Worker ya se desconectó
+
+    t_paquete* paquete = crear_paquete(cod_op, logger);
+    if (paquete == NULL) return;
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
+    enviar_paquete_a_conexion(paquete, socket_worker);
+    eliminar_paquete(paquete);
+}
+
+// Reanuda los READ pausados por la cola de salida de 'conexion'
+static void liberar_frenadas(t_conexion* conexion) {
+    if (conexion->frenadas == NULL) return;
+
+    while (!list_is_empty(conexion->frenadas)) {
+        t_lectura_frenada* frenada = list_remove(conexion->frenadas, 0);
+        log_debug(logger, "Se reanuda el READ de la Query %u (socket Worker %d)",
+                  frenada->query_id, frenada->socket_worker);
+        enviar_control_lectura(frenada->socket_worker, REANUDAR_LECTURA, frenada->query_id);
+        free(frenada);
+    }
+}
+
+static bool lectura_frenada(t_conexion* conexion, uint32_t query_id) {
+    if (conexion->frenadas == NULL) return false;
+    for (int i = 0; i < list_size(conexion->frenadas); i++) {
+        t_lectura_frenada* frenada = list_get(conexion->frenadas, i);
+        if (frenada->query_id == query_id) return true;
+    }
+    return false;
+}
+
+// Backpressure de READ: si el Query Control acumula demasiado sin consumir, el Worker pausa
+// solo el READ de esa query hasta que la cola se vacíe (ver vaciar_salida). El socket del
+// Worker se sigue leyendo: los mensajes de sus otras queries no esperan.
+static void frenar_si_saturada(int socket_qc, uint32_t query_id, int socket_worker) {
+    t_conexion* destino = conexion_de_socket(socket_qc);
+    if (destino == NULL || salida_pendiente(destino) < MASTER_SALIDA_ALTA) return;
+    if (lectura_frenada(destino, query_id)) return;
+
+    log_debug(logger, "Socket %d con %zu bytes sin enviar: se pausa el READ de la Query %u",
+              socket_qc, salida_pendiente(destino), query_id);
+    t_lectura_frenada* frenada = malloc(sizeof(t_lectura_frenada));
+    frenada->query_id = query_id;
+    frenada->socket_worker = socket_worker;
+    if (destino->frenadas == NULL) destino->frenadas = list_create();
+    list_add(destino->frenadas, frenada);
+    enviar_control_lectura(socket_worker, PAUSAR_LECTURA, query_id);
+}
+
+static void encolar_salida(t_conexion* conexion, const char* datos, size_t tamanio) {
+    if (tamanio == 0) return;
+
+    if (conexion->salida_capacidad - conexion->salida_usados < tamanio) {
+        // Primero se recupera el espacio de lo ya enviado
+        if (conexion->salida_enviados > 0) {
+            memmove(conexion->salida, conexion->salida + conexion->salida_enviados,
+                    conexion->salida_usados - conexion->salida_enviados);
+            conexion->salida_usados -= conexion->salida_enviados;
+            conexion->salida_enviados = 0;
+        }
+        size_t capacidad = conexion->salida_capacidad == 0 ? MASTER_TAM_LECTURA : conexion->salida_capacidad;
+        while (capacidad - conexion->salida_usados < tamanio) capacidad *= 2;
+        if (capacidad != conexion->salida_capacidad) {
+            conexion->salida = realloc(conexion->salida, capacidad);
+            conexion->salida_capacidad = capacidad;
+        }
+    }
+
+    memcpy(conexion->salida + conexion->salida_usados, datos, tamanio);
+    conexion->salida_usados += tamanio;
+}
+
+// Envía lo que acepte el socket de la cola de salida. Devuelve false si la conexión falló.
+static bool vaciar_salida(t_conexion* conexion) {
+    while (conexion->salida_enviados < conexion->salida_usados) {
+        ssize_t bytes = send(conexion->socket, conexion->salida + conexion->salida_enviados,
+                             conexion->salida_usados - conexion->salida_enviados,
+                             MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            log_error(logger, "Error en send() al socket %d: %s", conexion->socket, strerror(errno));
+            return false;
+        }
+        conexion->salida_enviados += bytes;
+    }
+
+    if (conexion->salida_enviados == conexion->salida_usados) {
+        conexion->salida_enviados = 0;
+        conexion->salida_usados = 0;
+    }
+    if (salida_pendiente(conexion) < MASTER_SALIDA_BAJA) {
+        liberar_frenadas(conexion);
+    }
+    return actualizar_eventos(conexion);
+}
+
+// Envía el mensaje sin bloquear al cliente conectado en 'socket'. Si la cola de salida
+// está vacía se intenta directo; el resto se encola detrás de lo pendiente para no
+// mezclar mensajes. Devuelve false si el cliente ya no está o la conexión falló.
+static bool enviar_a_conexion(int socket, const struct iovec* iov, int cantidad) {
+    t_conexion* conexion = conexion_de_socket(socket);
+    if (conexion == NULL) {
+        log_warning(logger, "Envío descartado: el socket %d ya no tiene conexión", socket);
+        return false;
+    }
+    if (salida_pendiente(conexion) > MASTER_MAX_SALIDA_PENDIENTE) {
+        // El cierre lo procesa el reactor con el próximo evento del socket
+        log_error(logger, "Socket %d no consume lo que se le envía (%zu bytes pendientes) - se corta",
+                  socket, salida_pendiente(conexion));
+        shutdown(socket, SHUT_RDWR);
+        return false;
+    }
+
+    int primero = 0;
+    size_t desde = 0;
+    if (conexion->salida_usados == conexion->salida_enviados) {
+        struct msghdr mensaje = { .msg_iov = (struct iovec*)iov, .msg_iovlen = cantidad };
+        ssize_t bytes;
+        do {
+            bytes = sendmsg(socket, &mensaje, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                log_error(logger, "Error en sendmsg() al socket %d: %s", socket, strerror(errno));
+                return false;
+            }
+            bytes = 0;
+        }
+
+        size_t enviados = bytes;
+        while (primero < cantidad && enviados >= iov[primero].iov_len) {
+            enviados -= iov[primero].iov_len;
+            primero++;
+        }
+        desde = enviados;
+    }
+
+    for (int i = primero; i < cantidad; i++) {
+        size_t saltear = i == primero ? desde : 0;
+        encolar_salida(conexion, (const char*)iov[i].iov_base + saltear, iov[i].iov_len - saltear);
+    }
+    return actualizar_eventos(conexion);
+}
+
+// Mismo formato que enviar_paquete ([cod_op][size][stream]) pero por la cola de salida
+static void enviar_paquete_a_conexion(t_paquete* paquete, int socket) {
+    int encabezado[2] = { paquete->codigo_operacion, paquete->buffer->size };
+    struct iovec iov[2] = {
+        { .iov_base = encabezado, .iov_len = sizeof(encabezado) },
+        { .iov_base = paquete->buffer->stream, .iov_len = paquete->buffer->size }
+    };
+    if (!enviar_a_conexion(socket, iov, paquete->buffer->size > 0 ? 2 : 1)) {
+        log_error(logger, "Error al enviar paquete. Cod OP: %d, Tamaño: %d bytes",
+                  paquete->codigo_operacion, paquete->buffer->size);
+    }
+}
+
+// Mismo formato que enviar_ok: el código en network byte order
+static void enviar_codigo_a_conexion(int socket, int codigo) {
+    int codigo_network = htonl(codigo);
+    struct iovec iov = { .iov_base = &codigo_network, .iov_len = sizeof(int) };
+    enviar_a_conexion(socket, &iov, 1);
+}
+
+static void cerrar_conexion(t_conexion* conexion) {
+    epoll_ctl(fd_epoll, EPOLL_CTL_DEL, conexion->socket, NULL);
+
+    char clave[16];
+    dictionary_remove(conexiones_por_socket, clave_indice(conexion->socket, clave, sizeof(clave)));
+
+    switch (conexion->tipo) {
+        case CONEXION_WORKER: {
+            // Cada slot devuelve a READY la query que estaba ejecutando
+            for (int i = 0; i < list_size(conexion->slots); i++) {
+                manejar_desconexion_worker_inmediata(list_get(conexion->slots, i));
+            }
+            list_destroy_and_destroy_elements(conexion->slots, (void*)eliminar_worker); // El slot 0 cierra el socket
+            break;
+        }
+        case CONEXION_QUERY_CONTROL:
+            log_info(logger, "=== FIN ATENCIÓN QUERY CONTROL (Socket %d) ===", conexion->socket);
+            olvidar_socket_query_control(conexion->socket);
+            close(conexion->socket);
+            break;
+        default:
+            close(conexion->socket);
+            break;
+    }
+
+    liberar_frenadas(conexion);
+    if (conexion->frenadas != NULL) list_destroy(conexion->frenadas);
+    free(conexion->buffer);
+    free(conexion->salida);
+    free(conexion);
+}
+
+static void aceptar_clientes(int socket_servidor) {
+    while (true) {
+        int socket_cliente = accept(socket_servidor, NULL, NULL);
+        if (socket_cliente < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                log_error(logger, "Error al aceptar cliente: %s", strerror(errno));
+            }
+            if (errno == EINTR) continue;
+            return;
         }
 
         log_info(logger, "Nuevo cliente conectado - Socket: %d", socket_cliente);
-        
-        // Recibir handshake para identificar tipo de módulo
-        op_code cod_op;
-        ssize_t bytes = recv(socket_cliente, &cod_op, sizeof(op_code), MSG_WAITALL);
-        
-        if (bytes <= 0) {
-            log_warning(logger, "Cliente se desconectó antes del handshake");
+        // Los envíos pasan por la cola de salida: el socket nunca bloquea al reactor
+        fcntl(socket_cliente, F_SETFL, fcntl(socket_cliente, F_GETFL) | O_NONBLOCK);
+
+        t_conexion* conexion = nueva_conexion(socket_cliente, CONEXION_HANDSHAKE);
+        if (!registrar_conexion(conexion)) {
             close(socket_cliente);
+            free(conexion);
             continue;
         }
+        char clave[16];
+        dictionary_put(conexiones_por_socket, clave_indice(socket_cliente, clave, sizeof(clave)), conexion);
+    }
+}
 
-        log_info(logger, "Handshake recibido: código %d", cod_op);
-        
-        // Crear argumentos para el hilo
-        t_args_hilo* args = malloc(sizeof(t_args_hilo));
-        args->socket_cliente = socket_cliente;
-        
-        pthread_t hilo_cliente;
-        const char* nombre_modulo = "Desconocido";
-        
-        switch (cod_op) {
-            case QUERY_CONTROL:
-                nombre_modulo = "Query Control";
-                log_info(logger, "## Se conecta el Query Control - Socket: %d", socket_cliente);
-                args->tipo_modulo = MASTER;
-                pthread_create(&hilo_cliente, NULL, atender_query_control, args);
-                pthread_detach(hilo_cliente);
-                break;
-                
-            case WORKER:
-                nombre_modulo = "Worker";
-                log_info(logger, "## Se conecta un Worker - Socket: %d", socket_cliente);
-                args->tipo_modulo = WORKER;
-                pthread_create(&hilo_cliente, NULL, atender_worker, args);
-                pthread_detach(hilo_cliente);
-                break;
+// [MARCA_LOTE_QUERIES][size][cantidad][[tam_path][path][prioridad]]... en network byte
+// order. Mismo retorno que procesar_mensaje_conexion.
+static ssize_t procesar_lote_conexion(t_conexion* conexion, char* datos, size_t disponibles) {
+    if (disponibles < 2 * sizeof(uint32_t)) return 0;
 
-            case HANDSHAKE_WORKER:  // Código 102 - Handshake específico
-                nombre_modulo = "Worker";
-                log_info(logger, "## Se conecta un Worker (HANDSHAKE_WORKER=102) - Socket: %d", socket_cliente);
-                args->tipo_modulo = WORKER;
-                pthread_create(&hilo_cliente, NULL, atender_worker, args);
-                pthread_detach(hilo_cliente);
-                break;
+    uint32_t size_network;
+    memcpy(&size_network, datos + sizeof(uint32_t), sizeof(uint32_t));
+    uint32_t size = ntohl(size_network);
+    if (size < sizeof(uint32_t) || size > MASTER_TAM_MAX_PAQUETE) {
+        log_error(logger, "Tamaño de lote inválido del Query Control (Socket %d): %u bytes",
+                  conexion->socket, size);
+        return -1;
+    }
 
-            case HANDSHAKE_QUERY_CONTROL:
-                nombre_modulo = "Query Control";
-                log_info(logger, "## Se conecta el Query Control - Socket: %d", socket_cliente);
+    size_t total = 2 * sizeof(uint32_t) + size;
+    if (disponibles < total) return 0;
 
-                // 1️. ENVIAR CONFIRMACION
-                op_code conf = CONFIRMATION;
-                send(socket_cliente, &conf, sizeof(op_code), 0);
+    if (!procesar_lote_query_control(conexion->socket, datos + 2 * sizeof(uint32_t), size)) {
+        return -1;
+    }
+    return total;
+}
 
-                // 2️. Crear hilo
-                args->tipo_modulo = QUERY_CONTROL;
-                pthread_create(&hilo_cliente, NULL, atender_query_control, args);
-                pthread_detach(hilo_cliente);
-                break;
-                
-            default:
-                log_warning(logger, "Tipo de módulo no reconocido: %d", cod_op);
-                close(socket_cliente);
-                free(args);
-                break;
+// Devuelve los bytes consumidos, 0 si el mensaje todavía está incompleto o -1 si
+// hay que cerrar la conexión.
+// Slot del Worker al que va dirigido el mensaje, según la query que informa.
+// Los mensajes de cierre de una query que ya no ejecuta en esta conexión devuelven NULL.
+static t_worker* slot_del_mensaje(t_conexion* conexion, op_code cod_op, const t_vista_paquete* vista) {
+    int campo_query = cod_op == DESALOJAR_QUERY ? 1 : 0;   // Contexto de desalojo: [pc][query_id]
+    t_worker* slot = NULL;
+
+    uint32_t query_id;
+    if (vista->cantidad > campo_query && campo_leer_uint32(&vista->campos[campo_query], &query_id)) {
+        slot = buscar_worker_por_query(query_id);
+        if (slot != NULL && slot->socket_worker != conexion->socket) slot = NULL;
+    }
+    if (slot != NULL) return slot;
+
+    switch (cod_op) {
+        case END:
+        case QUERY_FINALIZADA:
+        case ERROR_EJECUCION:
+        case DESALOJAR_QUERY:
+            return NULL;
+        default:
+            return conexion->worker;
+    }
+}
+
+static ssize_t procesar_mensaje_conexion(t_conexion* conexion, char* datos, size_t disponibles) {
+    switch (conexion->tipo) {
+        case CONEXION_HANDSHAKE: {
+            if (disponibles < sizeof(op_code)) return 0;
+
+            op_code cod_op;
+            memcpy(&cod_op, datos, sizeof(op_code));
+            log_info(logger, "Handshake recibido: código %d", cod_op);
+
+            switch (cod_op) {
+                case QUERY_CONTROL:
+                    log_info(logger, "## Se conecta el Query Control - Socket: %d", conexion->socket);
+                    conexion->tipo = CONEXION_QUERY_CONTROL;
+                    break;
+
+                case HANDSHAKE_QUERY_CONTROL: {
+                    log_info(logger, "## Se conecta el Query Control - Socket: %d", conexion->socket);
+                    op_code conf = CONFIRMATION;
+                    struct iovec iov = { .iov_base = &conf, .iov_len = sizeof(op_code) };
+                    enviar_a_conexion(conexion->socket, &iov, 1);
+                    conexion->tipo = CONEXION_QUERY_CONTROL;
+                    break;
+                }
+
+                case WORKER:
+                case HANDSHAKE_WORKER:  // Código 102 - Handshake específico
+                    log_info(logger, "## Se conecta un Worker - Socket: %d", conexion->socket);
+                    conexion->tipo = CONEXION_WORKER_ID;
+                    break;
+
+                default:
+                    log_warning(logger, "Tipo de módulo no reconocido: %d", cod_op);
+                    return -1;
+            }
+            return sizeof(op_code);
         }
 
-        // Log adicional mostrando cantidad actual de módulos conectados
-        if (cod_op == QUERY_CONTROL || cod_op == WORKER || cod_op == HANDSHAKE_WORKER) {
-            pthread_mutex_lock(&mutex_workers);
-            int cantidad_workers = list_size(lista_workers);
-            pthread_mutex_unlock(&mutex_workers);
-            
-            log_info(logger, "## %s conectado - Cantidad de Workers: %d", 
-                     nombre_modulo, cantidad_workers);
+        case CONEXION_QUERY_CONTROL: {
+            // [tam_path][path][prioridad] en network byte order
+            if (disponibles < sizeof(uint32_t)) return 0;
+
+            uint32_t tam_path_network;
+            memcpy(&tam_path_network, datos, sizeof(uint32_t));
+            uint32_t tam_path = ntohl(tam_path_network);
+
+            if (tam_path == MARCA_LOTE_QUERIES) {
+                return procesar_lote_conexion(conexion, datos, disponibles);
+            }
+
+            if (tam_path > 10000) {
+                log_error(logger, "Tamaño de path inválido: %u bytes", tam_path);
+                return -1;
+            }
+
+            size_t total = sizeof(uint32_t) + tam_path + sizeof(int);
+            if (disponibles < total) return 0;
+
+            char* path_query = strndup(datos + sizeof(uint32_t), tam_path);
+            int prioridad_network;
+            memcpy(&prioridad_network, datos + sizeof(uint32_t) + tam_path, sizeof(int));
+
+            procesar_solicitud_query_control(conexion->socket, path_query, ntohl(prioridad_network));
+            free(path_query);
+            return total;
+        }
+
+        case CONEXION_WORKER_ID: {
+            // [tam_id][id][capacidad] en network byte order; sin ID válido se usa el contador
+            if (disponibles < sizeof(uint32_t)) return 0;
+
+            uint32_t tam_id_network;
+            memcpy(&tam_id_network, datos, sizeof(uint32_t));
+            uint32_t tam_id = ntohl(tam_id_network);
+
+            size_t total = sizeof(uint32_t);
+            if (tam_id > 0 && tam_id < 1024) { // Límite razonable
+                total += tam_id;
+            }
+            if (disponibles < total + sizeof(uint32_t)) return 0;
+
+            char* worker_id = NULL;
+            if (total > sizeof(uint32_t)) {
+                worker_id = strndup(datos + sizeof(uint32_t), tam_id);
+                log_info(logger, "Worker identificado con ID: %s", worker_id);
+            }
+
+            uint32_t capacidad_network;
+            memcpy(&capacidad_network, datos + total, sizeof(uint32_t));
+            total += sizeof(uint32_t);
+
+            conexion->slots = registrar_worker(conexion->socket, worker_id, ntohl(capacidad_network));
+            if (conexion->slots == NULL) return -1;
+
+            conexion->worker = list_get(conexion->slots, 0);
+            conexion->tipo = CONEXION_WORKER;
+            return total;
         }
+
+        case CONEXION_WORKER: {
+            if (disponibles < sizeof(op_code)) return 0;
+
+            op_code cod_op;
+            memcpy(&cod_op, datos, sizeof(op_code));
+
+            if (cod_op == 0 || cod_op > 500) {
+                log_error(logger, "Código de operación inválido del Worker %d: %d",
+                         conexion->worker->worker_id, cod_op);
+                return sizeof(op_code);
+            }
+
+            if (disponibles < sizeof(op_code) + sizeof(int)) return 0;
+
+            int size;
+            memcpy(&size, datos + sizeof(op_code), sizeof(int));
+            if (size < 0 || size > MASTER_TAM_MAX_PAQUETE) {
+                log_error(logger, "Tamaño de paquete inválido del Worker %d: %d",
+                          conexion->worker->worker_id, size);
+                return -1;
+            }
+
+            size_t total = sizeof(op_code) + sizeof(int) + (size_t)size;
+            if (disponibles < total) return 0;
+
+            // Los campos apuntan al buffer de la conexión: valen solo durante el despacho
+            t_vista_paquete vista;
+            if (!paquete_decodificar_vista(datos + sizeof(op_code) + sizeof(int), size, &vista)) {
+                log_error(logger, "Paquete mal formado del Worker %d (cod_op %d)",
+                          conexion->worker->worker_id, cod_op);
+                return total;
+            }
+            t_worker* slot = slot_del_mensaje(conexion, cod_op, &vista);
+            if (slot == NULL) {
+                log_info(logger, "Mensaje %d del Worker %d para una query que ya no ejecuta - Ignorando",
+                         cod_op, conexion->worker->worker_id);
+                return total;
+            }
+            procesar_mensaje_worker(slot, cod_op, &vista);
+            return total;
+        }
+
+        default:
+            return -1;
     }
-    
-    close(socket_servidor);
 }
 
+// Lee todo lo disponible sin bloquear y procesa los mensajes completos.
+// Devuelve false si la conexión se cerró.
+static bool leer_conexion(t_conexion* conexion) {
+    while (true) {
+        if (conexion->capacidad - conexion->usados < MASTER_TAM_LECTURA) {
+            conexion->capacidad = conexion->capacidad == 0 ? MASTER_TAM_LECTURA * 2 : conexion->capacidad * 2;
+            conexion->buffer = realloc(conexion->buffer, conexion->capacidad);
+        }
 
-// QUERY
-void recibir_solicitud_query_control(int socket_qc, char** path_query, int* prioridad) {
-    log_info(logger, "Recibiendo solicitud de Query Control...");
-    
-    // 1. Recibir tamaño del path Y CONVERTIR DE NETWORK BYTE ORDER
-    uint32_t tam_path_network;
-    ssize_t bytes_recv = recv(socket_qc, &tam_path_network, sizeof(uint32_t), MSG_WAITALL);
-    
-    if (bytes_recv <= 0) {
-        if (bytes_recv == 0) {
-            log_info(logger, "Query Control cerró la conexión");
-        } else {
-            log_error(logger, "Error al recibir tamaño del path: %s", strerror(errno));
+        ssize_t bytes = recv(conexion->socket, conexion->buffer + conexion->usados,
+                             conexion->capacidad - conexion->usados, MSG_DONTWAIT);
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            log_error(logger, "Error en recv() del socket %d: %s", conexion->socket, strerror(errno));
+            return false;
+        }
+        if (bytes == 0) {
+            log_warning(logger, "Socket %d cerró la conexión", conexion->socket);
+            return false;
+        }
+        conexion->usados += bytes;
+
+        size_t procesados = 0;
+        while (procesados < conexion->usados) {
+            ssize_t consumidos = procesar_mensaje_conexion(conexion, conexion->buffer + procesados,
+                                                           conexion->usados - procesados);
+            if (consumidos < 0) return false;
+            if (consumidos == 0) break;
+            procesados += consumidos;
+        }
+
+        if (procesados > 0) {
+            memmove(conexion->buffer, conexion->buffer + procesados, conexion->usados - procesados);
+            conexion->usados -= procesados;
+        }
+    }
+    return true;
+}
+
+static void atender_timer_aging(int fd_aging) {
+    uint64_t expiraciones = 0;
+    if (read(fd_aging, &expiraciones, sizeof(expiraciones)) < 0) {
+        if (errno != EAGAIN) {
+            log_error(logger, "Error al leer el timer de aging: %s", strerror(errno));
         }
-        *path_query = NULL;
         return;
     }
+    // Si el reactor se demoró, se aplican todos los ticks vencidos
+    for (uint64_t i = 0; i < expiraciones; i++) {
+        aplicar_tick_aging();
+    }
+}
+
+static int crear_timer_aging(void) {
+    int fd_aging = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd_aging < 0) {
+        log_error(logger, "Error al crear el timer de aging: %s", strerror(errno));
+        return -1;
+    }
+
+    struct itimerspec intervalo;
+    intervalo.it_interval.tv_sec = config_global->tiempo_aging / 1000;
+    intervalo.it_interval.tv_nsec = (config_global->tiempo_aging % 1000) * 1000000L;
+    intervalo.it_value = intervalo.it_interval;
+    timerfd_settime(fd_aging, 0, &intervalo, NULL);
+    return fd_aging;
+}
+
+void iniciar_servidor_master(void) {
+    int socket_servidor = iniciar_servidor(logger, config_global->puerto_escucha);
     
-    uint32_t tam_path = ntohl(tam_path_network);  // ← AGREGAR CONVERSIÓN
-    log_info(logger, "Tamaño del path recibido: %u bytes", tam_path);
-    
-    if (tam_path == 0 || tam_path > 10000) {
-        log_error(logger, "Tamaño de path inválido: %u bytes", tam_path);
-        *path_query = NULL;
+    if (socket_servidor == -1) {
+        log_error(logger, "Error al iniciar el servidor Master");
         return;
     }
-    
-    // 2. Recibir el path
-    *path_query = malloc(tam_path);
-    bytes_recv = recv(socket_qc, *path_query, tam_path, MSG_WAITALL);
-    
-    if (bytes_recv <= 0) {
-        log_error(logger, "Error al recibir path del paquete");
-        free(*path_query);
-        *path_query = NULL;
+    fcntl(socket_servidor, F_SETFL, fcntl(socket_servidor, F_GETFL) | O_NONBLOCK);
+
+    fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (fd_epoll < 0) {
+        log_error(logger, "Error al crear epoll: %s", strerror(errno));
+        close(socket_servidor);
         return;
     }
+
+    conexiones_por_socket = dictionary_create();
+    t_conexion* escucha = nueva_conexion(socket_servidor, CONEXION_ESCUCHA);
+    t_conexion* eventos = nueva_conexion(fd_eventos_planificacion, CONEXION_EVENTOS);
+    t_conexion* aging = NULL;
+    registrar_conexion(escucha);
+    registrar_conexion(eventos);
+
+    // Aging solo si está configurado
+    if (config_global->tiempo_aging > 0 && 
+        strcmp(config_global->algoritmo_planificacion, "PRIORIDADES") == 0) {
+        int fd_aging = crear_timer_aging();
+        if (fd_aging >= 0) {
+            aging = nueva_conexion(fd_aging, CONEXION_AGING);
+            registrar_conexion(aging);
+            log_info(logger, "Timer de aging iniciado (%d ms)", config_global->tiempo_aging);
+        }
+    }
     
-    log_info(logger, "Path recibido: '%s'", *path_query);
-    
-    // 3. Recibir la prioridad Y CONVERTIR
-    int prioridad_network;
-    bytes_recv = recv(socket_qc, &prioridad_network, sizeof(int), MSG_WAITALL);
+    log_info(logger, "Servidor Master iniciado en puerto %d", config_global->puerto_escucha);
+    log_info(logger, "Esperando conexiones de Query Control y Workers...");
     
-    if (bytes_recv <= 0) {
-        log_error(logger, "Error al recibir prioridad");
-        free(*path_query);
-        *path_query = NULL;
-        return;
+    struct epoll_event eventos_listos[MASTER_MAX_EVENTOS];
+    while (sistema_activo) {
+        int cantidad = epoll_wait(fd_epoll, eventos_listos, MASTER_MAX_EVENTOS, -1);
+        if (cantidad < 0) {
+            if (errno == EINTR) continue;
+            log_error(logger, "Error en epoll_wait: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < cantidad; i++) {
+            t_conexion* conexion = eventos_listos[i].data.ptr;
+
+            switch (conexion->tipo) {
+                case CONEXION_ESCUCHA:
+                    aceptar_clientes(conexion->socket);
+                    break;
+                case CONEXION_EVENTOS:
+                    atender_eventos_planificacion();
+                    break;
+                case CONEXION_AGING:
+                    atender_timer_aging(conexion->socket);
+                    break;
+                default: {
+                    uint32_t listos = eventos_listos[i].events;
+                    bool abierta = true;
+                    if (listos & EPOLLOUT) {
+                        abierta = vaciar_salida(conexion);
+                    }
+                    if (abierta && (listos & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                        abierta = leer_conexion(conexion);
+                    }
+                    if (!abierta) {
+                        cerrar_conexion(conexion);
+                    }
+                    break;
+                }
+            }
+        }
     }
-    
-    *prioridad = ntohl(prioridad_network);  // ← AGREGAR CONVERSIÓN
-    log_info(logger, "Prioridad recibida: %d", *prioridad);
-    log_info(logger, "Solicitud de Query Control procesada exitosamente");
+
+    // El eventfd lo cierra destruir_estructuras_master
+    if (aging != NULL) {
+        close(aging->socket);
+        free(aging);
+    }
+    free(eventos);
+    free(escucha);
+    dictionary_destroy(conexiones_por_socket); // Solo el índice, como antes no se liberan las conexiones al apagar
+    conexiones_por_socket = NULL;
+    close(fd_epoll);
+    fd_epoll = -1;
+    close(socket_servidor);
 }
 
 
-void* atender_query_control(void* args) {
-    t_args_hilo* argumentos = (t_args_hilo*)args;
-    int socket_qc = argumentos->socket_cliente;
-    free(argumentos);
+// QUERY
+int procesar_solicitud_query_control(int socket_qc, char* path_query, int prioridad) {
+    log_info(logger, "📨 QUERY RECIBIDA - Path: %s, Prioridad: %d", path_query, prioridad);
     
-    log_info(logger, "=== INICIANDO ATENCIÓN QUERY CONTROL (Socket %d) ===", socket_qc);
+    // Crear nueva query
+    t_query* nueva_query = crear_query(path_query, prioridad, socket_qc);
     
-    while (sistema_activo) {
-        char* path_query = NULL;
-        int prioridad = 0;
+    if (nueva_query == NULL) {
+        log_error(logger, "❌ Error al crear query");
+        return -1;
+    }
+    
+    log_info(logger, "Query %d creada exitosamente", nueva_query->query_id);
+    
+    agregar_query_a_ready(nueva_query);
 
-        log_info(logger, "Esperando solicitud de Query Control (Socket %d)...", socket_qc);
-        
-        recibir_solicitud_query_control(socket_qc, &path_query, &prioridad);
-        
-        if (path_query == NULL) {
-            log_warning(logger, "Query Control (Socket %d) envió datos inválidos o cerró conexión", socket_qc);
+    debug_mostrar_estado_queries();
+    // agregar_query_a_ready ya notificó al planificador
+    return nueva_query->query_id;
+}
+
+// Lote de queries de un mismo Query Control: [cantidad][[tam_path][path][prioridad]]...
+// en network byte order. Se admiten todas y se responde con un único QUERIES_ADMITIDAS
+// [cantidad][query_id]... en el mismo orden (-1 si no se pudo crear). Los resultados
+// posteriores llevan el query_id, así el Query Control los separa por query.
+bool procesar_lote_query_control(int socket_qc, const char* datos, uint32_t size) {
+    uint32_t cantidad_network;
+    memcpy(&cantidad_network, datos, sizeof(uint32_t));
+    uint32_t cantidad = ntohl(cantidad_network);
+
+    // Cada entrada ocupa al menos tam_path, un byte de path y la prioridad
+    if (cantidad == 0 || cantidad > (size - sizeof(uint32_t)) / (2 * sizeof(uint32_t) + 1)) {
+        log_error(logger, "Lote de queries inválido (Socket %d): %u queries en %u bytes",
+                  socket_qc, cantidad, size);
+        return false;
+    }
+
+    log_info(logger, "📨 LOTE DE QUERIES RECIBIDO - Socket: %d, Cantidad: %u", socket_qc, cantidad);
+
+    int* ids = malloc(cantidad * sizeof(int));
+    const char* actual = datos + sizeof(uint32_t);
+    const char* fin = datos + size;
+    uint32_t procesadas = 0;
+    uint32_t admitidas = 0;
+
+    for (; procesadas < cantidad; procesadas++) {
+        uint32_t tam_path_network;
+        int prioridad_network;
+        if (fin - actual < (ptrdiff_t)sizeof(uint32_t)) break;
+        memcpy(&tam_path_network, actual, sizeof(uint32_t));
+        uint32_t tam_path = ntohl(tam_path_network);
+
+        if (tam_path == 0 || tam_path > 10000 ||
+            (size_t)(fin - actual) < sizeof(uint32_t) + tam_path + sizeof(int)) {
+            log_error(logger, "Entrada %u del lote mal formada (Socket %d)", procesadas, socket_qc);
             break;
         }
 
-        log_info(logger, "📨 QUERY RECIBIDA - Path: %s, Prioridad: %d", path_query, prioridad);
-        
-        // Crear nueva query
-        t_query* nueva_query = crear_query(path_query, prioridad, socket_qc);
+        char* path_query = strndup(actual + sizeof(uint32_t), tam_path);
+        memcpy(&prioridad_network, actual + sizeof(uint32_t) + tam_path, sizeof(int));
+        actual += sizeof(uint32_t) + tam_path + sizeof(int);
+
+        t_query* query = crear_query(path_query, ntohl(prioridad_network), socket_qc);
         free(path_query);
-        
-        if (nueva_query == NULL) {
-            log_error(logger, "❌ Error al crear query");
-            continue;
-        }
-        
-        log_info(logger, "Query %d creada exitosamente", nueva_query->query_id);
-        
-        // AGREGAR DIAGNÓSTICO DETALLADO
-        LOCK_QUERIES();
-        int queries_antes = list_size(lista_queries_ready);
-        UNLOCK_QUERIES();
-        
-        log_info(logger, "Agregando Query %d a READY (antes: %d queries)", 
-                 nueva_query->query_id, queries_antes);
-        
-        agregar_query_a_ready(nueva_query);
-        
-        // VERIFICAR QUE SE AGREGÓ
-        LOCK_QUERIES();
-        int queries_despues = list_size(lista_queries_ready);
-        UNLOCK_QUERIES();
-        
-        if (queries_despues > queries_antes) {
-            log_info(logger, "Query %d agregada exitosamente a READY. Total: %d", 
-                     nueva_query->query_id, queries_despues);
-        } else {
-            log_error(logger, "Query %d NO se agregó a READY", nueva_query->query_id);
-            // Forzar planificación de todos modos
+
+        ids[procesadas] = -1;
+        if (query != NULL) {
+            agregar_query_a_ready(query);
+            ids[procesadas] = query->query_id;
+            admitidas++;
         }
+    }
 
-        debug_mostrar_estado_queries();
-        
-        // Planificar inmediatamente
-        log_info(logger, "Ejecutando planificación para Query %d", nueva_query->query_id);
-        planificar_siguiente_query();
+    // Las entradas que no llegaron a leerse se informan como rechazadas
+    for (uint32_t i = procesadas; i < cantidad; i++) {
+        ids[i] = -1;
     }
-    
-    log_info(logger, "=== FIN ATENCIÓN QUERY CONTROL (Socket %d) ===", socket_qc);
-    close(socket_qc);
-    return NULL;
+
+    op_code cod_op = QUERIES_ADMITIDAS;
+    struct iovec iov[] = {
+        { .iov_base = &cod_op, .iov_len = sizeof(op_code) },
+        { .iov_base = &cantidad, .iov_len = sizeof(uint32_t) },
+        { .iov_base = ids, .iov_len = cantidad * sizeof(int) },
+    };
+    if (!enviar_a_conexion(socket_qc, iov, 3)) {
+        log_error(logger, "Error al enviar QUERIES_ADMITIDAS al Query Control (Socket %d)", socket_qc);
+    }
+    free(ids);
+
+    log_info(logger, "Lote admitido - Socket: %d, Queries: %u/%u", socket_qc, admitidas, cantidad);
+    return true;
 }
 
 t_query* crear_query(char* path_query, int prioridad, int socket_qc) {
@@ -639,17 +1646,21 @@ t_query* crear_query(char* path_query, int prioridad, int socket_qc) {
     query->pc = 0;
     query->ciclos_en_ready = 0;
     query->cancelada = false;
+    query->indice_ready = -1;
+    query->en_envejecidas = false;
+    query->orden_llegada = 0;
+    query->tick_ingreso_ready = 0;
+    query->tiempo_ingreso_ready = 0;
 
     log_info(logger, "   - Campos inicializados");
 
     // AGREGAR A LISTA GLOBAL
-    pthread_mutex_lock(&mutex_queries);
     log_info(logger, "   - Mutex queries adquirido");
     
     list_add(lista_todas_queries, query);
+    indexar_query(query);
     int total_queries_global = list_size(lista_todas_queries);
     
-    pthread_mutex_unlock(&mutex_queries);
     log_info(logger, "   - Mutex queries liberado");
     
     log_info(logger, "Query %d creada exitosamente - Path: '%s', Prioridad: %d, Total queries global: %d", 
@@ -662,33 +1673,23 @@ t_query* crear_query(char* path_query, int prioridad, int socket_qc) {
 void agregar_query_a_ready(t_query* query) {
     log_info(logger, "📥 AGREGAR_QUERY_A_READY - Iniciando para Query %d", query->query_id);
     
-    pthread_mutex_lock(&mutex_queries);
     log_info(logger, "   - Mutex queries adquirido en agregar_query_a_ready");
     
     // Verificar estado actual de la lista
-    int queries_antes = list_size(lista_queries_ready);
+    int queries_antes = cola_ready_cantidad(cola_ready);
     log_info(logger, "   - Queries en READY antes: %d", queries_antes);
     
-    // Verificar que la query no esté ya en la lista
-    bool ya_existe = false;
-    for (int i = 0; i < list_size(lista_queries_ready); i++) {
-        t_query* q = list_get(lista_queries_ready, i);
-        if (q->query_id == query->query_id) {
-            ya_existe = true;
-            break;
-        }
-    }
-    
-    if (ya_existe) {
-        log_warning(logger, "   - Query %d ya está en lista_queries_ready", query->query_id);
+    // Verificar que la query no esté ya en la cola (indice_ready >= 0)
+    if (query->indice_ready >= 0) {
+        log_warning(logger, "   - Query %d ya está en cola_ready", query->query_id);
     } else {
         query->ciclos_en_ready = 0;
-        list_add(lista_queries_ready, query);
-        log_info(logger, "   - Query agregada a lista_queries_ready");
+        cola_ready_insertar(cola_ready, query);
+        log_info(logger, "   - Query agregada a cola_ready");
     }
     
     // Verificar que se agregó
-    int queries_despues = list_size(lista_queries_ready);
+    int queries_despues = cola_ready_cantidad(cola_ready);
     log_info(logger, "   - Queries en READY después: %d", queries_despues);
     
     if (queries_despues > queries_antes) {
@@ -697,12 +1698,10 @@ void agregar_query_a_ready(t_query* query) {
         log_error(logger, "Query %d NO se agregó a READY", query->query_id);
     }
     
-    pthread_mutex_unlock(&mutex_queries);
     log_info(logger, "   - Mutex queries liberado en agregar_query_a_ready");
     
-    // Asegurar que se llama a planificación
-    log_info(logger, "Llamando a planificar_siguiente_query...");
-    planificar_siguiente_query();
+    // Avisar al planificador
+    notificar_planificador(EVENTO_QUERY_NUEVA, query->query_id);
 }
 
 void mover_query_a_exec(t_query* query, int worker_id) {
@@ -713,7 +1712,7 @@ void mover_query_a_exec(t_query* query, int worker_id) {
     log_info(logger, "Query %d: READY → EXEC (Worker %d asignado)", query->query_id, worker_id);
 }
 
-void enviar_query_a_worker_sin_lock(t_query* query, t_worker* worker) {
+void enviar_query_a_worker(t_query* query, t_worker* worker) {
     log_info(logger, "ENVIANDO QUERY %d AL WORKER %d (sin lock)", query->query_id, worker->worker_id);
     
     // Verificar que el worker esté conectado
@@ -728,9 +1727,8 @@ void enviar_query_a_worker_sin_lock(t_query* query, t_worker* worker) {
         return;
     }
     
-    // ✅ MARCAR WORKER COMO OCUPADO (ya tenemos el mutex)
-    worker->ocupado = true;
-    worker->query_actual = query->query_id;
+    // ✅ MARCAR WORKER COMO OCUPADO
+    worker_pasar_a_ocupado(worker, query);
     
     // Enviar query al worker
     enviar_query_a_ejecutar(worker, query);
@@ -749,33 +1747,14 @@ void planificar_siguiente_query(void) {
     log_info(logger, "INICIANDO PLANIFICACIÓN - Buscando query para ejecutar");
 
     // ORDEN CORRECTO: queries -> workers -> planificacion
-    LOCK_QUERIES();
-    LOCK_WORKERS();
-    LOCK_PLANIFICACION();
     
-    int queries_ready = list_size(lista_queries_ready);
+    int queries_ready = cola_ready_cantidad(cola_ready);
     int workers_total = list_size(lista_workers);
-    int workers_libres = 0;
+    int workers_libres = cantidad_workers_libres();
     
     log_info(logger, "ESTADO ACTUAL PARA PLANIFICACIÓN:");
     log_info(logger, "   - Queries en READY: %d", queries_ready);
     log_info(logger, "   - Workers totales: %d", workers_total);
-
-    // Contar workers libres y mostrar estado detallado
-    for (int i = 0; i < workers_total; i++) {
-        t_worker* w = list_get(lista_workers, i);
-        log_info(logger, "   - Worker %d: ocupado=%s, conectado=%s, query_actual=%d", 
-                 w->worker_id, 
-                 w->ocupado ? "SI" : "NO",
-                 w->conectado ? "SI" : "NO", 
-                 w->query_actual);
-        // VERIFICAR QUE ESTÉ CONECTADO Y LIBRE
-        if (w->conectado && !w->ocupado) {
-            workers_libres++;
-        }
-    }
-
-    // Después de contar workers_libres, agregar log de diagnóstico
     log_info(logger, "Workers válidos y libres: %d", workers_libres);
 
     if (queries_ready == 0) {
@@ -799,25 +1778,25 @@ void planificar_siguiente_query(void) {
         t_worker* worker_asignado = NULL;
         
         // Obtener query según algoritmo
+        // La query se quita de la cola recién al tener worker: así conserva su orden de llegada
         if (strcmp(config_global->algoritmo_planificacion, "FIFO") == 0) {
-            if (!list_is_empty(lista_queries_ready)) {
-                query_a_ejecutar = list_get(lista_queries_ready, 0);
-                list_remove(lista_queries_ready, 0);
+            query_a_ejecutar = cola_ready_primera(cola_ready);
+            if (query_a_ejecutar != NULL) {
                 log_info(logger, "📝 FIFO - Query seleccionada: %d", query_a_ejecutar->query_id);
             }
             
-            // Obtener primer worker CONECTADO y libre
-            for (int i = 0; i < workers_total; i++) {
-                t_worker* w = list_get(lista_workers, i);
-                if (w->conectado && !w->ocupado) {
-                    worker_asignado = w;
-                    break;
-                }
-            }
+            // Obtener un worker CONECTADO y libre, con preferencia por localidad
+            worker_asignado = obtener_worker_libre_para(query_a_ejecutar);
         } 
         else if (strcmp(config_global->algoritmo_planificacion, "PRIORIDADES") == 0) {
-            query_a_ejecutar = obtener_query_mayor_prioridad();
+            query_a_ejecutar = cola_ready_primera(cola_ready);
             if (query_a_ejecutar != NULL) {
+                // Solo la cabeza necesita su prioridad con aging para compararse
+                int prioridad_anterior = query_a_ejecutar->prioridad;
+                if (cola_ready_materializar(cola_ready, query_a_ejecutar) != prioridad_anterior) {
+                    logging_cambio_prioridad(query_a_ejecutar->query_id, prioridad_anterior,
+                                             query_a_ejecutar->prioridad);
+                }
                 log_info(logger, "📝 PRIORIDADES - Query: %d (prioridad: %d)", 
                         query_a_ejecutar->query_id, query_a_ejecutar->prioridad);
                 
@@ -826,7 +1805,6 @@ void planificar_siguiente_query(void) {
                 if (worker_asignado == NULL) {
                     log_info(logger, "No hay worker disponible para Query %d", 
                             query_a_ejecutar->query_id);
-                    list_add(lista_queries_ready, query_a_ejecutar);
                     break;
                 }
             }
@@ -834,9 +1812,6 @@ void planificar_siguiente_query(void) {
         
         if (query_a_ejecutar == NULL || worker_asignado == NULL) {
             log_error(logger, "❌ No se pudo asignar query a worker");
-            if (query_a_ejecutar != NULL) {
-                list_add(lista_queries_ready, query_a_ejecutar);
-            }
             break;
         }
         
@@ -844,16 +1819,17 @@ void planificar_siguiente_query(void) {
         if (!worker_asignado->conectado) {
             log_warning(logger, "⚠️  Worker %d se desconectó antes de asignar query",
                        worker_asignado->worker_id);
-            list_add(lista_queries_ready, query_a_ejecutar);
             workers_libres--;
             continue;
         }
         
+        cola_ready_quitar(cola_ready, query_a_ejecutar);
+        
         log_info(logger, "🔗 ASIGNANDO Query %d → Worker %d", 
                 query_a_ejecutar->query_id, worker_asignado->worker_id);
         
         // ENVIAR QUERY AL WORKER
-        enviar_query_a_worker_sin_lock(query_a_ejecutar, worker_asignado);
+        enviar_query_a_worker(query_a_ejecutar, worker_asignado);
         queries_enviadas++;
 
         workers_libres--;
@@ -870,9 +1846,6 @@ void planificar_siguiente_query(void) {
     }
     
 cleanup:
-    UNLOCK_PLANIFICACION();
-    UNLOCK_WORKERS();
-    UNLOCK_QUERIES();
     
     log_info(logger, "🏁 FIN PLANIFICACIÓN");
 }
@@ -886,7 +1859,7 @@ void finalizar_query(t_query* query, const char* motivo) {
         struct stat socket_stat;
         if (fstat(query->socket_query_control, &socket_stat) == 0) {
             // Socket válido, enviar finalización
-            enviar_finalizacion_a_query_control(query->socket_query_control, motivo);
+            enviar_finalizacion_a_query_control(query->socket_query_control, query->query_id, motivo);
             log_info(logger, "Finalización enviada a Query Control para query %d: %s", 
                      query->query_id, motivo);
         } else {
@@ -908,9 +1881,10 @@ void cancelar_query(t_query* query) {
     query->cancelada = true;
     
     if (query->estado == QUERY_READY) {
+        cola_ready_quitar(cola_ready, query);
         finalizar_query(query, "Query Control desconectado");
     } else if (query->estado == QUERY_EXEC) {
-        t_worker* worker = buscar_worker_por_id(query->worker_asignado);
+        t_worker* worker = buscar_worker_por_query(query->query_id);
         if (worker != NULL) {
             desalojar_query_de_worker(worker, "DESCONEXION");
         }
@@ -918,20 +1892,22 @@ void cancelar_query(t_query* query) {
     }
 }
 
-// Versión CON LOCK - usar cuando NO se tiene el mutex
 t_query* buscar_query_por_id(int query_id) {
-    pthread_mutex_lock(&mutex_queries);
     
     t_query* query = buscar_query_por_id_unsafe(query_id);
     
-    pthread_mutex_unlock(&mutex_queries);
     return query;
 }
 
+// Devuelve una query en READY del Query Control.
 t_query* buscar_query_por_socket(int socket_qc) {
-    for (int i = 0; i < list_size(lista_queries_ready); i++) {
-        t_query* query = list_get(lista_queries_ready, i);
-        if (query->socket_query_control == socket_qc) {
+    char clave[16];
+    t_list* del_socket = dictionary_get(queries_por_socket, clave_indice(socket_qc, clave, sizeof(clave)));
+    if (del_socket == NULL) return NULL;
+
+    for (int i = 0; i < list_size(del_socket); i++) {
+        t_query* query = list_get(del_socket, i);
+        if (query->indice_ready >= 0) {
             return query;
         }
     }
@@ -941,10 +1917,9 @@ t_query* buscar_query_por_socket(int socket_qc) {
 void eliminar_query(t_query* query) {
     if (query != NULL) {
         // Remover de todas las listas
-        pthread_mutex_lock(&mutex_queries);
-        list_remove_element(lista_queries_ready, query);
+        cola_ready_quitar(cola_ready, query);
+        desindexar_query(query);
         list_remove_element(lista_todas_queries, query);
-        pthread_mutex_unlock(&mutex_queries);
         
         if (query->path_query != NULL) {
             free(query->path_query);
@@ -961,16 +1936,28 @@ t_worker* crear_worker(int socket_worker) {
     worker->worker_id = contador_worker_id++;  // Valor por defecto
     worker->worker_id_str = NULL;              // Inicializar como NULL
     worker->socket_worker = socket_worker;
+    worker->slot = 0;
     worker->ocupado = false;
     worker->conectado = true;
     worker->query_actual = -1;
+    worker->en_pila_libres = false;
+    worker->indice_ejecucion = -1;
+    worker->prioridad_query_actual = 0;
+    worker->desalojo_pendiente = false;
+    worker->motivo_desalojo = NULL;
+    worker->archivos_recientes = list_create();
     
     return worker;
 }
 
 void agregar_worker(t_worker* worker) {
-    LOCK_WORKERS();
     list_add(lista_workers, worker);
+    // Si el ID ya existía (reconexión) el índice apunta al worker nuevo; por ID se indexa el slot 0
+    if (worker->slot == 0) {
+        char clave[16];
+        dictionary_put(workers_por_id, clave_indice(worker->worker_id, clave, sizeof(clave)), worker);
+    }
+    worker_pasar_a_libre(worker);
     
     // DEBUG: Mostrar estado actual
     log_info(logger, "## Worker agregado - ID: %d | Total Workers: %d", 
@@ -979,49 +1966,15 @@ void agregar_worker(t_worker* worker) {
     // Mostrar todos los workers
     for (int i = 0; i < list_size(lista_workers); i++) {
         t_worker* w = list_get(lista_workers, i);
-        log_info(logger, "   - Worker %d: socket=%d, conectado=%d, ocupado=%d", 
-                 w->worker_id, w->socket_worker, w->conectado, w->ocupado);
+        log_info(logger, "   - Worker %d (slot %d): socket=%d, conectado=%d, ocupado=%d", 
+                 w->worker_id, w->slot, w->socket_worker, w->conectado, w->ocupado);
     }
     
-    UNLOCK_WORKERS();
 }
 
-void* atender_worker(void* args) {
-    t_args_hilo* argumentos = (t_args_hilo*)args;
-    int socket_worker = argumentos->socket_cliente;
-    free(argumentos);
-    
-    // Recibir el ID del worker después del handshake
-    char* worker_id = NULL;
-    
-    // Recibir tamaño del ID
-    uint32_t tam_id_network;
-    ssize_t bytes_recv = recv(socket_worker, &tam_id_network, sizeof(uint32_t), MSG_WAITALL);
-    
-    if (bytes_recv > 0) {
-        uint32_t tam_id = ntohl(tam_id_network);
-        
-        if (tam_id > 0 && tam_id < 1024) { // Límite razonable
-            worker_id = malloc(tam_id);
-            bytes_recv = recv(socket_worker, worker_id, tam_id, MSG_WAITALL);
-            
-            if (bytes_recv > 0) {
-                // Asegurar terminación NULL
-                if (worker_id[tam_id - 1] != '\0') {
-                    char* temp = realloc(worker_id, tam_id + 1);
-                    if (temp) {
-                        worker_id = temp;
-                        worker_id[tam_id] = '\0';
-                    }
-                }
-                log_info(logger, "Worker identificado con ID: %s", worker_id);
-            } else {
-                free(worker_id);
-                worker_id = NULL;
-            }
-        }
-    }
-    
+// Alta de un Worker que ya mandó su ID y cuántas queries ejecuta a la vez. Libera worker_id.
+// Devuelve los slots creados (el 0 primero) o NULL si falló la confirmación.
+t_list* registrar_worker(int socket_worker, char* worker_id, uint32_t capacidad) {
     // Si no se recibió ID, usar uno por defecto basado en contador
     if (worker_id == NULL) {
         worker_id = malloc(16);
@@ -1031,56 +1984,63 @@ void* atender_worker(void* args) {
 
     // Enviar confirmación al worker
     op_code cod_op_confirmacion = CONFIRMATION;
-    if (send(socket_worker, &cod_op_confirmacion, sizeof(op_code), MSG_NOSIGNAL) <= 0) {
+    struct iovec iov = { .iov_base = &cod_op_confirmacion, .iov_len = sizeof(op_code) };
+    if (!enviar_a_conexion(socket_worker, &iov, 1)) {
         log_warning(logger, "Error al enviar confirmación al Worker");
-        close(socket_worker);
         free(worker_id);
         return NULL;
     }
     
     log_info(logger, "Confirmación enviada al Worker (CONFIRMATION=103)");
 
+    if (capacidad == 0) capacidad = 1;
+    if (capacidad > MAX_QUERIES_POR_WORKER) capacidad = MAX_QUERIES_POR_WORKER;
+
     // Crear worker CON EL ID RECIBIDO
-    //pthread_mutex_lock(&mutex_workers);
     t_worker* worker = crear_worker(socket_worker);
     
     // Asignar el ID recibido
-    if (worker_id != NULL) {
-        int id_numerico = atoi(worker_id);
-        if (id_numerico > 0) {
-            worker->worker_id = id_numerico;
-            if (id_numerico >= contador_worker_id) {
-                contador_worker_id = id_numerico + 1;
-            }
+    int id_numerico = atoi(worker_id);
+    if (id_numerico > 0) {
+        worker->worker_id = id_numerico;
+        if (id_numerico >= contador_worker_id) {
+            contador_worker_id = id_numerico + 1;
         }
-        log_info(logger, "Worker %d asociado con ID recibido: %s", worker->worker_id, worker_id);
-        free(worker_id);
+    }
+    log_info(logger, "Worker %d asociado con ID recibido: %s - Queries simultáneas: %u",
+             worker->worker_id, worker_id, capacidad);
+    free(worker_id);
+
+    // Un slot por query simultánea: mismo ID y socket, se planifican por separado
+    t_list* slots = list_create();
+    list_add(slots, worker);
+    for (uint32_t i = 1; i < capacidad; i++) {
+        t_worker* slot = crear_worker(socket_worker);
+        slot->worker_id = worker->worker_id;
+        slot->slot = i;
+        list_add(slots, slot);
     }
 
-    agregar_worker(worker);
-    //pthread_mutex_unlock(&mutex_workers);
+    for (int i = 0; i < list_size(slots); i++) {
+        agregar_worker(list_get(slots, i));
+    }
     
     // Log de conexión
     logging_conexion_worker(worker);
     
-    // FORZAR PLANIFICACIÓN INMEDIATA AL CONECTAR WORKER
-    log_info(logger, "🔄 Worker conectado - Ejecutando planificación inmediata");
-    planificar_siguiente_query();
-    
-    // PROCESAR MENSAJES (PUEDE DURAR MUCHO TIEMPO)
-    procesar_mensajes_worker(worker);
-
-    // AL SALIR DEL LOOP, YA SE MANEJÓ LA DESCONEXIÓN
-    log_info(logger, "Hilo de Worker %d terminando", worker->worker_id);
+    // AVISAR AL PLANIFICADOR QUE HAY UN WORKER NUEVO
+    log_info(logger, "🔄 Worker conectado - Notificando al planificador");
+    notificar_planificador(EVENTO_WORKER_CONECTADO, worker->worker_id);
 
-    return NULL;
+    return slots;
 }
 
 t_worker* obtener_worker_libre(void) {
     log_info(logger, "🔍 Buscando worker libre...");
     
-    for (int i = 0; i < list_size(lista_workers); i++) {
-        t_worker* worker = list_get(lista_workers, i);
+    while (!list_is_empty(pila_workers_libres)) {
+        t_worker* worker = list_remove(pila_workers_libres, list_size(pila_workers_libres) - 1);
+        worker->en_pila_libres = false;
         
         if (!worker->ocupado && worker->conectado) {
             log_info(logger, "Worker %d encontrado (libre y conectado)", worker->worker_id);
@@ -1090,9 +2050,6 @@ t_worker* obtener_worker_libre(void) {
             worker->query_actual = -2; // Estado temporal
             
             return worker;
-        } else {
-            log_debug(logger, "Worker %d no disponible (ocupado=%d, conectado=%d)", 
-                     worker->worker_id, worker->ocupado, worker->conectado);
         }
     }
     
@@ -1100,8 +2057,131 @@ t_worker* obtener_worker_libre(void) {
     return NULL;
 }
 
+static void destruir_lista_archivos(t_list* archivos) {
+    list_destroy_and_destroy_elements(archivos, free);
+}
+
+static bool lista_contiene_archivo(t_list* archivos, const char* file_tag) {
+    for (int i = 0; i < list_size(archivos); i++) {
+        if (strcmp(list_get(archivos, i), file_tag) == 0) return true;
+    }
+    return false;
+}
+
+// Cuántos de los file:tags del script usó hace poco
+// el proceso del slot (la localidad es del proceso: los slots comparten la memoria).
+static int afinidad_worker(t_worker* worker, t_list* archivos_script) {
+    t_worker* proceso = buscar_worker_por_id(worker->worker_id);
+    if (proceso == NULL || proceso->socket_worker != worker->socket_worker) return 0;
+
+    int afinidad = 0;
+    for (int i = 0; i < list_size(archivos_script); i++) {
+        if (lista_contiene_archivo(proceso->archivos_recientes, list_get(archivos_script, i))) afinidad++;
+    }
+    return afinidad;
+}
+
+// Entre los últimos MAX_CANDIDATOS_LOCALIDAD workers
+// libres prefiere el que ya tiene en memoria los file:tags que usó el script la última
+// vez; si ninguno los tiene (o no se conocen) la query la toma el primer libre, como antes.
+// El costo por despacho queda acotado por las constantes, no por la cantidad de workers.
+t_worker* obtener_worker_libre_para(t_query* query) {
+    t_list* archivos = query != NULL ? dictionary_get(archivos_por_script, query->path_query) : NULL;
+    if (archivos == NULL || list_size(pila_workers_libres) < 2) return obtener_worker_libre();
+
+    int mejor = -1;
+    int mejor_afinidad = 0;
+    int tope = list_size(pila_workers_libres) - 1;
+    int limite = tope - MAX_CANDIDATOS_LOCALIDAD + 1 > 0 ? tope - MAX_CANDIDATOS_LOCALIDAD + 1 : 0;
+    // Desde el tope: a igual afinidad gana el liberado más recientemente
+    for (int i = tope; i >= limite; i--) {
+        t_worker* worker = list_get(pila_workers_libres, i);
+        if (worker->ocupado || !worker->conectado) continue;
+
+        int afinidad = afinidad_worker(worker, archivos);
+        if (afinidad > mejor_afinidad) {
+            mejor = i;
+            mejor_afinidad = afinidad;
+        }
+    }
+
+    if (mejor == -1) return obtener_worker_libre();
+
+    t_worker* worker = list_remove(pila_workers_libres, mejor);
+    worker->en_pila_libres = false;
+    worker->ocupado = true;
+    worker->query_actual = -2; // Estado temporal
+
+    log_info(logger, "Worker %d elegido por localidad para Query %d (%d de %d archivos recientes)",
+             worker->worker_id, query->query_id, mejor_afinidad, list_size(archivos));
+    return worker;
+}
+
+// Pasa los file:tags al final de los recientes del proceso.
+static void registrar_archivos_recientes(t_worker* proceso, t_list* archivos) {
+    for (int i = 0; i < list_size(archivos); i++) {
+        char* file_tag = list_get(archivos, i);
+        for (int j = 0; j < list_size(proceso->archivos_recientes); j++) {
+            if (strcmp(list_get(proceso->archivos_recientes, j), file_tag) == 0) {
+                free(list_remove(proceso->archivos_recientes, j));
+                break;
+            }
+        }
+        list_add(proceso->archivos_recientes, strdup(file_tag));
+    }
+    while (list_size(proceso->archivos_recientes) > MAX_ARCHIVOS_RECIENTES) {
+        free(list_remove(proceso->archivos_recientes, 0));
+    }
+}
+
+static void olvidar_script(const char* path) {
+    for (int i = 0; i < list_size(scripts_por_antiguedad); i++) {
+        if (strcmp(list_get(scripts_por_antiguedad, i), path) == 0) {
+            free(list_remove(scripts_por_antiguedad, i));
+            break;
+        }
+    }
+    t_list* archivos = dictionary_remove(archivos_por_script, (char*)path);
+    if (archivos != NULL) destruir_lista_archivos(archivos);
+}
+
+// Toma la lista 'archivos'; con más de
+// MAX_SCRIPTS_CON_LOCALIDAD scripts se olvida el que corrió hace más tiempo.
+static void recordar_archivos_script(const char* path, t_list* archivos) {
+    olvidar_script(path);
+    dictionary_put(archivos_por_script, (char*)path, archivos);
+    list_add(scripts_por_antiguedad, strdup(path));
+
+    while (list_size(scripts_por_antiguedad) > MAX_SCRIPTS_CON_LOCALIDAD) {
+        char* mas_viejo = list_remove(scripts_por_antiguedad, 0);
+        t_list* viejos = dictionary_remove(archivos_por_script, mas_viejo);
+        if (viejos != NULL) destruir_lista_archivos(viejos);
+        free(mas_viejo);
+    }
+}
+
+// Lo que informó el Worker al terminar la query: qué file:tags tiene ahora en memoria
+// y cuáles usa el script. Toma la lista 'archivos'.
+static void registrar_localidad(t_worker* worker, uint32_t query_id, t_list* archivos) {
+    t_query* query = buscar_query_por_id_unsafe(query_id);
+    char* path = query != NULL ? strdup(query->path_query) : NULL;
+
+    t_worker* proceso = buscar_worker_por_id(worker->worker_id);
+    if (proceso != NULL && proceso->socket_worker == worker->socket_worker) {
+        registrar_archivos_recientes(proceso, archivos);
+    }
+
+    if (path != NULL && !list_is_empty(archivos)) {
+        recordar_archivos_script(path, archivos);
+        archivos = NULL;
+    }
+
+    if (archivos != NULL) destruir_lista_archivos(archivos);
+    free(path);
+}
+
 t_worker* seleccionar_worker_prioridades(t_query* query_nueva) {
-    t_worker* worker_libre = obtener_worker_libre();
+    t_worker* worker_libre = obtener_worker_libre_para(query_nueva);
     
     if (worker_libre != NULL) {
         return worker_libre;
@@ -1110,220 +2190,190 @@ t_worker* seleccionar_worker_prioridades(t_query* query_nueva) {
     // No hay workers libres, buscar uno con menor prioridad
     t_worker* worker_menor_prioridad = obtener_worker_con_menor_prioridad();
     
-    if (worker_menor_prioridad != NULL) {
-        t_query* query_actual = buscar_query_por_id(worker_menor_prioridad->query_actual);
-        
-        if (query_actual != NULL && query_nueva->prioridad < query_actual->prioridad) {
-            // Desalojar query actual
-            desalojar_query_de_worker(worker_menor_prioridad, "PRIORIDAD");
-            return worker_menor_prioridad;
-        }
+    if (worker_menor_prioridad != NULL &&
+        query_nueva->prioridad < worker_menor_prioridad->prioridad_query_actual) {
+        // Desalojar query actual; el worker se libera cuando llega su contexto y
+        // esta query se despacha en esa pasada de planificación
+        desalojar_query_de_worker(worker_menor_prioridad, "PRIORIDAD");
     }
     
     return NULL;
 }
 
+// La raíz del heap es la query en ejecución con
+// mayor número de prioridad (menor prioridad).
 t_worker* obtener_worker_con_menor_prioridad(void) {
-    t_worker* worker_menor = NULL;
-    int menor_prioridad = -1;  // Buscar el MAYOR número (menor prioridad)
-    
-    for (int i = 0; i < list_size(lista_workers); i++) {
-        t_worker* worker = list_get(lista_workers, i);
-        
-        if (worker->ocupado && worker->conectado) {
-            t_query* query = buscar_query_por_id(worker->query_actual);
-            
-            if (query != NULL) {
-                // Buscar la query con MAYOR número (menor prioridad)
-                if (menor_prioridad == -1 || query->prioridad > menor_prioridad) {
-                    menor_prioridad = query->prioridad;
-                    worker_menor = worker;
-                }
-            }
-        }
+    if (cantidad_en_ejecucion == 0) {
+        return NULL;
     }
     
-    if (worker_menor != NULL) {
-        log_debug(logger, "Worker con menor prioridad: Worker %d (prioridad: %d)", 
-                 worker_menor->worker_id, menor_prioridad);
-    }
+    t_worker* worker_menor = workers_en_ejecucion[0];
+    log_debug(logger, "Worker con menor prioridad: Worker %d (prioridad: %d)", 
+             worker_menor->worker_id, worker_menor->prioridad_query_actual);
     
     return worker_menor;
 }
 
 t_worker* buscar_worker_por_id(int worker_id) {
-    for (int i = 0; i < list_size(lista_workers); i++) {
-        t_worker* worker = list_get(lista_workers, i);
-        if (worker->worker_id == worker_id) {
-            return worker;
-        }
-    }
-    return NULL;
+    char clave[16];
+    return dictionary_get(workers_por_id, clave_indice(worker_id, clave, sizeof(clave)));
+}
+
+// Slot que está ejecutando la query, o NULL.
+t_worker* buscar_worker_por_query(int query_id) {
+    char clave[16];
+    return dictionary_get(workers_por_query, clave_indice(query_id, clave, sizeof(clave)));
+}
+
+static bool query_esta_encolada(t_query* query) {
+    return query->indice_ready >= 0;
 }
 
 // Función para manejar desconexión de Query Control
 void manejar_desconexion_query_control(int socket_qc) {
-    pthread_mutex_lock(&mutex_queries);
     
-    // Buscar todas las queries de este Query Control
-    for (int i = list_size(lista_queries_ready) - 1; i >= 0; i--) {
-        t_query* query = list_get(lista_queries_ready, i);
-        if (query->socket_query_control == socket_qc) {
-            log_info(logger, "Cancelando query %d por desconexión de Query Control", 
-                     query->query_id);
-            logging_desconexion_query_control(query);
-            cancelar_query(query);
-        }
-    }
+    // Buscar las queries en READY de este Query Control (cancelar_query las quita de la cola)
+    char clave[16];
+    t_list* del_socket = dictionary_get(queries_por_socket, clave_indice(socket_qc, clave, sizeof(clave)));
+    t_list* encoladas = del_socket != NULL
+        ? list_filter(del_socket, (void*)query_esta_encolada)
+        : list_create();
+    for (int i = 0; i < list_size(encoladas); i++) {
+        t_query* query = list_get(encoladas, i);
+        log_info(logger, "Cancelando query %d por desconexión de Query Control", 
+                 query->query_id);
+        logging_desconexion_query_control(query);
+        cancelar_query(query);
+    }
+    list_destroy(encoladas);
     
-    pthread_mutex_unlock(&mutex_queries);
 }
 
-void mostrar_resultado_read_consola(uint32_t query_id, int worker_id, const char* file_tag, uint32_t size_datos, char* datos) {
-    printf("\n");
-    printf("────────────────────────────────────────────────────────────────────────────────\n");
-    printf("                     RESULTADO READ - MASTER\n");
-    printf("────────────────────────────────────────────────────────────────────────────────\n");
-    printf("Query ID:  %u\n", query_id);
-    printf("Worker ID: %d\n", worker_id);
-    printf("File:      %s\n", file_tag);
-    printf("Tamaño:    %u bytes\n", size_datos);
-    printf("────────────────────────────────────────────────────────────────────────────────\n");
-    printf("Datos leídos:\n");
-    printf("\n");
-    
-    // Procesar el buffer para concatenar bloques y manejar \0 como separadores
-    char* buffer_procesado = malloc(size_datos + 1);
-    uint32_t pos_procesado = 0;
-    uint32_t pos_original = 0;
-    
-    while (pos_original < size_datos) {
-        // Buscar el próximo carácter no nulo
-        uint32_t inicio_linea = pos_original;
-        while (inicio_linea < size_datos && datos[inicio_linea] == '\0') {
-            inicio_linea++;
-        }
-        
-        if (inicio_linea >= size_datos) break;
-        
-        // Encontrar el final de esta "línea" (próximo \0 o fin del buffer)
-        uint32_t fin_linea = inicio_linea;
-        while (fin_linea < size_datos && datos[fin_linea] != '\0') {
-            fin_linea++;
-        }
-        
-        // Copiar esta línea al buffer procesado
-        uint32_t longitud_linea = fin_linea - inicio_linea;
-        if (longitud_linea > 0) {
-            // Si no es la primera línea, agregar salto de línea
-            if (pos_procesado > 0) {
-                buffer_procesado[pos_procesado++] = '\n';
-            }
-            
-            memcpy(buffer_procesado + pos_procesado, datos + inicio_linea, longitud_linea);
-            pos_procesado += longitud_linea;
-        }
-        
-        pos_original = fin_linea + 1; // Saltar el \0
-    }
-    
-    // Terminar el string
-    buffer_procesado[pos_procesado] = '\0';
-    
-    // Mostrar el resultado procesado
-    if (pos_procesado > 0) {
-        printf("%s\n", buffer_procesado);
-    } else {
-        printf("(Sin datos visibles)\n");
-    }
-    
-    free(buffer_procesado);
-    printf("────────────────────────────────────────────────────────────────────────────────\n");
-    printf("\n");
+// Reenvía un tramo de READ al Query Control dueño de la query, con un solo envío y sin
+// copiar los datos: [op][query_id][tam_file_tag][file_tag][offset][ultimo][size][datos]
+static bool reenviar_tramo_a_query_control(int socket_qc, uint32_t query_id, const char* file_tag,
+                                           uint32_t offset, uint32_t ultimo, const char* datos, uint32_t size) {
+    op_code cod_op = RESULTADO_READ_PARCIAL;
+    uint32_t tam_file_tag = strlen(file_tag) + 1;
+
+    struct iovec iov[] = {
+        { .iov_base = &cod_op, .iov_len = sizeof(op_code) },
+        { .iov_base = &query_id, .iov_len = sizeof(uint32_t) },
+        { .iov_base = &tam_file_tag, .iov_len = sizeof(uint32_t) },
+        { .iov_base = (void*)file_tag, .iov_len = tam_file_tag },
+        { .iov_base = &offset, .iov_len = sizeof(uint32_t) },
+        { .iov_base = &ultimo, .iov_len = sizeof(uint32_t) },
+        { .iov_base = &size, .iov_len = sizeof(uint32_t) },
+        { .iov_base = (void*)datos, .iov_len = size },
+    };
+    return enviar_a_conexion(socket_qc, iov, size > 0 ? 8 : 7);
 }
 
-void procesar_mensaje_lectura(t_worker* worker) {
-    // Consumir el paquete que contiene query_id
-    t_list* elementos = recibir_paquete(logger, worker->socket_worker);
-    
-    if (elementos == NULL || list_size(elementos) == 0) {
+void procesar_mensaje_lectura(t_worker* worker, const t_vista_paquete* vista) {
+    // El paquete contiene query_id
+    uint32_t query_id_notif;
+    if (vista == NULL || vista->cantidad == 0 || !campo_leer_uint32(&vista->campos[0], &query_id_notif)) {
         log_error(logger, "Error al recibir paquete MENSAJE_LECTURA del Worker %d", worker->worker_id);
-        if (elementos) list_destroy_and_destroy_elements(elementos, free);
         return;
     }
     
-    // Extraer query_id del primer elemento
-    uint32_t query_id_notif;
-    void* elem = list_get(elementos, 0);
-    memcpy(&query_id_notif, elem, sizeof(uint32_t));
-    
     log_info(logger, "Worker %d notifica inicio de operación READ - Query %u", 
              worker->worker_id, query_id_notif);
-    
-    list_destroy_and_destroy_elements(elementos, free);
 }
 
-void procesar_resultado_read(t_worker* worker) {
-    log_info(logger, "Procesando resultado de READ del Worker %d", worker->worker_id);
-    
-    // Recibir lista de elementos
-    t_list* elementos = recibir_paquete(logger, worker->socket_worker);
-    
-    if (elementos == NULL || list_size(elementos) < 4) {  // Son 4 elementos
-        log_error(logger, "Error al recibir elementos de RESULTADO_READ del Worker %d", worker->worker_id);
-        if (elementos) list_destroy_and_destroy_elements(elementos, free);
+// Tramo de un READ: [query_id][file_tag][offset][ultimo][datos]. Se reenvía al
+// Query Control directo desde el buffer de recepción, sin acumular el resultado.
+void procesar_resultado_read(t_worker* worker, const t_vista_paquete* vista) {
+    if (vista == NULL || vista->cantidad < 5) {
+        log_error(logger, "Error al recibir elementos de RESULTADO_READ_PARCIAL del Worker %d", worker->worker_id);
         return;
     }
     
-    // Parsear elementos: [query_id, file_tag, size, datos]
     uint32_t query_id_recibido;
-    void* elem0 = list_get(elementos, 0);
-    memcpy(&query_id_recibido, elem0, sizeof(uint32_t));
-
-    logging_envio_lectura(query_id_recibido, worker->worker_id);
-    
-    // COPIAR FILE_TAG ANTES DE DESTRUIR LA LISTA
-    char* file_tag_orig = (char*)list_get(elementos, 1);
-    char* file_tag = strdup(file_tag_orig);
-    
-    uint32_t size_datos;
-    void* elem2 = list_get(elementos, 2);
-    memcpy(&size_datos, elem2, sizeof(uint32_t));
-    
-    char* datos_leidos_orig = (char*)list_get(elementos, 3);
-    
-    // Validar datos recibidos
-    if (size_datos == 0 || datos_leidos_orig == NULL) {
-        log_error(logger, "Datos READ inválidos del Worker %d", worker->worker_id);
-        list_destroy_and_destroy_elements(elementos, free);
+    uint32_t offset;
+    uint32_t ultimo;
+    const char* file_tag = campo_string(&vista->campos[1]);
+    const t_campo_paquete* datos = &vista->campos[4];
+
+    if (!campo_leer_uint32(&vista->campos[0], &query_id_recibido) || file_tag == NULL ||
+        !campo_leer_uint32(&vista->campos[2], &offset) ||
+        !campo_leer_uint32(&vista->campos[3], &ultimo)) {
+        log_error(logger, "Campos de RESULTADO_READ_PARCIAL inválidos del Worker %d", worker->worker_id);
         return;
     }
-    
-    // COPIAR DATOS ANTES DE DESTRUIR LA LISTA
-    char* datos_copia = malloc(size_datos + 1);
-    if (datos_copia == NULL) {
-        log_error(logger, "Error al allocar memoria para datos READ");
-        free(file_tag);
-        list_destroy_and_destroy_elements(elementos, free);
+
+    t_query* query = buscar_query_por_id_unsafe(query_id_recibido);
+    int socket_qc = query != NULL ? query->socket_query_control : -1;
+
+    if (offset == 0) {
+        logging_envio_lectura(query_id_recibido, worker->worker_id);
+    }
+
+    // Las desconexiones de Query Control las procesa este mismo hilo: el socket sigue siendo suyo
+    if (socket_qc == -1) {
+        log_warning(logger, "Tramo READ de Query %u sin Query Control conectado - se descarta", query_id_recibido);
+    } else if (!reenviar_tramo_a_query_control(socket_qc, query_id_recibido, file_tag, offset, ultimo, datos->datos, datos->tam)) {
+        log_error(logger, "Error al reenviar tramo READ de Query %u al Query Control", query_id_recibido);
+    } else {
+        frenar_si_saturada(socket_qc, query_id_recibido, worker->socket_worker);
+    }
+
+    if (ultimo) {
+        log_info(logger, "✓ READ completado - Query %u | Worker %d | File: %s | Tamaño: %u bytes", 
+                 query_id_recibido, worker->worker_id, file_tag, offset + (uint32_t)datos->tam);
+    }
+}
+
+// Perfil de memoria que el Worker envía antes del END:
+// [query_id][t_metricas_memoria][cantidad][file_tag, t_metricas_memoria]...
+void procesar_metricas_memoria(t_worker* worker, const t_vista_paquete* vista) {
+    uint32_t query_id;
+    t_metricas_memoria totales;
+    uint32_t cantidad;
+
+    if (vista == NULL || vista->cantidad < 3 ||
+        !campo_leer_uint32(&vista->campos[0], &query_id) ||
+        vista->campos[1].tam < (int)sizeof(t_metricas_memoria) ||
+        !campo_leer_uint32(&vista->campos[2], &cantidad)) {
+        log_error(logger, "Error al recibir METRICAS_MEMORIA del Worker %d", worker->worker_id);
         return;
     }
-    
-    memcpy(datos_copia, datos_leidos_orig, size_datos);
-    datos_copia[size_datos] = '\0';
-    
-    // AHORA SÍ PODEMOS DESTRUIR LA LISTA ORIGINAL
-    list_destroy_and_destroy_elements(elementos, free);
-    
+    memcpy(&totales, vista->campos[1].datos, sizeof(t_metricas_memoria));
 
-    // MOSTRAR RESULTADO CON FILE_TAG
-    mostrar_resultado_read_consola(query_id_recibido, worker->worker_id, file_tag, size_datos, datos_copia);
-    
-    log_info(logger, "✓ READ completado - Query %u | Worker %d | File: %s | Tamaño: %u bytes", 
-             query_id_recibido, worker->worker_id, file_tag, size_datos);
-    
-    // LIBERAR COPIAS
-    free(datos_copia);
-    free(file_tag);
+    uint64_t accesos = totales.hits + totales.misses;
+    log_info(logger, "## Query %u - Memoria Worker %d: hits=%lu misses=%lu (hit ratio %.1f%%) precargas=%lu desalojos=%lu escrituras=%lu (%lu bytes)",
+             query_id, worker->worker_id,
+             (unsigned long)totales.hits, (unsigned long)totales.misses,
+             accesos ? (100.0 * totales.hits) / accesos : 0.0,
+             (unsigned long)totales.precargas, (unsigned long)totales.desalojos,
+             (unsigned long)totales.escrituras, (unsigned long)totales.bytes_escritos);
+
+    // Los pares por archivo pueden no entrar en la vista: se recorren con un cursor
+    t_cursor_paquete cursor;
+    const t_campo_paquete* ultimo = &vista->campos[2];
+    cursor_paquete_iniciar(&cursor, ultimo->datos + ultimo->tam, vista->resto.fin - (ultimo->datos + ultimo->tam));
+
+    t_list* archivos = list_create();
+    t_campo_paquete campo_tag;
+    t_campo_paquete campo_metricas;
+    for (uint32_t i = 0; i < cantidad &&
+                         cursor_paquete_siguiente(&cursor, &campo_tag) &&
+                         cursor_paquete_siguiente(&cursor, &campo_metricas); i++) {
+        const char* file_tag = campo_string(&campo_tag);
+        if (file_tag == NULL || campo_metricas.tam < (int)sizeof(t_metricas_memoria)) break;
+
+        t_metricas_memoria metricas;
+        memcpy(&metricas, campo_metricas.datos, sizeof(t_metricas_memoria));
+
+        log_info(logger, "##   %s: hits=%lu misses=%lu precargas=%lu desalojos=%lu escrituras=%lu",
+                 file_tag, (unsigned long)metricas.hits, (unsigned long)metricas.misses,
+                 (unsigned long)metricas.precargas, (unsigned long)metricas.desalojos,
+                 (unsigned long)metricas.escrituras);
+
+        if (list_size(archivos) < MAX_ARCHIVOS_RECIENTES) list_add(archivos, strdup(file_tag));
+    }
+
+    registrar_localidad(worker, query_id, archivos);
 }
 
 void procesar_end_worker(t_worker* worker) {
@@ -1340,12 +2390,10 @@ void procesar_end_worker(t_worker* worker) {
     }
     
     // 1. LIBERAR WORKER INMEDIATAMENTE (ANTES de procesar query)
-    worker->ocupado = false;
-    worker->query_actual = -1;
+    worker_pasar_a_libre(worker);
     log_info(logger, "Worker %d marcado como LIBRE", worker->worker_id);
     
     // 2. PROCESAR FINALIZACIÓN DE QUERY
-    pthread_mutex_lock(&mutex_queries);
     t_query* query = buscar_query_por_id_unsafe(query_id_finalizada);
     
     if (query != NULL) {
@@ -1356,8 +2404,8 @@ void procesar_end_worker(t_worker* worker) {
         // Finalizar la query exitosamente
         finalizar_query(query, "Query finalizada con END");
         
-        // Remover de lista_queries_ready si está ahí
-        list_remove_element(lista_queries_ready, query);
+        // Remover de cola_ready si está ahí
+        cola_ready_quitar(cola_ready, query);
         
         log_info(logger, "Query %d finalizada exitosamente", query->query_id);
     } else {
@@ -1365,58 +2413,15 @@ void procesar_end_worker(t_worker* worker) {
                    query_id_finalizada);
     }
     
-    int queries_ready = list_size(lista_queries_ready);
-    pthread_mutex_unlock(&mutex_queries);
-    
-    // 3. CONTAR WORKERS LIBRES
-    pthread_mutex_lock(&mutex_workers);
-    int workers_libres = 0;
-    int workers_total = list_size(lista_workers);
-    
-    log_info(logger, "Estado de Workers:");
-    for (int i = 0; i < workers_total; i++) {
-        t_worker* w = list_get(lista_workers, i);
-        log_info(logger, "   - Worker %d: conectado=%s, ocupado=%s, query=%d",
-                 w->worker_id,
-                 w->conectado ? "SI" : "NO",
-                 w->ocupado ? "SI" : "NO",
-                 w->query_actual);
-        
-        if (!w->ocupado && w->conectado) {
-            workers_libres++;
-        }
-    }
-    pthread_mutex_unlock(&mutex_workers);
-    
-    log_info(logger, "Estado actual:");
-    log_info(logger, "   - Queries en READY: %d", queries_ready);
-    log_info(logger, "   - Workers libres: %d de %d", workers_libres, workers_total);
+    int queries_ready = cola_ready_cantidad(cola_ready);
     
-    // 4. FORZAR REPLANIFICACIÓN MÚLTIPLE SI ES NECESARIO
-    if (queries_ready > 0 && workers_libres > 0) {
-        log_info(logger, "═══════════════════════════════════════════════");
-        log_info(logger, "INICIANDO REPLANIFICACIÓN POST-END");
-        log_info(logger, "═══════════════════════════════════════════════");
-        
-        // Planificar tantas veces como sea necesario
-        int planificaciones = (queries_ready < workers_libres) ? queries_ready : workers_libres;
-        
-        for (int i = 0; i < planificaciones; i++) {
-            log_info(logger, "Planificación %d de %d", i + 1, planificaciones);
-            planificar_siguiente_query();
-            
-            // Pequeño delay para evitar race conditions
-            if (i < planificaciones - 1) {
-                usleep(10000); // 10ms
-            }
-        }
-        
-        log_info(logger, "Completadas %d planificaciones", planificaciones);
-    } else if (queries_ready > 0) {
-        log_warning(logger, "Hay %d queries pendientes pero NO hay workers libres", queries_ready);
+    // 3. AVISAR AL PLANIFICADOR (UNA SOLA PASADA AUNQUE LLEGUEN VARIOS END JUNTOS)
+    if (queries_ready > 0) {
+        log_info(logger, "Hay %d queries en READY - notificando al planificador", queries_ready);
     } else {
         log_info(logger, "No hay queries pendientes - sistema en espera");
     }
+    notificar_planificador(EVENTO_WORKER_LIBRE, worker->worker_id);
     
     log_info(logger, "═══════════════════════════════════════════════");
     log_info(logger, "END procesado completamente para Worker %d", worker->worker_id);
@@ -1434,12 +2439,12 @@ void manejar_desconexion_worker_inmediata(t_worker* worker) {
     // Marcar worker como desconectado INMEDIATAMENTE
     worker->conectado = false;
     worker->ocupado = false;
+    worker_quitar_de_indices(worker);
     
     if (tenia_query) {
         log_warning(logger, "Worker %d estaba ejecutando Query %d", worker->worker_id, query_actual);
         
         // Reasignar la query a READY
-        pthread_mutex_lock(&mutex_queries);
         t_query* query = buscar_query_por_id_unsafe(query_actual);
         
         if (query != NULL && query->estado == QUERY_EXEC) {
@@ -1452,45 +2457,33 @@ void manejar_desconexion_worker_inmediata(t_worker* worker) {
             query->pc = 0; // Reiniciar desde el inicio
             query->ciclos_en_ready = 0;
             
-            // Verificar que no esté duplicada en READY
-            bool ya_existe = false;
-            for (int i = 0; i < list_size(lista_queries_ready); i++) {
-                t_query* q = list_get(lista_queries_ready, i);
-                if (q->query_id == query->query_id) {
-                    ya_existe = true;
-                    break;
-                }
-            }
-            
-            if (!ya_existe) {
-                list_add(lista_queries_ready, query);
+            // cola_ready_insertar ignora la query si ya está en READY
+            if (cola_ready_insertar(cola_ready, query)) {
                 log_info(logger, "Query %d reingresada a READY (total: %d queries)", 
-                         query->query_id, list_size(lista_queries_ready));
+                         query->query_id, cola_ready_cantidad(cola_ready));
             }
         }
-        pthread_mutex_unlock(&mutex_queries);
     }
     
     // Liberar worker_actual
     worker->query_actual = -1;
 
-    logging_desconexion_worker(worker, query_actual);
+    // La conexión se informa una vez (slot 0); los demás slots solo si tenían query
+    if (worker->slot == 0 || query_actual != -1) {
+        logging_desconexion_worker(worker, query_actual);
+    }
     
     // Contar workers activos restantes
-    pthread_mutex_lock(&mutex_workers);
     int workers_activos = 0;
     for (int i = 0; i < list_size(lista_workers); i++) {
         t_worker* w = list_get(lista_workers, i);
         if (w->conectado) workers_activos++;
     }
-    pthread_mutex_unlock(&mutex_workers);
     
     log_warning(logger, "Workers activos restantes: %d", workers_activos);
     
     // FORZAR REPLANIFICACIÓN INMEDIATA SI HAY QUERIES PENDIENTES
-    pthread_mutex_lock(&mutex_queries);
-    int queries_pendientes = list_size(lista_queries_ready);
-    pthread_mutex_unlock(&mutex_queries);
+    int queries_pendientes = cola_ready_cantidad(cola_ready);
     
     if (queries_pendientes > 0 && workers_activos > 0) {
         log_warning(logger, "════════════════════════════════════════════════════════");
@@ -1499,8 +2492,8 @@ void manejar_desconexion_worker_inmediata(t_worker* worker) {
         log_warning(logger, "   - Workers disponibles: %d", workers_activos);
         log_warning(logger, "════════════════════════════════════════════════════════");
         
-        // Planificar inmediatamente
-        planificar_siguiente_query();
+        // Replanificar desde el hilo planificador
+        notificar_planificador(EVENTO_WORKER_DESCONECTADO, worker->worker_id);
     } else if (queries_pendientes > 0) {
         log_error(logger, " HAY %d QUERIES PENDIENTES PERO NO HAY WORKERS ACTIVOS", 
                   queries_pendientes);
@@ -1511,70 +2504,50 @@ void manejar_desconexion_worker_inmediata(t_worker* worker) {
     log_warning(logger, "════════════════════════════════════════════════════════");
 }
 
-void procesar_mensajes_worker(t_worker* worker) {
-    bool seguir_procesando = true;
+// Despacha un mensaje completo del Worker. 'vista' son los campos del paquete
+// sobre el buffer de recepción; no sobreviven al despacho.
+void procesar_mensaje_worker(t_worker* worker, op_code cod_op, const t_vista_paquete* vista) {
+    log_info(logger, "Recibido cod_op: %d del Worker %d", cod_op, worker->worker_id);
     
-    log_info(logger, "Iniciando procesamiento de mensajes del Worker %d", worker->worker_id);
-    
-    while (seguir_procesando && worker->conectado) {
-        op_code cod_op;
-        ssize_t bytes = recv(worker->socket_worker, &cod_op, sizeof(op_code), MSG_WAITALL);
-        
-        // DETECTAR DESCONEXIÓN INMEDIATAMENTE
-        if (bytes <= 0) {
-            if (bytes == 0) {
-                log_warning(logger, "Worker %d cerró la conexión limpiamente", worker->worker_id);
-            } else {
-                log_error(logger, "Worker %d: error en recv(): %s", worker->worker_id, strerror(errno));
-            }
+    switch (cod_op) {
+        case MENSAJE_LECTURA:
+            log_info(logger, "Procesando MENSAJE_LECTURA del Worker %d", worker->worker_id);
+            procesar_mensaje_lectura(worker, vista);
+            break;
             
-            // MANEJAR DESCONEXIÓN INMEDIATA
-            manejar_desconexion_worker_inmediata(worker);
+        case RESULTADO_READ_PARCIAL:
+            procesar_resultado_read(worker, vista);
+            break;
+            
+        case QUERY_FINALIZADA:
+            log_info(logger, "Procesando QUERY_FINALIZADA del Worker %d", worker->worker_id);
+            procesar_finalizacion_worker(worker, vista);
+            break;
+            
+        case ERROR_EJECUCION:
+            log_info(logger, "Procesando ERROR_EJECUCION del Worker %d", worker->worker_id);
+            procesar_error_worker(worker, vista);
             break;
-        }
 
-        if (cod_op == 0 || cod_op > 500) {
-            log_error(logger, "Código de operación inválido del Worker %d: %d", 
-                     worker->worker_id, cod_op);
-            continue;
-        }
-        
-        log_info(logger, "Recibido cod_op: %d del Worker %d", cod_op, worker->worker_id);
-        
-        switch (cod_op) {
-            case MENSAJE_LECTURA:
-                log_info(logger, "Procesando MENSAJE_LECTURA del Worker %d", worker->worker_id);
-                procesar_mensaje_lectura(worker);
-                break;
-                
-            case RESULTADO_READ:
-                log_info(logger, "Procesando RESULTADO_READ del Worker %d", worker->worker_id);
-                procesar_resultado_read(worker);
-                break;
-                
-            case QUERY_FINALIZADA:
-                log_info(logger, "Procesando QUERY_FINALIZADA del Worker %d", worker->worker_id);
-                procesar_finalizacion_worker(worker);
-                break;
-                
-            case ERROR_EJECUCION:
-                log_info(logger, "Procesando ERROR_EJECUCION del Worker %d", worker->worker_id);
-                procesar_error_worker(worker);
-                break;
+        case METRICAS_MEMORIA:
+            procesar_metricas_memoria(worker, vista);
+            break;
 
-            case END:
-                log_info(logger, "Procesando END del Worker %d", worker->worker_id);
-                procesar_end_worker(worker);
-                break;
-                
-            default:
-                log_warning(logger, "Código de operación no manejado del Worker %d: %d", 
-                           worker->worker_id, cod_op);
-                break;
-        }
+        case DESALOJAR_QUERY:
+            log_info(logger, "Procesando contexto de desalojo del Worker %d", worker->worker_id);
+            procesar_contexto_desalojo(worker, vista);
+            break;
+
+        case END:
+            log_info(logger, "Procesando END del Worker %d", worker->worker_id);
+            procesar_end_worker(worker);
+            break;
+            
+        default:
+            log_warning(logger, "Código de operación no manejado del Worker %d: %d", 
+                       worker->worker_id, cod_op);
+            break;
     }
-    
-    log_info(logger, "Finalizando procesamiento de mensajes del Worker %d", worker->worker_id);
 }
 
 void procesar_lectura_worker(t_log* logger, t_worker* worker, void* buffer) {
@@ -1586,11 +2559,10 @@ void procesar_lectura_worker(t_log* logger, t_worker* worker, void* buffer) {
     }
 }
 
-void procesar_finalizacion_worker(t_worker* worker) {
+void procesar_finalizacion_worker(t_worker* worker, const t_vista_paquete* vista) {
     log_info(logger, "Procesando finalización de query del Worker %d", worker->worker_id);
     
-    pthread_mutex_lock(&mutex_queries);
-    t_query* query = buscar_query_por_id(worker->query_actual);
+    t_query* query = buscar_query_por_id_unsafe(worker->query_actual);
     
     // Si el worker ya está libre, ignorar este mensaje
     if (!worker->ocupado) {
@@ -1601,7 +2573,7 @@ void procesar_finalizacion_worker(t_worker* worker) {
 
     if (query != NULL && !query->cancelada) {
         // Enviar confirmación al Worker
-        enviar_ok(worker->socket_worker);
+        enviar_codigo_a_conexion(worker->socket_worker, OP_OK);
         
         // Finalizar la query
         finalizar_query(query, "Query ejecutada correctamente");
@@ -1610,53 +2582,50 @@ void procesar_finalizacion_worker(t_worker* worker) {
     } else {
         log_warning(logger, "No se pudo finalizar query - no encontrada o cancelada");
         // Enviar error al Worker
-        int error = htonl(OP_ERROR);
-        send(worker->socket_worker, &error, sizeof(int), MSG_NOSIGNAL);
+        enviar_codigo_a_conexion(worker->socket_worker, OP_ERROR);
     }
     
-    pthread_mutex_unlock(&mutex_queries);
     
-    worker->ocupado = false;
-    worker->query_actual = -1;
+    worker_pasar_a_libre(worker);
     
     // Planificar siguiente query
-    planificar_siguiente_query();
+    notificar_planificador(EVENTO_WORKER_LIBRE, worker->worker_id);
 }
 
 void eliminar_worker(t_worker* worker) {
     if (worker != NULL) {
         worker->conectado = false;
         list_remove_element(lista_workers, worker);
-        close(worker->socket_worker);
+        if (workers_por_id != NULL) {
+            char clave[16];
+            clave_indice(worker->worker_id, clave, sizeof(clave));
+            if (dictionary_get(workers_por_id, clave) == worker) {
+                dictionary_remove(workers_por_id, clave);
+            }
+        }
+        if (worker->slot == 0) close(worker->socket_worker); // Los slots comparten el socket
+        destruir_lista_archivos(worker->archivos_recientes);
         free(worker);
     }
 }
 
-void procesar_error_worker(t_worker* worker) {
+void procesar_error_worker(t_worker* worker, const t_vista_paquete* vista) {
     log_info(logger, "Procesando error del Worker %d", worker->worker_id);
     
-    // Recibir el paquete completo usando la función correcta
-    t_list* elementos = recibir_paquete(logger, worker->socket_worker);
-    
-    if (elementos == NULL || list_size(elementos) == 0) {
+    if (vista == NULL || vista->cantidad == 0) {
         log_error(logger, "Error al recibir paquete de error del Worker %d", worker->worker_id);
-        if (elementos) list_destroy_and_destroy_elements(elementos, free);
         return;
     }
     
-    // Extraer mensaje de error
-    char* mensaje_error = NULL;
-    if (list_size(elementos) > 0) {
-        void* elem = list_get(elementos, 0);
-        mensaje_error = strdup((char*)elem);
-    } else {
-        mensaje_error = strdup("Error desconocido");
+    // [query_id][mensaje]; el mensaje apunta al buffer de recepción
+    const char* mensaje_error = vista->cantidad >= 2 ? campo_string(&vista->campos[1]) : NULL;
+    if (mensaje_error == NULL) {
+        mensaje_error = "Error desconocido";
     }
     
     log_error(logger, "Error del Worker %d: %s", worker->worker_id, mensaje_error);
     
-    pthread_mutex_lock(&mutex_queries);
-    t_query* query = buscar_query_por_id(worker->query_actual);
+    t_query* query = buscar_query_por_id_unsafe(worker->query_actual);
     
     if (query != NULL) {
         log_error(logger, "Error en ejecución de Query %d: %s", query->query_id, mensaje_error);
@@ -1666,29 +2635,23 @@ void procesar_error_worker(t_worker* worker) {
         
         // Enviar notificación al Query Control
         if (query->socket_query_control != -1) {
-            enviar_finalizacion_a_query_control(query->socket_query_control, mensaje_error);
+            enviar_finalizacion_a_query_control(query->socket_query_control, query->query_id, mensaje_error);
         }
         
         // Remover de listas activas
-        list_remove_element(lista_queries_ready, query);
+        cola_ready_quitar(cola_ready, query);
         
         logging_finalizacion_query(query->query_id, worker->worker_id);
     } else {
         log_error(logger, "No se encontró query para error del Worker %d", worker->worker_id);
     }
     
-    pthread_mutex_unlock(&mutex_queries);
     
     // Liberar worker
-    worker->ocupado = false;
-    worker->query_actual = -1;
-    
-    // Liberar memoria
-    free(mensaje_error);
-    list_destroy_and_destroy_elements(elementos, free);
+    worker_pasar_a_libre(worker);
     
     // Planificar siguiente query
-    planificar_siguiente_query();
+    notificar_planificador(EVENTO_WORKER_LIBRE, worker->worker_id);
 }
 
 
@@ -1728,7 +2691,7 @@ void enviar_query_a_ejecutar(t_worker* worker, t_query* query) {
     
     // Enviar paquete completo
     log_info(logger, "   - Enviando paquete de %d bytes...", paquete->buffer->size);
-    enviar_paquete(paquete, worker->socket_worker);
+    enviar_paquete_a_conexion(paquete, worker->socket_worker);
     
     log_info(logger, "Query %d enviada exitosamente al Worker %d - Total bytes: %d", 
              query->query_id, worker->worker_id, paquete->buffer->size);
@@ -1737,65 +2700,68 @@ void enviar_query_a_ejecutar(t_worker* worker, t_query* query) {
     eliminar_paquete(paquete);
 }
 
+// [query_id]: el Worker solo corta esa query, aunque el pedido llegue cuando ya terminó
 void solicitar_desalojo_worker(t_worker* worker) {
-    op_code cod_op = DESALOJAR_QUERY;
-    send(worker->socket_worker, &cod_op, sizeof(op_code), MSG_NOSIGNAL);
-}
-
-int recibir_contexto_desalojo(t_worker* worker) {
-    int pc;
-    ssize_t bytes = recv(worker->socket_worker, &pc, sizeof(int), MSG_WAITALL);
-    
-    if (bytes <= 0) {
-        log_error(logger, "Error al recibir contexto de desalojo del Worker %d", worker->worker_id);
-        return 0;
+    t_paquete* paquete = crear_paquete(DESALOJAR_QUERY, logger);
+    if (paquete == NULL) {
+        log_error(logger, "Error al crear paquete DESALOJAR_QUERY para Worker %d", worker->worker_id);
+        return;
     }
-    
-    return pc;
+    uint32_t query_id = worker->query_actual;
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
+    enviar_paquete_a_conexion(paquete, worker->socket_worker);
+    eliminar_paquete(paquete);
 }
 
-void enviar_finalizacion_a_query_control(int socket_qc, const char* motivo) {
+// [op][query_id][tam_motivo][motivo]: el query_id distingue las queries de un lote
+void enviar_finalizacion_a_query_control(int socket_qc, int query_id, const char* motivo) {
     op_code cod_op = QUERY_FINALIZADA;
-    send(socket_qc, &cod_op, sizeof(op_code), MSG_NOSIGNAL);
-    
     uint32_t tam_motivo = strlen(motivo);
-    send(socket_qc, &tam_motivo, sizeof(uint32_t), MSG_NOSIGNAL);
-    send(socket_qc, motivo, tam_motivo, MSG_NOSIGNAL);
+
+    struct iovec iov[] = {
+        { .iov_base = &cod_op, .iov_len = sizeof(op_code) },
+        { .iov_base = &query_id, .iov_len = sizeof(int) },
+        { .iov_base = &tam_motivo, .iov_len = sizeof(uint32_t) },
+        { .iov_base = (void*)motivo, .iov_len = tam_motivo },
+    };
+    enviar_a_conexion(socket_qc, iov, 4);
 }
 
 
 // LOGGING
 void logging_conexion_query_control(t_query* query) {
-    pthread_mutex_lock(&mutex_workers);
     int cantidad_workers = list_size(lista_workers);
-    pthread_mutex_unlock(&mutex_workers);
     
     log_info(logger, "## Se conecta un Query Control para ejecutar la Query %s con prioridad %d - Id asignado: %d. Nivel multiprocesamiento %d",
              query->path_query, query->prioridad, query->query_id, cantidad_workers);
 }
 
+// Workers conectados (un Worker con varias queries simultáneas cuenta una vez)
+static int cantidad_workers_conectados(void) {
+    int cantidad = 0;
+    for (int i = 0; i < list_size(lista_workers); i++) {
+        t_worker* w = list_get(lista_workers, i);
+        if (w->slot == 0) cantidad++;
+    }
+    return cantidad;
+}
+
 void logging_conexion_worker(t_worker* worker) {
-    pthread_mutex_lock(&mutex_workers);
-    int cantidad_workers = list_size(lista_workers);
-    pthread_mutex_unlock(&mutex_workers);
+    int cantidad_workers = cantidad_workers_conectados();
     
     log_info(logger, "## Se conecta el Worker %d - Cantidad total de Workers: %d",
              worker->worker_id, cantidad_workers);
 }
 
 void logging_desconexion_query_control(t_query* query) {
-    pthread_mutex_lock(&mutex_workers);
     int cantidad_workers = list_size(lista_workers);
-    pthread_mutex_unlock(&mutex_workers);
     
     log_info(logger, "## Se desconecta un Query Control. Se finaliza la Query %d con prioridad %d. Nivel multiprocesamiento %d",
              query->query_id, query->prioridad, cantidad_workers);
 }
 
 void logging_desconexion_worker(t_worker* worker, int query_id) {
-    pthread_mutex_lock(&mutex_workers);
-    int cantidad_workers = list_size(lista_workers);
-    pthread_mutex_unlock(&mutex_workers);
+    int cantidad_workers = cantidad_workers_conectados();
     
     if (query_id != -1) {
         log_info(logger, "## Se desconecta el Worker %d - Se finaliza la Query %d - Cantidad total de Workers: %d",
@@ -1856,6 +2822,14 @@ void logging_envio_lectura(int query_id, int worker_id) {
 }
 
 
+// UTILIDADES
+int64_t temporal_get_timestamp(void) {
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (int64_t)ahora.tv_sec * 1000 + ahora.tv_nsec / 1000000;
+}
+
+
 // MAIN FUNCTION
 int main(int argc, char* argv[]) {
     saludar("master");
@@ -1901,25 +2875,14 @@ int main(int argc, char* argv[]) {
     // Inicializar estructuras
     inicializar_estructuras_master();
     
-    // Iniciar hilo de aging si está configurado
-    if (config_global->tiempo_aging > 0 && 
-        strcmp(config_global->algoritmo_planificacion, "PRIORIDADES") == 0) {
-        pthread_create(&hilo_aging, NULL, proceso_aging, NULL);
-        log_info(logger, "Hilo de aging iniciado");
-    }
-    
-    // Iniciar servidor
+    // Iniciar servidor: el reactor atiende conexiones, planificación y aging
     iniciar_servidor_master();
     
     // Esperar finalización del sistema
     log_info(logger, "Sistema Master finalizando...");
     
     // Limpiar recursos
-    sistema_activo = false;
-    if (config_global->tiempo_aging > 0 && 
-        strcmp(config_global->algoritmo_planificacion, "PRIORIDADES") == 0) {
-        pthread_join(hilo_aging, NULL);
-    }
+    detener_planificador();
     
     destruir_estructuras_master();
     destruir_config_master(config_global);
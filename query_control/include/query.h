@@ -18,6 +18,12 @@ typedef struct {
     int socket_master;
 } t_query_info;
 
+// Query de un lote: archivo ya resuelto y su prioridad
+typedef struct {
+    char* archivo;
+    int prioridad;
+} t_solicitud_query;
+
 // Funciones principales
 void inicializar_query_control(int argc, char* argv[]);
 t_config_query* cargar_configuracion(char* path_config);
@@ -29,5 +35,6 @@ void liberar_recursos(t_query_info* query_info, t_config_query* config);
 void destruir_config_query(t_config_query* config);
 void* escuchar_respuestas_master(void* args);
 void enviar_nueva_query(char* archivo, int prioridad);
+bool enviar_lote_queries(t_list* solicitudes);
 
 #endif // QUERY_H_
\ No newline at end of file
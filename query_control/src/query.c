@@ -1,6 +1,8 @@
 #include "query.h"
 #include <cliente.h>
 #include <server.h>
+#include <trama.h>
+#include <glob.h>
 
 t_log* logger = NULL;
 t_config_query* config_global = NULL;
@@ -9,6 +11,23 @@ pthread_t hilo_escucha;
 bool sistema_activo = true;
 int contador_queries = 0;
 
+// Lotes enviados que todavía esperan QUERIES_ADMITIDAS (en orden de envío) y, una vez
+// admitidos, el archivo de cada query del lote para mostrar sus resultados
+static t_list* lotes_pendientes = NULL;
+static t_dictionary* archivos_por_query = NULL;
+static pthread_mutex_t mutex_lotes = PTHREAD_MUTEX_INITIALIZER;
+
+// Directorios donde se buscan los archivos de query, en orden
+static const char* prefijos_queries[] = {
+    "",                         // Ruta original (puede ser ruta completa)
+    "../utils/pruebas/",        // Desde bin/ hacia utils/pruebas/
+    "../../utils/pruebas/",     // Desde query_control/ hacia utils/pruebas/
+    "../../../utils/pruebas/",  // Desde tp-2025-2c-azotadores/
+    "utils/pruebas/",           // Ruta relativa desde raíz
+    "../",                      // Un nivel arriba desde bin/
+    NULL
+};
+
 void enviar_nueva_query(char* archivo, int prioridad) {
     log_info(logger, "## Solicitud de ejecución de Query: %s, prioridad: %d",
              archivo, prioridad);
@@ -63,6 +82,211 @@ void enviar_nueva_query(char* archivo, int prioridad) {
     printf("\n");
 }
 
+static void destruir_archivos_lote(t_list* archivos) {
+    list_destroy_and_destroy_elements(archivos, free);
+}
+
+// Todo el lote en un único mensaje: [MARCA_LOTE_QUERIES][size][cantidad]
+// [[tam_path][path][prioridad]]... El Master responde con QUERIES_ADMITIDAS.
+bool enviar_lote_queries(t_list* solicitudes) {
+    uint32_t cantidad = list_size(solicitudes);
+    log_info(logger, "## Solicitud de ejecución de lote: %u queries", cantidad);
+
+    if (query_info_global->socket_master <= 0) {
+        log_error(logger, "Socket inválido: no hay conexión con el Master");
+        return false;
+    }
+
+    t_trama* trama = trama_crear(cantidad * 64);
+    trama_agregar_uint32_red(trama, MARCA_LOTE_QUERIES);
+    uint32_t pos_size = trama_reservar(trama, sizeof(uint32_t));
+    trama_agregar_uint32_red(trama, cantidad);
+
+    t_list* archivos = list_create();
+    for (uint32_t i = 0; i < cantidad; i++) {
+        t_solicitud_query* solicitud = list_get(solicitudes, i);
+        trama_agregar_string_red(trama, solicitud->archivo);
+        trama_agregar_uint32_red(trama, solicitud->prioridad);
+        list_add(archivos, strdup(solicitud->archivo));
+    }
+
+    uint32_t size_network = htonl(trama_tamanio(trama) - 2 * sizeof(uint32_t));
+    trama_escribir(trama, pos_size, &size_network, sizeof(uint32_t));
+
+    // Se encola antes de enviar: la respuesta puede llegar antes de que vuelva el envío
+    pthread_mutex_lock(&mutex_lotes);
+    list_add(lotes_pendientes, archivos);
+    pthread_mutex_unlock(&mutex_lotes);
+
+    bool enviado = trama_enviar(trama, query_info_global->socket_master);
+    trama_destruir(trama);
+
+    if (!enviado) {
+        log_error(logger, "Error al enviar lote de queries: %s", strerror(errno));
+        pthread_mutex_lock(&mutex_lotes);
+        list_remove_element(lotes_pendientes, archivos);
+        pthread_mutex_unlock(&mutex_lotes);
+        destruir_archivos_lote(archivos);
+        return false;
+    }
+
+    contador_queries += cantidad;
+    log_info(logger, "## Lote de %u queries enviado al Master en un único mensaje", cantidad);
+    printf("Lote enviado: %u queries (total enviadas: %d)\n", cantidad, contador_queries);
+    return true;
+}
+
+// [cantidad][query_id]... en el orden en que se enviaron las queries del lote
+static bool recibir_queries_admitidas(int socket_master) {
+    uint32_t cantidad;
+    if (recv(socket_master, &cantidad, sizeof(uint32_t), MSG_WAITALL) != sizeof(uint32_t)) {
+        log_error(logger, "Error al recibir QUERIES_ADMITIDAS");
+        return false;
+    }
+
+    int* ids = malloc(cantidad * sizeof(int));
+    if (cantidad > 0 && recv(socket_master, ids, cantidad * sizeof(int), MSG_WAITALL) != (ssize_t)(cantidad * sizeof(int))) {
+        log_error(logger, "Error al recibir ids de QUERIES_ADMITIDAS");
+        free(ids);
+        return false;
+    }
+
+    pthread_mutex_lock(&mutex_lotes);
+    t_list* archivos = list_is_empty(lotes_pendientes) ? NULL : list_remove(lotes_pendientes, 0);
+    pthread_mutex_unlock(&mutex_lotes);
+
+    uint32_t admitidas = 0;
+    for (uint32_t i = 0; i < cantidad; i++) {
+        char* archivo = archivos != NULL && i < (uint32_t)list_size(archivos) ? list_get(archivos, i) : "?";
+        if (ids[i] < 0) {
+            printf(" Rechazada por el Master: %s\n", archivo);
+            log_warning(logger, "Query %s del lote rechazada por el Master", archivo);
+            continue;
+        }
+        char clave[16];
+        snprintf(clave, sizeof(clave), "%d", ids[i]);
+        dictionary_put(archivos_por_query, clave, strdup(archivo));
+        admitidas++;
+    }
+
+    printf("\n");
+    printf("════════════════════════════════════════════════\n");
+    printf("              LOTE ADMITIDO                     \n");
+    printf("════════════════════════════════════════════════\n");
+    printf(" Queries admitidas: %u/%-24u \n", admitidas, cantidad);
+    printf("════════════════════════════════════════════════\n");
+    printf("\nquery> ");
+    fflush(stdout);
+
+    log_info(logger, "## Lote admitido por el Master: %u/%u queries", admitidas, cantidad);
+
+    if (archivos != NULL) destruir_archivos_lote(archivos);
+    free(ids);
+    return true;
+}
+
+// Estado del READ que se está mostrando para cada query: los tramos de una query llegan
+// en orden y se imprimen apenas llegan, con los \0 del archivo como separadores de línea.
+// Con lotes puede haber varios READ de queries distintas intercalados.
+typedef struct {
+    uint32_t bytes;
+    bool hay_texto;
+    bool salto_pendiente;
+} t_estado_lectura;
+
+static t_dictionary* lecturas_en_curso = NULL;   // query_id -> t_estado_lectura (solo el hilo de escucha)
+
+static void mostrar_datos_lectura(t_estado_lectura* lectura, const char* datos, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        if (datos[i] == '\0') {
+            lectura->salto_pendiente = lectura->hay_texto;
+            continue;
+        }
+        if (lectura->salto_pendiente) {
+            putchar('\n');
+            lectura->salto_pendiente = false;
+        }
+        putchar(datos[i]);
+        lectura->hay_texto = true;
+    }
+}
+
+// [query_id][tam_file_tag][file_tag][offset][ultimo][size][datos]. Los datos se leen y
+// muestran de a partes, sin juntar el resultado completo. Devuelve false si se cortó la conexión.
+static bool recibir_tramo_lectura(int socket_master) {
+    uint32_t query_id;
+    uint32_t tam_file_tag;
+    if (recv(socket_master, &query_id, sizeof(uint32_t), MSG_WAITALL) != sizeof(uint32_t) ||
+        recv(socket_master, &tam_file_tag, sizeof(uint32_t), MSG_WAITALL) != sizeof(uint32_t) ||
+        tam_file_tag == 0 || tam_file_tag > PATH_MAX) {
+        log_error(logger, "Error al recibir tramo de READ");
+        return false;
+    }
+
+    char file_tag[PATH_MAX];
+    uint32_t encabezado[3];   // offset, ultimo, size
+    if (recv(socket_master, file_tag, tam_file_tag, MSG_WAITALL) != (ssize_t)tam_file_tag ||
+        recv(socket_master, encabezado, sizeof(encabezado), MSG_WAITALL) != sizeof(encabezado)) {
+        log_error(logger, "Error al recibir tramo de READ");
+        return false;
+    }
+    file_tag[tam_file_tag - 1] = '\0';
+    uint32_t offset = encabezado[0];
+    bool ultimo = encabezado[1] != 0;
+    uint32_t size = encabezado[2];
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+    t_estado_lectura* lectura = dictionary_get(lecturas_en_curso, clave);
+    if (lectura == NULL) {
+        lectura = malloc(sizeof(t_estado_lectura));
+        dictionary_put(lecturas_en_curso, clave, lectura);
+    }
+
+    if (offset == 0) {
+        lectura->bytes = 0;
+        lectura->hay_texto = false;
+        lectura->salto_pendiente = false;
+
+        printf("\n");
+        printf("════════════════════════════════════════════════\n");
+        printf("           RESULTADO READ RECIBIDO              \n");
+        printf("════════════════════════════════════════════════\n");
+        printf(" Query:   %-37u \n", query_id);
+        printf(" Archivo: %-37s \n", file_tag);
+        printf("════════════════════════════════════════════════\n");
+        printf(" Datos:\n");
+    }
+
+    char datos[4096];
+    uint32_t restantes = size;
+    while (restantes > 0) {
+        uint32_t a_leer = restantes < sizeof(datos) ? restantes : sizeof(datos);
+        if (recv(socket_master, datos, a_leer, MSG_WAITALL) != (ssize_t)a_leer) {
+            log_error(logger, "Error al recibir datos de READ");
+            return false;
+        }
+        mostrar_datos_lectura(lectura, datos, a_leer);
+        restantes -= a_leer;
+    }
+    lectura->bytes += size;
+    fflush(stdout);
+
+    if (ultimo) {
+        if (!lectura->hay_texto) printf("(Sin datos visibles)");
+        printf("\n");
+        printf("════════════════════════════════════════════════\n");
+        printf(" Tamaño: %-38u \n", lectura->bytes);
+        printf("════════════════════════════════════════════════\n");
+        printf("\nquery> ");
+        fflush(stdout);
+
+        log_info(logger, "## Resultado READ recibido - Query %u: %s (%u bytes)", query_id, file_tag, lectura->bytes);
+        dictionary_remove_and_destroy(lecturas_en_curso, clave, free);
+    }
+    return true;
+}
+
 void* escuchar_respuestas_master(void* args) {
     t_query_info* query_info = (t_query_info*)args;
     
@@ -89,40 +313,25 @@ void* escuchar_respuestas_master(void* args) {
         log_debug(logger, "Código de operación recibido: %d", cod_op);
         
         switch (cod_op) {
-            case RESULTADO_READ: {
-                // Recibir tamaño del mensaje
-                int32_t size;
-                recv(query_info->socket_master, &size, sizeof(int32_t), MSG_WAITALL);
-                
-                if (size > 0) {
-                    // Recibir datos leídos
-                    char* datos = malloc(size + 1);
-                    recv(query_info->socket_master, datos, size, MSG_WAITALL);
-                    datos[size] = '\0';
-                    
-                    printf("\n");
-                    printf("════════════════════════════════════════════════\n");
-                    printf("           RESULTADO READ RECIBIDO              \n");
-                    printf("════════════════════════════════════════════════\n");
-                    printf(" Tamaño: %-38zu \n", strlen(datos));
-                    printf("════════════════════════════════════════════════\n");
-                    printf(" Datos:                                         \n");
-                    printf(" '%s'%-*s\n", datos, (int)(46 - strlen(datos)), "");
-                    printf("════════════════════════════════════════════════\n");
-                    printf("\nquery> ");
-                    fflush(stdout);
-                    
-                    log_info(logger, "## Resultado READ recibido: '%s' (%zu bytes)", 
-                            datos, strlen(datos));
-                    
-                    free(datos);
+            case RESULTADO_READ_PARCIAL: {
+                if (!recibir_tramo_lectura(query_info->socket_master)) {
+                    sistema_activo = false;
+                }
+                break;
+            }
+            
+            case QUERIES_ADMITIDAS: {
+                if (!recibir_queries_admitidas(query_info->socket_master)) {
+                    sistema_activo = false;
                 }
                 break;
             }
             
             case QUERY_FINALIZADA: {
-                // Recibir tamaño del mensaje
+                // Recibir query_id y tamaño del mensaje
+                int query_id;
                 uint32_t size;
+                recv(query_info->socket_master, &query_id, sizeof(int), MSG_WAITALL);
                 recv(query_info->socket_master, &size, sizeof(uint32_t), MSG_WAITALL);
                 
                 // Recibir motivo de finalización
@@ -130,16 +339,30 @@ void* escuchar_respuestas_master(void* args) {
                 recv(query_info->socket_master, motivo, size, MSG_WAITALL);
                 motivo[size] = '\0';
                 
-                printf("\n");
-                printf("════════════════════════════════════════════════\n");
-                printf("            QUERY FINALIZADA                    \n");
-                printf("════════════════════════════════════════════════\n");
-                printf(" Estado: %-38s \n", motivo);
-                printf("════════════════════════════════════════════════\n");
-                printf("\nquery> ");
-                fflush(stdout);
+                // Las queries de un lote se informan en una línea, con su archivo
+                char clave[16];
+                snprintf(clave, sizeof(clave), "%d", query_id);
+                char* archivo = dictionary_remove(archivos_por_query, clave);
                 
-                log_info(logger, "## Query Finalizada - %s", motivo);
+                if (archivo != NULL) {
+                    printf("\n Query %d (%s) finalizada: %s - quedan %d del lote\n",
+                           query_id, archivo, motivo, dictionary_size(archivos_por_query));
+                    printf("query> ");
+                    fflush(stdout);
+                    free(archivo);
+                } else {
+                    printf("\n");
+                    printf("════════════════════════════════════════════════\n");
+                    printf("            QUERY FINALIZADA                    \n");
+                    printf("════════════════════════════════════════════════\n");
+                    printf(" Query:  %-38d \n", query_id);
+                    printf(" Estado: %-38s \n", motivo);
+                    printf("════════════════════════════════════════════════\n");
+                    printf("\nquery> ");
+                    fflush(stdout);
+                }
+                
+                log_info(logger, "## Query %d Finalizada - %s", query_id, motivo);
                 
                 free(motivo);
                 break;
@@ -205,6 +428,20 @@ void* escuchar_respuestas_master(void* args) {
     return NULL;
 }
 
+// Busca el archivo en las ubicaciones conocidas. Devuelve la ruta encontrada (a liberar) o NULL.
+static char* resolver_ruta_query(const char* archivo) {
+    for (int i = 0; prefijos_queries[i] != NULL; i++) {
+        char* ruta = string_from_format("%s%s", prefijos_queries[i], archivo);
+        FILE* archivo_encontrado = fopen(ruta, "r");
+        if (archivo_encontrado != NULL) {
+            fclose(archivo_encontrado);
+            return ruta;
+        }
+        free(ruta);
+    }
+    return NULL;
+}
+
 void procesar_comando_query(char* comando) {
     // Dividir el comando en archivo y prioridad
     char* token = strtok(comando, " ");
@@ -228,49 +465,110 @@ void procesar_comando_query(char* comando) {
         return;
     }
     
-    // Construir rutas dinámicamente usando el nombre del archivo proporcionado
-    char ruta_1[512], ruta_2[512], ruta_3[512], ruta_4[512], ruta_5[512];
-    
-    snprintf(ruta_1, sizeof(ruta_1), "../utils/pruebas/%s", archivo);
-    snprintf(ruta_2, sizeof(ruta_2), "../../utils/pruebas/%s", archivo);
-    snprintf(ruta_3, sizeof(ruta_3), "../../../utils/pruebas/%s", archivo);
-    snprintf(ruta_4, sizeof(ruta_4), "utils/pruebas/%s", archivo);
-    snprintf(ruta_5, sizeof(ruta_5), "../%s", archivo);
-    
-    char* ubicaciones[] = {
-        archivo,                // Ruta original (puede ser ruta completa)
-        ruta_1,                 // Desde bin/ hacia utils/pruebas/
-        ruta_2,                 // Desde query_control/ hacia utils/pruebas/
-        ruta_3,                 // Desde tp-2025-2c-azotadores/
-        ruta_4,                 // Ruta relativa desde raíz
-        ruta_5,                 // Un nivel arriba desde bin/
-        NULL
-    };
-    
-    FILE* archivo_encontrado = NULL;
-    char* ruta_final = NULL;
-    
-    for (int i = 0; ubicaciones[i] != NULL; i++) {
-        archivo_encontrado = fopen(ubicaciones[i], "r");
-        if (archivo_encontrado != NULL) {
-            ruta_final = ubicaciones[i];
-            printf("Archivo encontrado en: %s\n", ruta_final);
-            fclose(archivo_encontrado);
-            break;
-        }
-    }
-    
+    char* ruta_final = resolver_ruta_query(archivo);
     if (ruta_final == NULL) {
         printf("Error: No se puede abrir el archivo '%s'\n", archivo);
         printf("Se buscó en las siguientes ubicaciones:\n");
-        for (int i = 0; ubicaciones[i] != NULL; i++) {
-            printf("  - %s\n", ubicaciones[i]);
+        for (int i = 0; prefijos_queries[i] != NULL; i++) {
+            printf("  - %s%s\n", prefijos_queries[i], archivo);
         }
         return;
     }
+    printf("Archivo encontrado en: %s\n", ruta_final);
     
     // Enviar la query con la ruta encontrada
     enviar_nueva_query(ruta_final, prioridad);
+    free(ruta_final);
+}
+
+static void agregar_solicitud(t_list* solicitudes, char* archivo, int prioridad) {
+    t_solicitud_query* solicitud = malloc(sizeof(t_solicitud_query));
+    solicitud->archivo = archivo;
+    solicitud->prioridad = prioridad;
+    list_add(solicitudes, solicitud);
+}
+
+static void destruir_solicitud(t_solicitud_query* solicitud) {
+    free(solicitud->archivo);
+    free(solicitud);
+}
+
+// Patrón glob: se prueba en cada ubicación y se usa la primera que tenga coincidencias
+static void agregar_por_patron(t_list* solicitudes, const char* patron, int prioridad) {
+    for (int i = 0; prefijos_queries[i] != NULL; i++) {
+        char ruta[PATH_MAX];
+        snprintf(ruta, sizeof(ruta), "%s%s", prefijos_queries[i], patron);
+
+        glob_t coincidencias;
+        if (glob(ruta, 0, NULL, &coincidencias) != 0) continue;
+
+        for (size_t j = 0; j < coincidencias.gl_pathc; j++) {
+            agregar_solicitud(solicitudes, strdup(coincidencias.gl_pathv[j]), prioridad);
+        }
+        globfree(&coincidencias);
+        return;
+    }
+}
+
+// Archivo de lista: una query por línea, "<archivo> [prioridad]"; sin prioridad se usa
+// la del comando. Se ignoran las líneas vacías y las que empiezan con #.
+static bool agregar_por_lista(t_list* solicitudes, const char* lista, int prioridad) {
+    char* ruta_lista = resolver_ruta_query(lista);
+    FILE* archivo_lista = ruta_lista != NULL ? fopen(ruta_lista, "r") : NULL;
+    free(ruta_lista);
+    if (archivo_lista == NULL) return false;
+
+    char* linea = NULL;
+    size_t len = 0;
+    while (getline(&linea, &len, archivo_lista) != -1) {
+        linea[strcspn(linea, "\r\n")] = '\0';
+        char* archivo = strtok(linea, " \t");
+        if (archivo == NULL || archivo[0] == '#') continue;
+
+        char* token = strtok(NULL, " \t");
+        int prioridad_query = token != NULL ? atoi(token) : prioridad;
+
+        char* ruta = resolver_ruta_query(archivo);
+        if (ruta == NULL) {
+            printf("Aviso: No se puede abrir el archivo '%s', se omite del lote\n", archivo);
+            continue;
+        }
+        agregar_solicitud(solicitudes, ruta, prioridad_query);
+    }
+
+    free(linea);
+    fclose(archivo_lista);
+    return true;
+}
+
+void procesar_comando_lote(char* comando) {
+    // Formato: LOTE <lista|patron> <prioridad>
+    char* origen = strtok(comando, " ");
+    char* token = strtok(NULL, " ");
+    if (origen == NULL || token == NULL) {
+        printf("Error: Formato incorrecto. Use: LOTE <lista|patron> <prioridad>\n");
+        return;
+    }
+    
+    int prioridad = atoi(token);
+    if (prioridad < 0) {
+        printf("Error: La prioridad debe ser un número positivo\n");
+        return;
+    }
+
+    t_list* solicitudes = list_create();
+    if (strpbrk(origen, "*?[") != NULL) {
+        agregar_por_patron(solicitudes, origen, prioridad);
+    } else if (!agregar_por_lista(solicitudes, origen, prioridad)) {
+        printf("Error: No se puede abrir la lista '%s'\n", origen);
+    }
+
+    if (list_is_empty(solicitudes)) {
+        printf("Error: El lote '%s' no tiene queries para enviar\n", origen);
+    } else {
+        enviar_lote_queries(solicitudes);
+    }
+    list_destroy_and_destroy_elements(solicitudes, (void*)destruir_solicitud);
 }
 
 void mostrar_ayuda(void) {
@@ -282,6 +580,10 @@ void mostrar_ayuda(void) {
     printf("   Envía una nueva query al Master              \n");
     printf("   Ejemplo: QUERY query_ejemplo.txt 2           \n");
     printf("                                                \n");
+    printf(" LOTE <lista|patron> <prioridad>                \n");
+    printf("   Envía varias queries en un único mensaje     \n");
+    printf("   Ejemplo: LOTE AGING_* 2                      \n");
+    printf("                                                \n");
     printf(" stats                                          \n");
     printf("   Muestra estadísticas de queries enviadas     \n");
     printf("                                                \n");
@@ -300,6 +602,7 @@ int main(int argc, char* argv[]) {
     // Validar argumentos mínimos
     if (argc < 2) {
         fprintf(stderr, "Uso: %s [archivo_config] [archivo_query] [prioridad]\n", argv[0]);
+        fprintf(stderr, "Uso lote: %s [archivo_config] LOTE [lista|patron] [prioridad]\n", argv[0]);
         fprintf(stderr, "Uso interactivo: %s [archivo_config]\n", argv[0]);
         fprintf(stderr, "Ejemplo: ./bin/query query.config query_ejemplo 5\n");
         fprintf(stderr, "Ejemplo interactivo: ./bin/query ../query.config\n");
@@ -346,11 +649,19 @@ int main(int argc, char* argv[]) {
 
     log_info(logger, "Conexión con Master establecida correctamente");
     
+    lotes_pendientes = list_create();
+    archivos_por_query = dictionary_create();
+    lecturas_en_curso = dictionary_create();
+    
     // Iniciar hilo para escuchar respuestas del Master
     pthread_create(&hilo_escucha, NULL, escuchar_respuestas_master, query_info_global);
     
     // Si se proporcionaron query y prioridad como argumentos, enviar query inicial
-    if (argc >= 4) {
+    if (argc >= 5 && strcmp(argv[2], "LOTE") == 0) {
+        char* comando_lote = string_from_format("%s %s", argv[3], argv[4]);
+        procesar_comando_lote(comando_lote);
+        free(comando_lote);
+    } else if (argc >= 4) {
         char* archivo_inicial = argv[2];
         int prioridad_inicial = atoi(argv[3]);
         
@@ -393,6 +704,10 @@ int main(int argc, char* argv[]) {
             // Formato: QUERY archivo prioridad
             procesar_comando_query(comando + 6); // Saltar "QUERY "
         }
+        else if (strncmp(comando, "LOTE ", 5) == 0) {
+            // Formato: LOTE lista|patron prioridad
+            procesar_comando_lote(comando + 5);
+        }
         else if (strcmp(comando, "help") == 0) {
             mostrar_ayuda();
         }else if (strcmp(comando, "stats") == 0) {
@@ -420,6 +735,9 @@ int main(int argc, char* argv[]) {
     
     // Liberar recursos
     liberar_recursos(query_info_global, config_global);
+    list_destroy_and_destroy_elements(lotes_pendientes, (void*)destruir_archivos_lote);
+    dictionary_destroy_and_destroy_elements(archivos_por_query, free);
+    dictionary_destroy_and_destroy_elements(lecturas_en_curso, free);
     
     log_info(logger, "=== Query Control finalizado ===");
     log_destroy(logger);
@@ -3,7 +3,10 @@
 
 #include <server.h>
 #include <conexion.h>
+#include <trama.h>
+#include <pool_buffers.h>
 #include "bitmap.h"
+#include <sys/epoll.h>
 
 typedef enum {
     WORK_IN_PROGRESS,
@@ -13,21 +16,53 @@ typedef enum {
 // Estructura para worker en storage
 typedef struct {
     int worker_id;
-    uint32_t query_id;
     char* worker_id_str; // ID como string (opcional)
     int socket_worker;
     bool conectado;
+    pthread_mutex_t mutex_envio;     // Las respuestas pueden salir desde varios hilos del pool
+    pthread_mutex_t mutex_lecturas;
+    pthread_cond_t sin_lecturas;
+    int lecturas_en_curso;           // OP_READ de esta conexión ejecutándose en paralelo
+    t_lector_tramas* lector;         // Buffer de recepción de los pedidos
 } t_worker_storage;
 
+// Pedido del Worker en curso: a quién y con qué id se responde
+typedef struct {
+    t_worker_storage* worker;
+    int op;
+    uint32_t id_pedido;
+    uint32_t query_id;
+    uint32_t pc;             // Instrucción de la query que originó el pedido
+    uint32_t tam_payload;    // Bytes del cuerpo que siguen al encabezado
+} t_pedido_storage;
+
+// Un rango de un WRITE vectorial: los datos son del buffer de recepción
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+    const void* datos;
+} t_rango_escritura;
+
+// Máximo de escrituras en un OP_WRITE_VECTORIAL
+#define STORAGE_MAX_ESCRITURAS_VECTOR 64
+
+// Conexión registrada en el epoll del servidor (worker es NULL hasta el handshake)
+typedef struct {
+    int socket;
+    t_worker_storage* worker;
+    t_lector_tramas* lector;  // Lo llena el hilo de epoll hasta tener un pedido completo
+    bool cerrada;             // El hilo de epoll vio el cierre: el pool solo la libera
+} t_conexion_storage;
+
 extern t_log* logger;
 
 // Operaciones del Storage
 storage_t* inicializar_storage(const char* config_path);
 void storage_destroy(storage_t* storage);
 void iniciar_servidor_storage();
-void* atender_worker_storage(void* args);
+bool atender_pedido_worker_storage(t_conexion_storage* conexion);
 
-char* recibir_string_del_worker(int socket);
+char* recibir_string_del_worker(t_lector_tramas* lector);
 
 int allocate_physical_block(storage_t* storage, uint32_t query_id);
 char* get_physical_block_path(storage_t* storage, int block_num);
@@ -38,15 +73,26 @@ int create_file_structure(storage_t* storage, const char* filename, const char*
 int storage_create_file(storage_t* storage, const char* filename, const char* tag);
 
 int storage_commit_tag(storage_t* storage, const char* filename, const char* tag, uint32_t query_id);
-
-void manejar_create_file(int socket_cliente, uint32_t query_id);
-void manejar_write_file(int socket_cliente, uint32_t query_id);
-void manejar_read_page(int socket_cliente, uint32_t query_id);
-void manejar_truncate_file(int socket_cliente, uint32_t query_id);
-void manejar_delete_file(int socket_cliente, uint32_t query_id);
-void manejar_tag_file(int socket_cliente, uint32_t query_id);
-void manejar_commit_file(int socket_cliente, uint32_t query_id);
-void manejar_flush_file(int socket_cliente, uint32_t query_id);
+int storage_write_file(storage_t* storage, const char* filename, const char* tag,
+                       uint32_t offset, const void* data, uint32_t size, uint32_t query_id);
+int storage_write_file_vectorial(storage_t* storage, const char* filename, const char* tag,
+                                 const t_rango_escritura* rangos, uint32_t cantidad,
+                                 bool* resultados, uint32_t query_id);
+
+void responder_pedido(t_pedido_storage* pedido, int estado, const void* payload, uint32_t tam_payload);
+void responder_ok(t_pedido_storage* pedido);
+void responder_error(t_pedido_storage* pedido);
+
+void manejar_create_file(t_pedido_storage* pedido);
+void manejar_write_file(t_pedido_storage* pedido);
+void manejar_write_vectorial(t_pedido_storage* pedido);
+char* recibir_pedido_lectura(t_lector_tramas* lector, uint32_t* pagina);
+void manejar_read_page(t_pedido_storage* pedido, char* file_tag, uint32_t pagina);
+void manejar_truncate_file(t_pedido_storage* pedido);
+void manejar_delete_file(t_pedido_storage* pedido);
+void manejar_tag_file(t_pedido_storage* pedido);
+void manejar_commit_file(t_pedido_storage* pedido);
+void manejar_flush_file(t_pedido_storage* pedido);
 
 
 // Funciones auxiliares
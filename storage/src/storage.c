@@ -308,339 +308,581 @@ storage_t* inicializar_storage(const char* config_path) {
     return storage;
 }
 
-void iniciar_servidor_storage() {
-    // Obtener puerto de escucha desde configuración
-    int puerto_escucha = config_get_int_value(global_storage->storage_config, "PUERTO_ESCUCHA");
+// SERVIDOR
+// Un hilo con epoll recibe sin bloquear en el lector de cada conexión y la encola
+// para un pool fijo de hilos recién cuando tiene un pedido completo (encabezado más
+// tam_payload, o el handshake entero): un Worker lento o que manda medio pedido no
+// retiene ningún hilo del pool. Cada socket se registra con EPOLLONESHOT y se
+// rearma recién cuando su pedido terminó: nunca hay dos hilos atendiendo la
+// misma conexión, así que los pedidos de un Worker se procesan en orden.
+#define STORAGE_MAX_EVENTOS 64
+
+static int fd_epoll_storage = -1;
+static uint32_t storage_block_size = 0;
+
+static t_queue* cola_conexiones_listas = NULL;
+static pthread_mutex_t mutex_conexiones_listas;
+static sem_t sem_conexiones_listas;
+
+#define CAPACIDAD_LECTOR_WORKER 16384   // Buffer de recepción por Worker (crece si un pedido no entra)
+#define STORAGE_TAM_MAX_PEDIDO (10 * 1024 * 1024)  // Más que esto es un pedido corrupto
+
+static bool armar_conexion_storage(t_conexion_storage* conexion, int operacion) {
+    struct epoll_event evento = { .events = EPOLLIN | EPOLLONESHOT, .data.ptr = conexion };
+    if (epoll_ctl(fd_epoll_storage, operacion, conexion->socket, &evento) < 0) {
+        log_error(logger, "Error al registrar socket %d en epoll: %s", conexion->socket, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void encolar_conexion_lista(t_conexion_storage* conexion) {
+    pthread_mutex_lock(&mutex_conexiones_listas);
+    queue_push(cola_conexiones_listas, conexion);
+    pthread_mutex_unlock(&mutex_conexiones_listas);
+    sem_post(&sem_conexiones_listas);
+}
+
+// Indica en 'necesarios' cuántos bytes ocupa el próximo pedido, hasta donde se sabe con
+// lo recibido, y si ya están todos. Handshake: [cod_op] y, con GET_BLOCK_SIZE,
+// [tam_id][id]. Después: t_encabezado_pedido_storage seguido de tam_payload bytes.
+static bool pedido_completo(t_conexion_storage* conexion, uint32_t* necesarios) {
+    const char* recibido;
+
+    if (conexion->worker == NULL) {
+        *necesarios = sizeof(int);
+        recibido = lector_ver_recibido(conexion->lector, sizeof(int));
+        int cod_op_network;
+        if (recibido) memcpy(&cod_op_network, recibido, sizeof(int));
+        if (recibido && ntohl(cod_op_network) == GET_BLOCK_SIZE) {
+            *necesarios += sizeof(uint32_t);
+            recibido = lector_ver_recibido(conexion->lector, *necesarios);
+            if (recibido) {
+                uint32_t tam_id;
+                memcpy(&tam_id, recibido + sizeof(int), sizeof(uint32_t));
+                tam_id = ntohl(tam_id);
+                if (tam_id > 0 && tam_id < 1024) *necesarios += tam_id;
+            }
+        }
+    } else {
+        *necesarios = sizeof(t_encabezado_pedido_storage);
+        recibido = lector_ver_recibido(conexion->lector, *necesarios);
+        if (recibido) {
+            t_encabezado_pedido_storage encabezado;
+            memcpy(&encabezado, recibido, sizeof(encabezado));
+            uint32_t tam_payload = ntohl(encabezado.tam_payload);
+            *necesarios = tam_payload > STORAGE_TAM_MAX_PEDIDO ? UINT32_MAX : *necesarios + tam_payload;
+        }
+    }
+    return lector_ver_recibido(conexion->lector, *necesarios) != NULL;
+}
+
+// Hilo de epoll: recibe lo disponible y encola la conexión si ya tiene un pedido
+// completo (o se cerró); si no, la rearma para esperar el resto.
+static void recibir_de_conexion_storage(t_conexion_storage* conexion) {
+    uint32_t necesarios;
+    uint32_t anteriores;
+    pedido_completo(conexion, &necesarios);
+
+    do {
+        if (necesarios == UINT32_MAX) {
+            log_error(logger, "Pedido de más de %d bytes en el socket %d - se cierra la conexión",
+                      STORAGE_TAM_MAX_PEDIDO, conexion->socket);
+            conexion->cerrada = true;
+            encolar_conexion_lista(conexion);
+            return;
+        }
+        if (lector_recibir_disponible(conexion->lector, necesarios) <= 0) {
+            conexion->cerrada = true;
+            encolar_conexion_lista(conexion);
+            return;
+        }
+        anteriores = necesarios;
+        if (pedido_completo(conexion, &necesarios)) {
+            encolar_conexion_lista(conexion);
+            return;
+        }
+        // Si se completó el encabezado hace falta más lugar: puede haber más en el socket
+    } while (necesarios > anteriores);
+
+    if (!armar_conexion_storage(conexion, EPOLL_CTL_MOD)) {
+        conexion->cerrada = true;
+        encolar_conexion_lista(conexion);
+    }
+}
+
+// Vuelve a esperar pedidos de la conexión. Si el lector ya tiene el pedido
+// siguiente completo el socket puede no volver a avisar: se encola directamente.
+static bool rearmar_conexion_storage(t_conexion_storage* conexion) {
+    uint32_t necesarios;
+    if (pedido_completo(conexion, &necesarios)) {
+        encolar_conexion_lista(conexion);
+        return true;
+    }
+    return armar_conexion_storage(conexion, EPOLL_CTL_MOD);
+}
+
+static void esperar_lecturas_en_curso(t_worker_storage* worker) {
+    pthread_mutex_lock(&worker->mutex_lecturas);
+    while (worker->lecturas_en_curso > 0) {
+        pthread_cond_wait(&worker->sin_lecturas, &worker->mutex_lecturas);
+    }
+    pthread_mutex_unlock(&worker->mutex_lecturas);
+}
+
+static void cerrar_conexion_storage(t_conexion_storage* conexion) {
+    epoll_ctl(fd_epoll_storage, EPOLL_CTL_DEL, conexion->socket, NULL);
+
+    t_worker_storage* worker = conexion->worker;
+    if (worker != NULL) {
+        // Puede quedar alguna lectura respondiendo en otro hilo del pool
+        esperar_lecturas_en_curso(worker);
+
+        // Worker desconectado
+        pthread_mutex_lock(&mutex_workers_storage);
+        worker->conectado = false;
+        list_remove_element(lista_workers_storage, worker);
+        int cantidad_workers = list_size(lista_workers_storage);
+        pthread_mutex_unlock(&mutex_workers_storage);
+
+        logging_desconexion_worker_storage(worker->worker_id, cantidad_workers);
+        pthread_mutex_destroy(&worker->mutex_envio);
+        pthread_mutex_destroy(&worker->mutex_lecturas);
+        pthread_cond_destroy(&worker->sin_lecturas);
+        free(worker);
+    }
+
+    lector_destruir(conexion->lector);
+    close(conexion->socket);
+    free(conexion);
+}
+
+// Primer mensaje de una conexión nueva: identifica al Worker y lo da de alta.
+// El hilo de epoll ya lo recibió entero (ver pedido_completo).
+static bool atender_handshake_storage(t_conexion_storage* conexion) {
+    int socket_cliente = conexion->socket;
+
+    // Recibir handshake para identificar tipo de módulo
+    int cod_op_network;
+    if (!lector_leer(conexion->lector, &cod_op_network, sizeof(int))) {
+        log_warning(logger, "Cliente se desconectó antes del handshake");
+        return false;
+    }
     
-    int socket_servidor = iniciar_servidor(logger, puerto_escucha);
+    // Convertir de network byte order
+    int cod_op = ntohl(cod_op_network);
+    log_info(logger, "Handshake recibido - Código OP: %d (network: %d)", cod_op, cod_op_network);
+
+    // Solo aceptar Workers (con GET_BLOCK_SIZE o WORKER)
+    if (cod_op != WORKER && cod_op != GET_BLOCK_SIZE) {
+        log_warning(logger, "Tipo de módulo no reconocido (%d) - Cerrando conexión", cod_op);
+        return false;
+    }
+
+    // Obtener información del cliente
+    struct sockaddr_in cliente_addr;
+    socklen_t addr_len = sizeof(cliente_addr);
+    char cliente_ip[INET_ADDRSTRLEN];
     
-    if (socket_servidor == -1) {
-        log_error(logger, "Error al iniciar el servidor Storage");
-        return;
+    if (getpeername(socket_cliente, (struct sockaddr*)&cliente_addr, &addr_len) == 0) {
+        inet_ntop(AF_INET, &cliente_addr.sin_addr, cliente_ip, INET_ADDRSTRLEN);
+    } else {
+        strcpy(cliente_ip, "IP desconocida");
     }
     
-    log_info(logger, "Servidor Storage iniciado en puerto %d", puerto_escucha);
-    log_info(logger, "Esperando conexiones de Workers...");
+    log_info(logger, "## Se conecta un Worker desde %s - Socket: %d", cliente_ip, socket_cliente);
     
-    while (1) {
-        int socket_cliente = esperar_cliente(logger, socket_servidor);
-        
-        if (socket_cliente == -1) {
-            log_error(logger, "Error al aceptar cliente");
-            continue;
-        }
-        
-        // Recibir handshake para identificar tipo de módulo
-        int cod_op_network;
-        ssize_t bytes = recv(socket_cliente, &cod_op_network, sizeof(int), MSG_WAITALL);
-        
-        if (bytes <= 0) {
-            log_warning(logger, "Cliente se desconectó antes del handshake");
-            close(socket_cliente);
-            continue;
-        }
-        
-        // Convertir de network byte order
-        int cod_op = ntohl(cod_op_network);
-        log_info(logger, "Handshake recibido - Código OP: %d (network: %d)", cod_op, cod_op_network);
-
-        // Solo aceptar Workers (con GET_BLOCK_SIZE o WORKER)
-        if (cod_op == WORKER || cod_op == GET_BLOCK_SIZE) {
-            // Obtener información del cliente
-            struct sockaddr_in cliente_addr;
-            socklen_t addr_len = sizeof(cliente_addr);
-            char cliente_ip[INET_ADDRSTRLEN];
-            
-            if (getpeername(socket_cliente, (struct sockaddr*)&cliente_addr, &addr_len) == 0) {
-                inet_ntop(AF_INET, &cliente_addr.sin_addr, cliente_ip, INET_ADDRSTRLEN);
-            } else {
-                strcpy(cliente_ip, "IP desconocida");
-            }
-            
-            log_info(logger, "## Se conecta un Worker desde %s - Socket: %d", cliente_ip, socket_cliente);
-            
-            // Recibir ID del Worker inmediatamente después del handshake
-            char* worker_id_recibido = NULL;
-            int worker_id_numerico = contador_worker_id_storage; // Valor por defecto
+    // Recibir ID del Worker inmediatamente después del handshake
+    char* worker_id_recibido = NULL;
+    int worker_id_numerico = 0;
+    
+    if (cod_op == GET_BLOCK_SIZE) {
+        // Recibir ID del Worker
+        uint32_t tam_id_network;
+        if (lector_leer(conexion->lector, &tam_id_network, sizeof(uint32_t))) {
+            uint32_t tam_id = ntohl(tam_id_network);
             
-            if (cod_op == GET_BLOCK_SIZE) {
-                // Recibir ID del Worker
-                uint32_t tam_id_network;
-                bytes = recv(socket_cliente, &tam_id_network, sizeof(uint32_t), MSG_WAITALL);
+            if (tam_id > 0 && tam_id < 1024) {
+                worker_id_recibido = malloc(tam_id);
                 
-                if (bytes > 0) {
-                    uint32_t tam_id = ntohl(tam_id_network);
-                    
-                    if (tam_id > 0 && tam_id < 1024) {
-                        worker_id_recibido = malloc(tam_id);
-                        bytes = recv(socket_cliente, worker_id_recibido, tam_id, MSG_WAITALL);
-                        
-                        if (bytes > 0) {
-                            // Asegurar terminación NULL
-                            if (worker_id_recibido[tam_id - 1] != '\0') {
-                                char* temp = realloc(worker_id_recibido, tam_id + 1);
-                                if (temp) {
-                                    worker_id_recibido = temp;
-                                    worker_id_recibido[tam_id] = '\0';
-                                }
-                            }
-                            
-                            // Convertir a numérico
-                            worker_id_numerico = atoi(worker_id_recibido);
-                            if (worker_id_numerico <= 0) {
-                                worker_id_numerico = contador_worker_id_storage;
-                            }
-                            
-                            log_info(logger, "Worker identificado con ID: %s (numérico: %d)", 
-                                     worker_id_recibido, worker_id_numerico);
+                if (lector_leer(conexion->lector, worker_id_recibido, tam_id)) {
+                    // Asegurar terminación NULL
+                    if (worker_id_recibido[tam_id - 1] != '\0') {
+                        char* temp = realloc(worker_id_recibido, tam_id + 1);
+                        if (temp) {
+                            worker_id_recibido = temp;
+                            worker_id_recibido[tam_id] = '\0';
                         }
                     }
+                    
+                    // Convertir a numérico
+                    worker_id_numerico = atoi(worker_id_recibido);
+                    
+                    log_info(logger, "Worker identificado con ID: %s (numérico: %d)", 
+                             worker_id_recibido, worker_id_numerico);
                 }
             }
+        }
+    }
 
-            // Crear y agregar worker CON EL ID RECIBIDO
-            pthread_mutex_lock(&mutex_workers_storage);
+    // Crear y agregar worker CON EL ID RECIBIDO
+    pthread_mutex_lock(&mutex_workers_storage);
 
-            t_worker_storage* worker = malloc(sizeof(t_worker_storage));
+    // Sin ID válido se usa el contador; se lee bajo el mutex porque varios
+    // handshakes pueden atenderse a la vez en el pool
+    if (worker_id_numerico <= 0) {
+        worker_id_numerico = contador_worker_id_storage;
+    }
 
-            // ASIGNAR DIRECTAMENTE EL ID RECIBIDO
-            worker->worker_id = worker_id_numerico;
-            worker->socket_worker = socket_cliente;
-            worker->conectado = true;
+    t_worker_storage* worker = malloc(sizeof(t_worker_storage));
 
-            list_add(lista_workers_storage, worker);
+    // ASIGNAR DIRECTAMENTE EL ID RECIBIDO
+    worker->worker_id = worker_id_numerico;
+    worker->worker_id_str = NULL;
+    worker->socket_worker = socket_cliente;
+    worker->conectado = true;
+    pthread_mutex_init(&worker->mutex_envio, NULL);
+    pthread_mutex_init(&worker->mutex_lecturas, NULL);
+    pthread_cond_init(&worker->sin_lecturas, NULL);
+    worker->lecturas_en_curso = 0;
+    worker->lector = conexion->lector;
 
-            // ACTUALIZAR CONTADOR GLOBAL
-            if (worker_id_numerico >= contador_worker_id_storage) {
-                contador_worker_id_storage = worker_id_numerico + 1;
-            } else {
-                // Si el ID recibido es menor, incrementar contador normalmente
-                contador_worker_id_storage++;
-            }
+    list_add(lista_workers_storage, worker);
 
-            int cantidad_workers = list_size(lista_workers_storage);
+    // ACTUALIZAR CONTADOR GLOBAL
+    if (worker_id_numerico >= contador_worker_id_storage) {
+        contador_worker_id_storage = worker_id_numerico + 1;
+    } else {
+        // Si el ID recibido es menor, incrementar contador normalmente
+        contador_worker_id_storage++;
+    }
 
-            pthread_mutex_unlock(&mutex_workers_storage);
+    int cantidad_workers = list_size(lista_workers_storage);
 
-            logging_conexion_worker_storage(worker, cantidad_workers);
+    pthread_mutex_unlock(&mutex_workers_storage);
 
-            // Si el Worker envió GET_BLOCK_SIZE, responder inmediatamente
-            if (cod_op == GET_BLOCK_SIZE) {
-                log_info(logger, "Respondiendo GET_BLOCK_SIZE inmediatamente al Worker %d", worker->worker_id);
-                
-                // Enviar BLOCK_SIZE con endianness correcto
-                int codigo_respuesta = BLOCK_SIZE;
-                int codigo_network = htonl(codigo_respuesta);
-                size_t block_size = 16; // USAR BLOCK_SIZE DEL SUPERBLOQUE
-                uint32_t block_size_network = htonl((uint32_t)block_size);
-                
-                send(socket_cliente, &codigo_network, sizeof(int), MSG_NOSIGNAL);
-                send(socket_cliente, &block_size_network, sizeof(uint32_t), MSG_NOSIGNAL);
-                
-                log_info(logger, "BLOCK_SIZE enviado al Worker %d", worker->worker_id);
-            }
-            
-            // Liberar memoria del ID
-            if (worker_id_recibido != NULL) {
-                free(worker_id_recibido);
-            }
+    conexion->worker = worker;
+    logging_conexion_worker_storage(worker, cantidad_workers);
 
-            // Crear hilo para atender al worker
-            pthread_t hilo_worker;
-            pthread_create(&hilo_worker, NULL, atender_worker_storage, worker);
-            pthread_detach(hilo_worker);
-        } else {
-            log_warning(logger, "Tipo de módulo no reconocido (%d) - Cerrando conexión", cod_op);
-            close(socket_cliente);
-        }
+    // Si el Worker envió GET_BLOCK_SIZE, responder inmediatamente
+    if (cod_op == GET_BLOCK_SIZE) {
+        log_info(logger, "Respondiendo GET_BLOCK_SIZE inmediatamente al Worker %d", worker->worker_id);
+        
+        // Enviar BLOCK_SIZE con endianness correcto
+        int codigo_respuesta = BLOCK_SIZE;
+        int codigo_network = htonl(codigo_respuesta);
+        size_t block_size = 16; // USAR BLOCK_SIZE DEL SUPERBLOQUE
+        uint32_t block_size_network = htonl((uint32_t)block_size);
+        
+        struct iovec iov[2] = {
+            { .iov_base = &codigo_network, .iov_len = sizeof(int) },
+            { .iov_base = &block_size_network, .iov_len = sizeof(uint32_t) }
+        };
+        enviar_iovec(socket_cliente, iov, 2);
+        
+        log_info(logger, "BLOCK_SIZE enviado al Worker %d", worker->worker_id);
     }
     
-    close(socket_servidor);
-}
+    // Liberar memoria del ID
+    if (worker_id_recibido != NULL) {
+        free(worker_id_recibido);
+    }
 
-void* atender_worker_storage(void* args) {
-    t_worker_storage* worker = (t_worker_storage*)args;
-    
     log_info(logger, "Iniciando atención al Worker %d", worker->worker_id);
-    
-    // CARGAR CONFIGURACIÓN DEL SUPERBLOQUE
-    static uint32_t storage_block_size = 0;
-    static bool config_cargada = false;
-    
-    if (!config_cargada) {
-        char* ubicaciones_superblock[] = {
-            "superblock.config",
-            "../superblock.config",
-            "../../superblock.config",
-            "../../storage/superblock.config",
-            "../../../superblock.config",
-            NULL
-        };
+    return true;
+}
+
+// RESPUESTAS AL WORKER
+// [estado][id_pedido][tam_payload][payload] en un solo envío; el mutex evita que
+// se mezclen respuestas de lecturas que terminan a la vez en distintos hilos
+void responder_pedido(t_pedido_storage* pedido, int estado, const void* payload, uint32_t tam_payload) {
+    t_encabezado_respuesta_storage encabezado = {
+        .estado = htonl(estado),
+        .id_pedido = htonl(pedido->id_pedido),
+        .tam_payload = htonl(tam_payload)
+    };
+    struct iovec iov[2] = {
+        { .iov_base = &encabezado, .iov_len = sizeof(encabezado) },
+        { .iov_base = (void*)payload, .iov_len = tam_payload }
+    };
+
+    // El socket no bloquea: enviar_iovec espera a que acepte el resto si se llena
+    pthread_mutex_lock(&pedido->worker->mutex_envio);
+    bool enviado = enviar_iovec(pedido->worker->socket_worker, iov, tam_payload > 0 ? 2 : 1);
+    pthread_mutex_unlock(&pedido->worker->mutex_envio);
+
+    if (!enviado) {
+        log_error(logger, "Error al responder pedido %u al Worker %d: %s",
+                  pedido->id_pedido, pedido->worker->worker_id, strerror(errno));
+    }
+}
+
+void responder_ok(t_pedido_storage* pedido) {
+    responder_pedido(pedido, OP_OK, NULL, 0);
+}
+
+void responder_error(t_pedido_storage* pedido) {
+    responder_pedido(pedido, OP_ERROR, NULL, 0);
+}
+
+// Atiende un único pedido (t_encabezado_pedido_storage + cuerpo) del Worker y
+// rearma la conexión. Devuelve false si se desconectó.
+//
+// Los OP_READ no modifican nada: se rearma la conexión apenas se leyó el cuerpo
+// y el bloque se lee mientras otro hilo atiende el pedido siguiente, así que
+// pueden responderse fuera de orden. Cualquier otra operación espera a que
+// terminen las lecturas en curso y se ejecuta antes de leer el pedido
+// siguiente, de modo que nunca se reordena respecto de una escritura.
+bool atender_pedido_worker_storage(t_conexion_storage* conexion) {
+    t_worker_storage* worker = conexion->worker;
+
+    t_encabezado_pedido_storage encabezado;
+    if (!lector_leer(worker->lector, &encabezado, sizeof(encabezado))) {
+        return false;
+    }
+
+    t_pedido_storage pedido = {
+        .worker = worker,
+        .op = ntohl(encabezado.op),
+        .id_pedido = ntohl(encabezado.id_pedido),
+        .query_id = ntohl(encabezado.query_id),
+        .pc = ntohl(encabezado.pc),
+        .tam_payload = ntohl(encabezado.tam_payload)
+    };
+    log_info(logger, "Worker %d envió código OP: %d (pedido %u, query %u, PC %u)",
+             worker->worker_id, pedido.op, pedido.id_pedido, pedido.query_id, pedido.pc);
+
+    if (pedido.op == OP_READ) {
+        log_info(logger, "Worker %d solicitó OP_READ", worker->worker_id);
+
+        uint32_t pagina;
+        char* file_tag = recibir_pedido_lectura(worker->lector, &pagina);
+        if (!file_tag) {
+            return false;
+        }
+
+        pthread_mutex_lock(&worker->mutex_lecturas);
+        worker->lecturas_en_curso++;
+        pthread_mutex_unlock(&worker->mutex_lecturas);
+
+        bool rearmada = rearmar_conexion_storage(conexion);
+        manejar_read_page(&pedido, file_tag, pagina);
+
+        // Desde acá otro hilo puede estar cerrando la conexión: no tocar nada más
+        pthread_mutex_lock(&worker->mutex_lecturas);
+        if (--worker->lecturas_en_curso == 0) {
+            pthread_cond_broadcast(&worker->sin_lecturas);
+        }
+        pthread_mutex_unlock(&worker->mutex_lecturas);
+        return rearmada;
+    }
+
+    esperar_lecturas_en_curso(worker);
+
+    switch (pedido.op) {
+        case GET_BLOCK_SIZE: {
+            log_info(logger, "Worker %d solicitó BLOCK_SIZE", worker->worker_id);
+            
+            uint32_t block_size_network = htonl(storage_block_size);
+            
+            log_info(logger, "Enviando BLOCK_SIZE=%u bytes", storage_block_size);
+            responder_pedido(&pedido, OP_OK, &block_size_network, sizeof(uint32_t));
+            log_info(logger, "BLOCK_SIZE enviado al Worker %d", worker->worker_id);
+            break;
+        }
+
+        case OP_CREATE: {
+            log_info(logger, "Worker %d solicitó OP_CREATE", worker->worker_id);
+            manejar_create_file(&pedido);  
+            break;
+        }
         
-        t_config* superblock_config = NULL;
-        char* ruta_encontrada = NULL;
+        case OP_WRITE: {
+            log_info(logger, "Worker %d solicitó OP_WRITE", worker->worker_id);
+            manejar_write_file(&pedido);  
+            break;
+        }
         
-        for (int i = 0; ubicaciones_superblock[i] != NULL; i++) {
-            FILE* test_file = fopen(ubicaciones_superblock[i], "r");
-            if (test_file != NULL) {
-                fclose(test_file);
-                ruta_encontrada = ubicaciones_superblock[i];
-                log_info(logger, "superblock.config encontrado en: %s", ruta_encontrada);
-                break;
-            }
+        case OP_WRITE_VECTORIAL: {
+            log_info(logger, "Worker %d solicitó OP_WRITE_VECTORIAL", worker->worker_id);
+            manejar_write_vectorial(&pedido);
+            break;
         }
         
-        if (ruta_encontrada != NULL) {
-            superblock_config = config_create(ruta_encontrada);
-            if (superblock_config != NULL) {
-                if (config_has_property(superblock_config, "BLOCK_SIZE")) {
-                    storage_block_size = config_get_int_value(superblock_config, "BLOCK_SIZE");
-                    log_info(logger, "BLOCK_SIZE cargado: %u bytes", storage_block_size);
-                } else {
-                    log_error(logger, "No se encontró BLOCK_SIZE");
-                    storage_block_size = 16;
-                }
-                config_destroy(superblock_config);
-            } else {
-                log_error(logger, "No se pudo cargar superblock.config");
-                storage_block_size = 16;
-            }
-        } else {
-            log_error(logger, "No se encontró superblock.config");
-            storage_block_size = 16;
+        case OP_TRUNCATE: {
+            log_info(logger, "Worker %d solicitó OP_TRUNCATE", worker->worker_id);
+            manejar_truncate_file(&pedido);
+            break;
         }
-        config_cargada = true;
-    }
-    
-    bool conexion_activa = true;
-    uint32_t current_query_id = 0; 
-    
-    while (conexion_activa && worker->conectado) {
-        int cod_op_network;
-        ssize_t bytes = recv(worker->socket_worker, &cod_op_network, sizeof(int), MSG_WAITALL);
         
-        if (bytes <= 0) {
-            conexion_activa = false;
+        case OP_DELETE: {
+            log_info(logger, "Worker %d solicitó OP_DELETE", worker->worker_id);
+            manejar_delete_file(&pedido); 
+            break;
+        }
+        
+        case OP_TAG: {
+            log_info(logger, "Worker %d solicitó TAG", worker->worker_id);
+            manejar_tag_file(&pedido);
+            break;
+        }
+        
+        case OP_COMMIT: {
+            log_info(logger, "Worker %d solicitó COMMIT", worker->worker_id);
+            manejar_commit_file(&pedido); 
             break;
         }
 
-        int cod_op = ntohl(cod_op_network);
-        log_info(logger, "Worker %d envió código OP: %d", worker->worker_id, cod_op);
-
-        switch (cod_op) {
-            case OP_PROGRAM_COUNTER: {
-                uint32_t pc_network;
-                recv(worker->socket_worker, &pc_network, sizeof(uint32_t), MSG_WAITALL);
-                current_query_id = ntohl(pc_network);  
-                log_info(logger, "PC recibido del Worker %d: %u", worker->worker_id, current_query_id);
-                break;
-            }
-            
-            case GET_BLOCK_SIZE: {
-                log_info(logger, "Worker %d solicitó BLOCK_SIZE", worker->worker_id);
-                
-                int codigo_respuesta = BLOCK_SIZE;
-                int codigo_network = htonl(codigo_respuesta);
-                uint32_t block_size_network = htonl(storage_block_size);
-                
-                log_info(logger, "Enviando BLOCK_SIZE=%u bytes", storage_block_size);
-                
-                send(worker->socket_worker, &codigo_network, sizeof(uint32_t), MSG_NOSIGNAL);
-                send(worker->socket_worker, &block_size_network, sizeof(uint32_t), MSG_NOSIGNAL);
-                
-                log_info(logger, "BLOCK_SIZE enviado al Worker %d", worker->worker_id);
-                break;
-            }
+        case OP_FLUSH: {
+            log_info(logger, "Worker %d solicitó FLUSH", worker->worker_id);
+            manejar_flush_file(&pedido); 
+            break;
+        }
 
-            case OP_CREATE: {
-                log_info(logger, "Worker %d solicitó OP_CREATE", worker->worker_id);
-                manejar_create_file(worker->socket_worker, current_query_id);  
-                break;
-            }
-            
-            case OP_WRITE: {
-                log_info(logger, "Worker %d solicitó OP_WRITE", worker->worker_id);
-                manejar_write_file(worker->socket_worker, current_query_id);  
-                break;
-            }
-             
-            case OP_READ: {
-                log_info(logger, "Worker %d solicitó OP_READ", worker->worker_id);
-                manejar_read_page(worker->socket_worker, current_query_id); 
-                break;
-            }
+        case OP_END: {
+            log_info(logger, "Worker %d solicitó OP_END", worker->worker_id);
             
-            case OP_TRUNCATE: {
-                log_info(logger, "Worker %d solicitó OP_TRUNCATE", worker->worker_id);
-                manejar_truncate_file(worker->socket_worker, current_query_id);
-                break;
-            }
-            
-            case OP_DELETE: {
-                log_info(logger, "Worker %d solicitó OP_DELETE", worker->worker_id);
-                manejar_delete_file(worker->socket_worker, current_query_id); 
-                break;
+            char* worker_id = lector_leer_string_red(worker->lector);
+            if (!worker_id) {
+                return false;
             }
+            log_info(logger, "Worker %s ha finalizado su query", worker_id);
+            free(worker_id);
             
-            case OP_TAG: {
-                log_info(logger, "Worker %d solicitó TAG", worker->worker_id);
-                manejar_tag_file(worker->socket_worker, current_query_id);
-                break;
-            }
-            
-            case OP_COMMIT: {
-                log_info(logger, "Worker %d solicitó COMMIT", worker->worker_id);
-                manejar_commit_file(worker->socket_worker, current_query_id); 
-                break;
-            }
+            responder_ok(&pedido);
+            log_info(logger, "Confirmación OP_END enviada al Worker %d", worker->worker_id);
+            break;
+        }
 
-            case OP_FLUSH: {
-                log_info(logger, "Worker %d solicitó FLUSH", worker->worker_id);
-                manejar_flush_file(worker->socket_worker, current_query_id); 
-                break;
-            }
+        default: {
+            log_warning(logger, "Código de operación desconocido del Worker %d: %d", 
+                       worker->worker_id, pedido.op);
 
-            case OP_END: {
-                log_info(logger, "Worker %d solicitó OP_END", worker->worker_id);
-                
-                uint32_t tam_id_network;
-                ssize_t bytes_recv = recv(worker->socket_worker, &tam_id_network, sizeof(uint32_t), MSG_WAITALL);
-                
-                if (bytes_recv > 0) {
-                    uint32_t tam_id = ntohl(tam_id_network);
-                    char* worker_id = malloc(tam_id);
-                    if (worker_id) {
-                        recv(worker->socket_worker, worker_id, tam_id, MSG_WAITALL);
-                        log_info(logger, "Worker %s ha finalizado su query", worker_id);
-                        free(worker_id);
-                    }
-                }
-                
-                enviar_ok(worker->socket_worker);
-                log_info(logger, "Confirmación OP_END enviada al Worker %d", worker->worker_id);
-                break;
+            // El encabezado dice cuánto ocupa el cuerpo: se descarta sin perder el sincronismo
+            if (!lector_descartar(worker->lector, pedido.tam_payload)) {
+                return false;
             }
+            responder_error(&pedido);
+            break;
+        }
+    }
 
-            default:
-                log_warning(logger, "Código de operación desconocido del Worker %d: %d", 
-                           worker->worker_id, cod_op);
-                break;
+    return rearmar_conexion_storage(conexion);
+}
+
+// Hilo del pool: toma una conexión con datos y atiende un pedido
+static void* hilo_pool_storage(void* args) {
+    while (1) {
+        sem_wait(&sem_conexiones_listas);
+
+        pthread_mutex_lock(&mutex_conexiones_listas);
+        t_conexion_storage* conexion = queue_pop(cola_conexiones_listas);
+        pthread_mutex_unlock(&mutex_conexiones_listas);
+
+        if (conexion->cerrada) {
+            cerrar_conexion_storage(conexion);
+        } else if (conexion->worker == NULL) {
+            if (!atender_handshake_storage(conexion) || !rearmar_conexion_storage(conexion)) {
+                cerrar_conexion_storage(conexion);
+            }
+        } else if (!atender_pedido_worker_storage(conexion)) {
+            cerrar_conexion_storage(conexion);
         }
     }
+    return NULL;
+}
+
+static void iniciar_pool_storage(void) {
+    long cantidad_hilos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cantidad_hilos < 1) cantidad_hilos = 1;
+
+    cola_conexiones_listas = queue_create();
+    pthread_mutex_init(&mutex_conexiones_listas, NULL);
+    sem_init(&sem_conexiones_listas, 0, 0);
+
+    for (long i = 0; i < cantidad_hilos; i++) {
+        pthread_t hilo;
+        pthread_create(&hilo, NULL, hilo_pool_storage, NULL);
+        pthread_detach(hilo);
+    }
+
+    log_info(logger, "Pool de atención iniciado con %ld hilos", cantidad_hilos);
+}
+
+void iniciar_servidor_storage() {
+    // Obtener puerto de escucha desde configuración
+    int puerto_escucha = config_get_int_value(global_storage->storage_config, "PUERTO_ESCUCHA");
     
-    // Worker desconectado
-    pthread_mutex_lock(&mutex_workers_storage);
-    worker->conectado = false;
-    list_remove_element(lista_workers_storage, worker);
-    int cantidad_workers = list_size(lista_workers_storage);
-    pthread_mutex_unlock(&mutex_workers_storage);
+    int socket_servidor = iniciar_servidor(logger, puerto_escucha);
     
-    logging_desconexion_worker_storage(worker->worker_id, cantidad_workers);
+    if (socket_servidor == -1) {
+        log_error(logger, "Error al iniciar el servidor Storage");
+        return;
+    }
+    fcntl(socket_servidor, F_SETFL, fcntl(socket_servidor, F_GETFL) | O_NONBLOCK);
+
+    fd_epoll_storage = epoll_create1(EPOLL_CLOEXEC);
+    if (fd_epoll_storage < 0) {
+        log_error(logger, "Error al crear epoll: %s", strerror(errno));
+        close(socket_servidor);
+        return;
+    }
+
+    // El socket de escucha queda siempre armado (sin EPOLLONESHOT)
+    struct epoll_event evento_escucha = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(fd_epoll_storage, EPOLL_CTL_ADD, socket_servidor, &evento_escucha);
+
+    storage_block_size = obtener_block_size_desde_superbloque();
+    pool_buffers_configurar_pagina(storage_block_size);
+    iniciar_pool_storage();
     
-    close(worker->socket_worker);
-    free(worker);
+    log_info(logger, "Servidor Storage iniciado en puerto %d", puerto_escucha);
+    log_info(logger, "Esperando conexiones de Workers...");
     
-    return NULL;
+    struct epoll_event eventos[STORAGE_MAX_EVENTOS];
+    while (1) {
+        int cantidad = epoll_wait(fd_epoll_storage, eventos, STORAGE_MAX_EVENTOS, -1);
+        if (cantidad < 0) {
+            if (errno == EINTR) continue;
+            log_error(logger, "Error en epoll_wait: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < cantidad; i++) {
+            t_conexion_storage* conexion = eventos[i].data.ptr;
+
+            if (conexion != NULL) {
+                // Desarmada por EPOLLONESHOT hasta que llegue el pedido completo y el pool lo termine
+                recibir_de_conexion_storage(conexion);
+                continue;
+            }
+
+            // Aceptar todas las conexiones pendientes
+            int socket_cliente;
+            while ((socket_cliente = accept(socket_servidor, NULL, NULL)) >= 0) {
+                // Ni el hilo de epoll ni el pool se bloquean leyendo de un Worker
+                fcntl(socket_cliente, F_SETFL, fcntl(socket_cliente, F_GETFL) | O_NONBLOCK);
+
+                t_conexion_storage* nueva = malloc(sizeof(t_conexion_storage));
+                nueva->socket = socket_cliente;
+                nueva->worker = NULL;
+                nueva->lector = lector_crear(socket_cliente, CAPACIDAD_LECTOR_WORKER);
+                nueva->cerrada = false;
+
+                if (!armar_conexion_storage(nueva, EPOLL_CTL_ADD)) {
+                    lector_destruir(nueva->lector);
+                    close(socket_cliente);
+                    free(nueva);
+                }
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                log_error(logger, "Error al aceptar cliente: %s", strerror(errno));
+            }
+        }
+    }
+    
+    close(fd_epoll_storage);
+    close(socket_servidor);
 }
 
 // Función auxiliar para eliminar directorios recursivamente (fallback)
@@ -1277,22 +1519,18 @@ void storage_destroy(storage_t* storage) {
     }
 }
 
-// Función auxiliar para recibir strings del Worker
-char* recibir_string_del_worker(int socket) {
-    // Primero recibir el tamaño
-    uint32_t size_network;
-    if (recv(socket, &size_network, sizeof(uint32_t), MSG_WAITALL) <= 0) {
-        return NULL;
-    }
-    uint32_t size = ntohl(size_network);
-    
-    // Recibir el string
-    char* str = malloc(size);
-    if (recv(socket, str, size, MSG_WAITALL) <= 0) {
-        free(str);
+// Función auxiliar para recibir strings del Worker ([tamaño][bytes con \0]).
+// El string sale del pool del hilo: se libera con pool_buffers_devolver.
+char* recibir_string_del_worker(t_lector_tramas* lector) {
+    uint32_t tam;
+    if (!lector_leer_uint32_red(lector, &tam) || tam == 0) return NULL;
+
+    char* str = pool_buffers_obtener(tam);
+    if (!lector_leer(lector, str, tam)) {
+        pool_buffers_devolver(str);
         return NULL;
     }
-    
+    str[tam - 1] = '\0';
     return str;
 }
 
@@ -1485,26 +1723,26 @@ int storage_create_file(storage_t* storage, const char* filename, const char* ta
     return 0;
 }
 
-void manejar_create_file(int socket_cliente, uint32_t query_id) {
+void manejar_create_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "═══════════════════════════════════════════════");
     log_info(logger, "INICIANDO CREATE_FILE");
     
     // Recibir filename
-    char* filename = recibir_string_del_worker(socket_cliente);
+    char* filename = recibir_string_del_worker(lector);
     if (!filename) {
         log_error(logger, "ERROR: No se pudo recibir filename en CREATE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     // Recibir tag
-    char* tag = recibir_string_del_worker(socket_cliente);
+    char* tag = recibir_string_del_worker(lector);
     if (!tag) {
         log_error(logger, "ERROR: No se pudo recibir tag en CREATE");
-        free(filename);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        pool_buffers_devolver(filename);
+        responder_error(pedido);
         return;
     }
 
@@ -1513,17 +1751,17 @@ void manejar_create_file(int socket_cliente, uint32_t query_id) {
     // VERIFICAR PARÁMETROS
     if (strlen(filename) == 0) {
         log_error(logger, "ERROR: filename está vacío");
-        free(filename);
-        free(tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        responder_error(pedido);
         return;
     }
 
     if (strlen(tag) == 0) {
         log_warning(logger, "Tag vacío, usando 'BASE' por defecto");
-        free(tag);
-        tag = strdup("BASE");
+        pool_buffers_devolver(tag);
+        tag = pool_buffers_obtener(sizeof("BASE"));
+        strcpy(tag, "BASE");
     }
 
     // Ejecutar operación
@@ -1534,15 +1772,14 @@ void manejar_create_file(int socket_cliente, uint32_t query_id) {
         logging_file_creado(query_id, filename, tag);
         
         log_info(logger, "CREATE_FILE EXITOSO: %s:%s", filename, tag);
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
     } else {
         log_error(logger, "CREATE_FILE FALLÓ: %s:%s", filename, tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
     }
     
-    free(filename);
-    free(tag);
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
 }
 
 int reservar_bloque_libre(storage_t* storage, uint32_t query_id) {
@@ -2075,27 +2312,27 @@ int storage_truncate_file(storage_t* storage, const char* filename, const char*
     return -1;
 }
 
-void manejar_truncate_file(int socket_cliente, uint32_t query_id) {
+void manejar_truncate_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "Manejando TRUNCATE_FILE");
     
     // Recibir filename
-    char* filename = recibir_string_del_worker(socket_cliente);
+    char* filename = recibir_string_del_worker(lector);
     if (!filename) {
         log_error(logger, "Error al recibir filename en TRUNCATE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     log_info(logger, "Filename recibido: %s", filename);
     
     // Recibir tag
-    char* tag = recibir_string_del_worker(socket_cliente);
+    char* tag = recibir_string_del_worker(lector);
     if (!tag) {
-        free(filename);
+        pool_buffers_devolver(filename);
         log_error(logger, "Error al recibir tag en TRUNCATE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
@@ -2103,28 +2340,14 @@ void manejar_truncate_file(int socket_cliente, uint32_t query_id) {
     log_info(logger, "TRUNCATE_FILE solicitado para: %s:%s", filename, tag);
     
     // Recibir nuevo tamaño
-    uint32_t size_network;
-    ssize_t bytes_recv = recv(socket_cliente, &size_network, sizeof(uint32_t), MSG_WAITALL);
-    if (bytes_recv <= 0) {
-        free(filename);
-        free(tag);
-        log_error(logger, "Error recibiendo tamaño en TRUNCATE: %zd bytes", bytes_recv);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
-        return;
-    }
-
-    if (bytes_recv != sizeof(uint32_t)) {
-        free(filename);
-        free(tag);
-        log_error(logger, "Tamaño incompleto en TRUNCATE: %zd de %zu bytes", 
-                 bytes_recv, sizeof(uint32_t));
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+    uint32_t new_size;
+    if (!lector_leer_uint32_red(lector, &new_size)) {
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        log_error(logger, "Error recibiendo tamaño en TRUNCATE");
+        responder_error(pedido);
         return;
     }
-
-    uint32_t new_size = ntohl(size_network);
     
     log_info(logger, "TRUNCATE_FILE recibido: %s:%s, nuevo tamaño: %u", filename, tag, new_size);
     
@@ -2134,16 +2357,15 @@ void manejar_truncate_file(int socket_cliente, uint32_t query_id) {
     if (result == 0) {
         logging_file_truncado(query_id, filename, tag, new_size);
 
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
         log_info(logger, "TRUNCATE_FILE completado para: %s:%s", filename, tag);
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         log_error(logger, "TRUNCATE_FILE falló para: %s:%s", filename, tag);
     }
     
-    free(filename);
-    free(tag);
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
 
     log_info(logger, "TRUNCATE_FILE - Procesamiento completamente finalizado");
 }
@@ -2156,39 +2378,27 @@ int allocate_physical_block(storage_t* storage, uint32_t query_id) {
     return reservar_bloque_libre(storage, query_id);
 }
 
-int storage_write_file(storage_t* storage,
-                       const char* filename,
-                       const char* tag,
-                       uint32_t offset,
-                       const void* data,
-                       uint32_t size, uint32_t query_id) {
-    pthread_mutex_lock(&storage->mutex);
-    apply_operation_delay(storage);
-
-    log_info(logger, "STORAGE_WRITE_FILE: %s:%s offset=%u size=%u (BLOCK_SIZE=%zu)",
-             filename, tag, offset, size, storage->block_size);
-
+// Abre la metadata de un archivo en el que se va a escribir. Devuelve NULL si no existe
+// o está COMMITTED. Requiere storage->mutex tomado.
+static t_config* abrir_metadata_escritura(storage_t* storage, const char* filename, const char* tag) {
     char metadata_path[MAX_PATH_LENGTH];
     int written = snprintf(metadata_path, sizeof(metadata_path),
                            "%s/%s/%s/%s/%s",
                            storage->root_path, FILES_DIR, filename, tag, METADATA_FILENAME);
     if (written < 0 || written >= (int)sizeof(metadata_path)) {
         log_error(logger, "STORAGE_WRITE_FILE: Path metadata demasiado largo");
-        pthread_mutex_unlock(&storage->mutex);
-        return -1;
+        return NULL;
     }
 
     if (access(metadata_path, F_OK) != 0) {
         log_error(logger, "STORAGE_WRITE_FILE: Archivo %s:%s no existe", filename, tag);
-        pthread_mutex_unlock(&storage->mutex);
-        return -1;
+        return NULL;
     }
 
     t_config* metadata = config_create(metadata_path);
     if (!metadata) {
         log_error(logger, "STORAGE_WRITE_FILE: Error al abrir metadata");
-        pthread_mutex_unlock(&storage->mutex);
-        return -1;
+        return NULL;
     }
 
     // Verificar COMMITTED
@@ -2206,18 +2416,30 @@ int storage_write_file(storage_t* storage,
         log_error(logger, "STORAGE_WRITE_FILE: No se puede escribir en archivo COMMITTED %s:%s",
                   filename, tag);
         config_destroy(metadata);
-        pthread_mutex_unlock(&storage->mutex);
-        return -1;
+        return NULL;
     }
 
-    uint32_t file_size = (uint32_t)config_get_int_value(metadata, "TAMAÑO");
+    return metadata;
+}
 
+static void agregar_bloque_escrito(t_list* escritos, int bloque) {
+    for (int i = 0; i < list_size(escritos); i++) {
+        if ((int)(long)list_get(escritos, i) == bloque) return;
+    }
+    list_add(escritos, (void*)(long)bloque);
+}
+
+// Escribe un rango del archivo sin sincronizar: los bloques físicos escritos se agregan
+// a 'escritos' (sin repetir) y se sincronizan una sola vez al final de la operación.
+// Requiere storage->mutex tomado. Devuelve 0 si se escribió todo el rango.
+static int escribir_rango_archivo(storage_t* storage, const char* filename, const char* tag,
+                                  t_list* blocks, uint32_t file_size,
+                                  uint32_t offset, const void* data, uint32_t size,
+                                  uint32_t query_id, bool* blocks_modified, t_list* escritos) {
     if (offset >= file_size) {
         log_error(logger,
                   "STORAGE_WRITE_FILE: offset=%u fuera de rango (TAMAÑO=%u)",
                   offset, file_size);
-        config_destroy(metadata);
-        pthread_mutex_unlock(&storage->mutex);
         return -1;
     }
 
@@ -2228,15 +2450,6 @@ int storage_write_file(storage_t* storage,
         size = file_size - offset;
     }
 
-    t_list* blocks = get_file_blocks(storage, filename, tag);
-    if (!blocks) {
-        log_error(logger, "STORAGE_WRITE_FILE: Error obteniendo bloques para %s:%s",
-                  filename, tag);
-        config_destroy(metadata);
-        pthread_mutex_unlock(&storage->mutex);
-        return -1;
-    }
-
     size_t block_size = storage->block_size;
 
     // ✅ CALCULAR BLOQUE LÓGICO DE INICIO
@@ -2245,8 +2458,6 @@ int storage_write_file(storage_t* storage,
 
     const uint8_t* src = (const uint8_t*)data;
     uint32_t remaining = size;
-    
-    bool blocks_modified = false;
 
     log_info(logger, "WRITE: offset=%u, size=%u -> bloque_inicial=%u, offset_en_bloque=%u",
              offset, size, bloque_logico, offset_in_block);
@@ -2284,7 +2495,7 @@ int storage_write_file(storage_t* storage,
             list_replace(blocks, bloque_logico, (void*)(long)new_physical_block);
             update_logical_block_link(storage, filename, tag, bloque_logico, new_physical_block);
             physical_block_to_write = new_physical_block;
-            blocks_modified = true;
+            *blocks_modified = true;
             
             log_info(logger, "STORAGE_WRITE_FILE: CoW completado: %d -> %d",
                      current_physical_block, new_physical_block);
@@ -2304,9 +2515,8 @@ int storage_write_file(storage_t* storage,
         uint32_t writable = block_size - offset_in_block;
         if (writable > remaining) writable = remaining;
 
-        // ✅ POSICIONARSE EN EL OFFSET DENTRO DEL BLOQUE
-        lseek(fd, (off_t)offset_in_block, SEEK_SET);
-        ssize_t written_bytes = write(fd, src, writable);
+        // ✅ ESCRIBIR EN EL OFFSET DENTRO DEL BLOQUE
+        ssize_t written_bytes = pwrite(fd, src, writable, (off_t)offset_in_block);
         
         if (written_bytes != (ssize_t)writable) {
             log_error(logger, "STORAGE_WRITE_FILE: Error en write bloque %d",
@@ -2316,9 +2526,10 @@ int storage_write_file(storage_t* storage,
             break;
         }
 
-        fsync(fd);  // Forzar escritura
         close(fd);
         free(block_path);
+
+        agregar_bloque_escrito(escritos, physical_block_to_write);
         
         log_info(logger, "WRITE: Escritos %zd bytes en bloque físico %d (lógico %u) en offset %u",
                  written_bytes, physical_block_to_write, bloque_logico, offset_in_block);
@@ -2332,6 +2543,23 @@ int storage_write_file(storage_t* storage,
         offset_in_block = 0;  // En bloques siguientes, empezamos desde 0
     }
 
+    if (remaining > 0) {
+        log_error(logger,
+                  "STORAGE_WRITE_FILE: quedó sin escribir %u bytes para %s:%s",
+                  remaining, filename, tag);
+        return -1;
+    }
+
+    log_info(logger,
+             "STORAGE_WRITE_FILE: Escritura exitosa de %u bytes en %s:%s (offset inicial=%u)",
+             size, filename, tag, offset);
+    return 0;
+}
+
+// Cierra una escritura: persiste BLOCKS si hubo Copy-on-Write y hace un único fsync
+// por bloque físico escrito. Requiere storage->mutex tomado.
+static void finalizar_escritura_archivo(t_config* metadata, t_list* blocks, bool blocks_modified,
+                                        storage_t* storage, t_list* escritos) {
     if (blocks_modified) {
         char new_blocks_str[4096] = "[";
         for (int i = 0; i < list_size(blocks); i++) {
@@ -2352,21 +2580,88 @@ int storage_write_file(storage_t* storage,
         }
     }
 
-    list_destroy(blocks);
-    config_destroy(metadata);
-    pthread_mutex_unlock(&storage->mutex);
+    for (int i = 0; i < list_size(escritos); i++) {
+        char* block_path = get_physical_block_path(storage, (int)(long)list_get(escritos, i));
+        if (!block_path) continue;
 
-    if (remaining > 0) {
-        log_error(logger,
-                  "STORAGE_WRITE_FILE: quedó sin escribir %u bytes para %s:%s",
-                  remaining, filename, tag);
+        int fd = open(block_path, O_RDONLY);
+        if (fd != -1) {
+            fsync(fd);  // Forzar escritura
+            close(fd);
+        }
+        free(block_path);
+    }
+}
+
+int storage_write_file(storage_t* storage,
+                       const char* filename,
+                       const char* tag,
+                       uint32_t offset,
+                       const void* data,
+                       uint32_t size, uint32_t query_id) {
+    t_rango_escritura rango = { .offset = offset, .size = size, .datos = data };
+    bool resultado;
+
+    if (storage_write_file_vectorial(storage, filename, tag, &rango, 1, &resultado, query_id) < 0) {
         return -1;
     }
+    return resultado ? 0 : -1;
+}
 
-    log_info(logger,
-             "STORAGE_WRITE_FILE: Escritura exitosa de %u bytes en %s:%s (offset inicial=%u)",
-             size, filename, tag, offset);
-    return 0;
+// Varios WRITE al mismo File:Tag con una sola validación de metadata, un solo retardo de
+// operación y un fsync por bloque tocado. Se aplican en orden; cada rango informa su
+// resultado en resultados[i] y un rango que falla no impide aplicar los siguientes,
+// igual que si fueran WRITE separados. Devuelve la cantidad de rangos escritos o -1 si
+// el archivo no admite escrituras (ninguno se aplicó).
+int storage_write_file_vectorial(storage_t* storage, const char* filename, const char* tag,
+                                 const t_rango_escritura* rangos, uint32_t cantidad,
+                                 bool* resultados, uint32_t query_id) {
+    pthread_mutex_lock(&storage->mutex);
+    apply_operation_delay(storage);
+
+    log_info(logger, "STORAGE_WRITE_FILE: %s:%s %u escrituras (BLOCK_SIZE=%zu)",
+             filename, tag, cantidad, storage->block_size);
+
+    for (uint32_t i = 0; i < cantidad; i++) {
+        resultados[i] = false;
+    }
+
+    t_config* metadata = abrir_metadata_escritura(storage, filename, tag);
+    if (!metadata) {
+        pthread_mutex_unlock(&storage->mutex);
+        return -1;
+    }
+
+    uint32_t file_size = (uint32_t)config_get_int_value(metadata, "TAMAÑO");
+
+    t_list* blocks = get_file_blocks(storage, filename, tag);
+    if (!blocks) {
+        log_error(logger, "STORAGE_WRITE_FILE: Error obteniendo bloques para %s:%s",
+                  filename, tag);
+        config_destroy(metadata);
+        pthread_mutex_unlock(&storage->mutex);
+        return -1;
+    }
+
+    bool blocks_modified = false;
+    t_list* escritos = list_create();
+    int cantidad_escritos = 0;
+
+    for (uint32_t i = 0; i < cantidad; i++) {
+        resultados[i] = escribir_rango_archivo(storage, filename, tag, blocks, file_size,
+                                               rangos[i].offset, rangos[i].datos, rangos[i].size,
+                                               query_id, &blocks_modified, escritos) == 0;
+        if (resultados[i]) cantidad_escritos++;
+    }
+
+    finalizar_escritura_archivo(metadata, blocks, blocks_modified, storage, escritos);
+
+    list_destroy(escritos);
+    list_destroy(blocks);
+    config_destroy(metadata);
+    pthread_mutex_unlock(&storage->mutex);
+
+    return cantidad_escritos;
 }
 
 // Función para obtener la ruta de un bloque físico
@@ -2497,77 +2792,68 @@ int storage_write_block(storage_t* storage, const char* filename, const char* ta
     return 0;
 }
 
-void manejar_write_file(int socket_cliente, uint32_t query_id) {
+void manejar_write_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "Manejando WRITE_FILE");
 
     // 1) Recibir filename
-    char* filename = recibir_string_del_worker(socket_cliente);
+    char* filename = recibir_string_del_worker(lector);
     if (!filename) {
         log_error(logger, "Error al recibir filename en WRITE_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
     log_info(logger, "WRITE_FILE - Filename recibido: %s", filename);
 
     // 2) Recibir tag
-    char* tag = recibir_string_del_worker(socket_cliente);
+    char* tag = recibir_string_del_worker(lector);
     if (!tag) {
         log_error(logger, "Error al recibir tag en WRITE_FILE (tag)");
-        free(filename);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        pool_buffers_devolver(filename);
+        responder_error(pedido);
         return;
     }
     log_info(logger, "WRITE_FILE - Tag recibido: %s", tag);
 
     // 3) Recibir offset (uint32_t)
-    uint32_t offset_net;
-    ssize_t bytes_recv = recv(socket_cliente, &offset_net, sizeof(uint32_t), MSG_WAITALL);
-    if (bytes_recv != sizeof(uint32_t)) {
-        log_error(logger, "Error recibiendo offset en WRITE_FILE: %zd bytes", bytes_recv);
-        free(filename);
-        free(tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+    uint32_t offset;
+    if (!lector_leer_uint32_red(lector, &offset)) {
+        log_error(logger, "Error recibiendo offset en WRITE_FILE");
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        responder_error(pedido);
         return;
     }
-    uint32_t offset = ntohl(offset_net);
     log_info(logger, "WRITE_FILE - Offset recibido: %u", offset);
 
     // 4) Recibir tamaño de los datos (size)
-    uint32_t size_net;
-    bytes_recv = recv(socket_cliente, &size_net, sizeof(uint32_t), MSG_WAITALL);
-    if (bytes_recv != sizeof(uint32_t)) {
-        log_error(logger, "Error recibiendo size en WRITE_FILE: %zd bytes", bytes_recv);
-        free(filename);
-        free(tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+    uint32_t size;
+    if (!lector_leer_uint32_red(lector, &size)) {
+        log_error(logger, "Error recibiendo size en WRITE_FILE");
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        responder_error(pedido);
         return;
     }
-    uint32_t size = ntohl(size_net);
     log_info(logger, "WRITE_FILE - Size recibido: %u", size);
 
     // 5) Recibir datos
-    void* data = malloc(size);
+    void* data = pool_buffers_obtener(size);
     if (!data) {
         log_error(logger, "Error al allocar buffer para WRITE_FILE (size=%u)", size);
-        free(filename);
-        free(tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        responder_error(pedido);
         return;
     }
 
-    bytes_recv = recv(socket_cliente, data, size, MSG_WAITALL);
-    if (bytes_recv != (ssize_t)size) {
-        log_error(logger, "Datos incompletos en WRITE_FILE: %zd de %u bytes", bytes_recv, size);
-        free(filename);
-        free(tag);
-        free(data);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+    if (!lector_leer(lector, data, size)) {
+        log_error(logger, "Datos incompletos en WRITE_FILE: %u bytes", size);
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        pool_buffers_devolver(data);
+        responder_error(pedido);
         return;
     }
 
@@ -2581,23 +2867,127 @@ void manejar_write_file(int socket_cliente, uint32_t query_id) {
         uint32_t bloque_logico = offset / global_storage->block_size;
         logging_bloque_logico_escrito(query_id, filename, tag, bloque_logico);
         
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
 
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         log_error(logger, "WRITE_FILE falló para: %s:%s (offset=%u, size=%u)",
                   filename, tag, offset, size);
     }
 
-    free(filename);
-    free(tag);
-    free(data);
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
+    pool_buffers_devolver(data);
 
     log_info(logger, "WRITE_FILE - Procesamiento completamente finalizado");
 }
 
 
+// Como recibir_string_del_worker, sumando a *consumidos los bytes tomados del cuerpo
+static char* recibir_string_contando(t_lector_tramas* lector, uint32_t* consumidos) {
+    uint32_t tam;
+    if (!lector_leer_uint32_red(lector, &tam)) return NULL;
+    *consumidos += sizeof(uint32_t);
+    if (tam == 0) return NULL;
+
+    char* str = pool_buffers_obtener(tam);
+    if (!lector_leer(lector, str, tam)) {
+        pool_buffers_devolver(str);
+        return NULL;
+    }
+    *consumidos += tam;
+    str[tam - 1] = '\0';
+    return str;
+}
+
+// Pedido rechazado a mitad del cuerpo: se descarta lo que falta leer para no perder
+// el sincronismo con el próximo encabezado
+static void descartar_resto_pedido(t_pedido_storage* pedido, uint32_t consumidos) {
+    if (consumidos < pedido->tam_payload) {
+        lector_descartar(pedido->worker->lector, pedido->tam_payload - consumidos);
+    }
+}
+
+// [filename][tag][cantidad][[offset][size][datos]]... Se responde OP_OK con un byte por
+// escritura (1 = aplicada) u OP_ERROR si el archivo no admite escrituras.
+void manejar_write_vectorial(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
+    uint32_t consumidos = 0;
+    log_info(logger, "Manejando WRITE_VECTORIAL");
+
+    char* filename = recibir_string_contando(lector, &consumidos);
+    char* tag = filename ? recibir_string_contando(lector, &consumidos) : NULL;
+    uint32_t cantidad = 0;
+    bool cantidad_leida = tag && lector_leer_uint32_red(lector, &cantidad);
+    if (cantidad_leida) consumidos += sizeof(uint32_t);
+    if (!cantidad_leida || cantidad == 0 || cantidad > STORAGE_MAX_ESCRITURAS_VECTOR) {
+        log_error(logger, "Encabezado inválido en WRITE_VECTORIAL (cantidad=%u)", cantidad);
+        pool_buffers_devolver(filename);
+        pool_buffers_devolver(tag);
+        descartar_resto_pedido(pedido, consumidos);
+        responder_error(pedido);
+        return;
+    }
+
+    t_rango_escritura rangos[STORAGE_MAX_ESCRITURAS_VECTOR];
+    uint32_t recibidos = 0;
+    bool completo = true;
+
+    for (; recibidos < cantidad; recibidos++) {
+        t_rango_escritura* rango = &rangos[recibidos];
+        if (!lector_leer_uint32_red(lector, &rango->offset) ||
+            !lector_leer_uint32_red(lector, &rango->size)) {
+            completo = false;
+            break;
+        }
+        consumidos += 2 * sizeof(uint32_t);
+
+        void* datos = pool_buffers_obtener(rango->size);
+        if (!datos || !lector_leer(lector, datos, rango->size)) {
+            pool_buffers_devolver(datos);
+            completo = false;
+            break;
+        }
+        consumidos += rango->size;
+        rango->datos = datos;
+    }
+
+    if (!completo) {
+        log_error(logger, "Datos incompletos en WRITE_VECTORIAL: %u de %u escrituras", recibidos, cantidad);
+        descartar_resto_pedido(pedido, consumidos);
+        responder_error(pedido);
+    } else {
+        log_info(logger, "WRITE_VECTORIAL recibido: %s:%s, %u escrituras", filename, tag, cantidad);
+
+        bool resultados[STORAGE_MAX_ESCRITURAS_VECTOR];
+        int escritos = storage_write_file_vectorial(global_storage, filename, tag,
+                                                    rangos, cantidad, resultados, query_id);
+        if (escritos < 0) {
+            responder_error(pedido);
+            log_error(logger, "WRITE_VECTORIAL falló para: %s:%s", filename, tag);
+        } else {
+            uint8_t estados[STORAGE_MAX_ESCRITURAS_VECTOR];
+            for (uint32_t i = 0; i < cantidad; i++) {
+                estados[i] = resultados[i] ? 1 : 0;
+                if (resultados[i]) {
+                    uint32_t bloque_logico = rangos[i].offset / global_storage->block_size;
+                    logging_bloque_logico_escrito(query_id, filename, tag, bloque_logico);
+                }
+            }
+            responder_pedido(pedido, OP_OK, estados, cantidad);
+            log_info(logger, "WRITE_VECTORIAL %s:%s - %d de %u escrituras aplicadas",
+                     filename, tag, escritos, cantidad);
+        }
+    }
+
+    for (uint32_t i = 0; i < recibidos; i++) {
+        pool_buffers_devolver((void*)rangos[i].datos);
+    }
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
+}
+
 // FLUSH
 // FLUSH - VERSIÓN CORREGIDA
 int storage_flush_file(storage_t* storage, const char* filename, const char* tag) {
@@ -2710,27 +3100,26 @@ int storage_flush_file(storage_t* storage, const char* filename, const char* tag
     return 0;
 }
 
-void manejar_flush_file(int socket_cliente, uint32_t query_id) {
+void manejar_flush_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
     log_info(logger, "Manejando FLUSH_FILE");
     
     // Recibir filename
-    char* filename = recibir_string_del_worker(socket_cliente);
+    char* filename = recibir_string_del_worker(lector);
     if (!filename) {
         log_error(logger, "Error al recibir filename en FLUSH_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     log_info(logger, "FLUSH_FILE - Filename recibido: %s", filename);
     
     // Recibir tag
-    char* tag = recibir_string_del_worker(socket_cliente);
+    char* tag = recibir_string_del_worker(lector);
     if (!tag) {
-        free(filename);
+        pool_buffers_devolver(filename);
         log_error(logger, "Error al recibir tag en FLUSH_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
@@ -2742,16 +3131,15 @@ void manejar_flush_file(int socket_cliente, uint32_t query_id) {
     
     // ✅ MODIFICADO: Siempre enviar OK si el archivo existe, incluso si está COMMITTED
     if (result == 0) {
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
         log_info(logger, "FLUSH_FILE completado para: %s:%s", filename, tag);
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         log_error(logger, "FLUSH_FILE falló para: %s:%s", filename, tag);
     }
     
-    free(filename);
-    free(tag);
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
 
     log_info(logger, "FLUSH_FILE - Procesamiento completamente finalizado");
 }
@@ -2907,7 +3295,7 @@ int storage_commit_tag(storage_t* storage, const char* filename, const char* tag
             continue;
         }
         
-        void* data = malloc(storage->block_size);
+        void* data = pool_buffers_obtener(storage->block_size);
         size_t bytes_read = fread(data, 1, storage->block_size, f);
         fclose(f);
         free(block_path);
@@ -2915,13 +3303,13 @@ int storage_commit_tag(storage_t* storage, const char* filename, const char* tag
         if (bytes_read != storage->block_size) {
             log_warning(logger, "COMMIT: Bloque %d incompleto (%zu de %zu bytes)", 
                        current_block, bytes_read, storage->block_size);
-            free(data);
+            pool_buffers_devolver(data);
             continue;
         }
         
         // Calcular hash MD5
         char* current_hash = crypto_md5((unsigned char*)data, storage->block_size);
-        free(data);
+        pool_buffers_devolver(data);
         
         if (!current_hash) {
             log_error(logger, "COMMIT: Error calculando hash del bloque %d", current_block);
@@ -3039,27 +3427,27 @@ int storage_commit_tag(storage_t* storage, const char* filename, const char* tag
     return 0;
 }
 
-void manejar_commit_file(int socket_cliente, uint32_t query_id) {
+void manejar_commit_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "Manejando COMMIT_FILE");
     
     // Recibir filename
-    char* filename = recibir_string_del_worker(socket_cliente);
+    char* filename = recibir_string_del_worker(lector);
     if (!filename) {
         log_error(logger, "Error al recibir filename en COMMIT_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     log_info(logger, "COMMIT_FILE - Filename recibido: %s", filename);
     
     // Recibir tag
-    char* tag = recibir_string_del_worker(socket_cliente);
+    char* tag = recibir_string_del_worker(lector);
     if (!tag) {
-        free(filename);
+        pool_buffers_devolver(filename);
         log_error(logger, "Error al recibir tag en COMMIT_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
@@ -3071,24 +3459,25 @@ void manejar_commit_file(int socket_cliente, uint32_t query_id) {
     
     if (result == 0) {
         logging_commit_tag(query_id, filename, tag);
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
         
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         log_error(logger, "COMMIT_FILE falló para: %s:%s", filename, tag);
     }
     
-    free(filename);
-    free(tag);
+    pool_buffers_devolver(filename);
+    pool_buffers_devolver(tag);
 
     log_info(logger, "COMMIT_FILE - Procesamiento completamente finalizado");
 }
 
 // READ
 int storage_read_block(storage_t* storage, const char* filename, const char* tag, size_t block_num, void* buffer, size_t buffer_size) {
-    pthread_mutex_lock(&storage->mutex);
+    // Los retardos simulan el dispositivo y van fuera del lock del FS: así las
+    // lecturas en paralelo de uno o varios Workers se solapan
     apply_operation_delay(storage);
+    pthread_mutex_lock(&storage->mutex);
     
     log_info(logger, "READ_BLOCK: Leyendo bloque %zu de %s:%s", block_num, filename, tag);
     
@@ -3165,80 +3554,70 @@ int storage_read_block(storage_t* storage, const char* filename, const char* tag
     
     free(block_path);
     list_destroy(blocks);
+    pthread_mutex_unlock(&storage->mutex);
     
     apply_block_access_delay(storage, 1);
     
     if (bytes_read < 0) {
         log_error(logger, "READ_BLOCK: Error al leer bloque: %s", strerror(errno));
-        pthread_mutex_unlock(&storage->mutex);
         return -1;
     }
     
     log_info(logger, "READ_BLOCK: Lectura completada del bloque %zu de %s:%s", 
              block_num, filename, tag);
     
-    pthread_mutex_unlock(&storage->mutex);
     return 0; // Éxito
 }
 
-void manejar_read_page(int socket_cliente, uint32_t query_id) {
-    log_info(logger, "Manejando READ_PAGE");
-    
+// Lee el cuerpo de un OP_READ: [file_tag][nro de página]. Devuelve NULL si la
+// conexión se cortó.
+char* recibir_pedido_lectura(t_lector_tramas* lector, uint32_t* pagina) {
     // Recibir file_tag completo (filename:tag)
-    char* file_tag = recibir_string_del_worker(socket_cliente);
+    char* file_tag = recibir_string_del_worker(lector);
     if (!file_tag) {
         log_error(logger, "Error al recibir file_tag en READ");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
-        return;
+        return NULL;
     }
 
     log_info(logger, "READ_PAGE - file_tag recibido: %s", file_tag);
     
     // Recibir número de página
-    uint32_t pagina_network;
-    ssize_t bytes_recv = recv(socket_cliente, &pagina_network, sizeof(uint32_t), MSG_WAITALL);
-    if (bytes_recv <= 0) {
+    if (!lector_leer_uint32_red(lector, pagina)) {
         log_error(logger, "Error al recibir número de página");
-        free(file_tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
-        return;
+        pool_buffers_devolver(file_tag);
+        return NULL;
     }
-    uint32_t pagina = ntohl(pagina_network);
-    
+    return file_tag;
+}
+
+// Se ejecuta con la conexión ya rearmada: puede correr en paralelo con otras
+// lecturas del mismo Worker. Libera file_tag.
+void manejar_read_page(t_pedido_storage* pedido, char* file_tag, uint32_t pagina) {
+    uint32_t query_id = pedido->query_id;
+
+    log_info(logger, "Manejando READ_PAGE");
     log_info(logger, "READ PAGE solicitado: %s, página %u", file_tag, pagina);
     
-    // Parsear file_tag
-    char* filename = NULL;
-    char* tag = NULL;
+    // Parsear file_tag sobre el mismo buffer: filename y tag no se copian
+    const char* filename = file_tag;
+    const char* tag = "BASE";
     char* separador = strchr(file_tag, ':');
     
     if (separador) {
         *separador = '\0';
-        filename = strdup(file_tag);
-        tag = strdup(separador + 1);
-        
-        if (strlen(tag) == 0) {
-            free(tag);
-            tag = strdup("BASE");
+        if (strlen(separador + 1) > 0) {
+            tag = separador + 1;
         }
-    } else {
-        filename = strdup(file_tag);
-        tag = strdup("BASE");
     }
     
     log_info(logger, "READ_PAGE parseado: filename='%s', tag='%s'", filename, tag);
     
-    // Allocar buffer con el tamaño REAL del bloque del Storage
-    void* buffer = malloc(global_storage->block_size);
+    // Buffer de página del pool, con el tamaño REAL del bloque del Storage
+    void* buffer = pool_buffers_obtener(global_storage->block_size);
     if (!buffer) {
         log_error(logger, "Error al allocar buffer para lectura");
-        free(filename);
-        free(tag);
-        free(file_tag);
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        pool_buffers_devolver(file_tag);
+        responder_error(pedido);
         return;
     }
     
@@ -3254,69 +3633,24 @@ void manejar_read_page(int socket_cliente, uint32_t query_id) {
         // CASO ESPECIAL: Bloque fuera de límites - ENVIAR BLOQUE VACÍO
         logging_bloque_logico_leido(query_id, filename, tag, pagina);
         
-        // Enviar respuesta exitosa con bloque vacío
-        enviar_ok(socket_cliente);
-        
-        // Enviar el tamaño CORRECTO del bloque (16 bytes)
-        uint32_t size = global_storage->block_size; // Esto debería ser 16
-        uint32_t size_network = htonl(size);
-        
-        log_info(logger, "Enviando tamaño de bloque: %u bytes", size);
-        ssize_t sent_bytes = send(socket_cliente, &size_network, sizeof(uint32_t), MSG_NOSIGNAL);
-        
-        if (sent_bytes <= 0) {
-            log_error(logger, "Error al enviar tamaño del bloque");
-        } else {
-            log_info(logger, "Tamaño enviado: %zd bytes", sent_bytes);
-        }
-        
-        // Enviar exactamente 'size' bytes de datos
-        sent_bytes = send(socket_cliente, buffer, size, MSG_NOSIGNAL);
-        
-        if (sent_bytes != (ssize_t)size) {
-            log_error(logger, "Error al enviar datos del bloque: %zd de %u bytes enviados", 
-                     sent_bytes, size);
-        } else {
-            log_info(logger, "Bloque vacío enviado exitosamente: %u bytes", size);
-        }
+        // Respuesta exitosa con el bloque en ceros (tamaño completo de bloque)
+        responder_pedido(pedido, OP_OK, buffer, global_storage->block_size);
+        log_info(logger, "Bloque vacío enviado: %zu bytes", global_storage->block_size);
         
     } else if (result != 0) {
-        // ... manejo de error ...
+        // Siempre responder: el Worker puede tener varios pedidos de página en vuelo
+        log_error(logger, "READ_PAGE falló para %s:%s, página %u", filename, tag, pagina);
+        responder_error(pedido);
     } else {
-        // ÉXITO - ENVIAR BLOQUE NORMAL (también corregir aquí)
+        // ÉXITO - ENVIAR BLOQUE NORMAL
         log_info(logger, "Bloque %u de %s:%s leído exitosamente", pagina, filename, tag);
         
-        // Enviar respuesta exitosa
-        enviar_ok(socket_cliente);
-        
-        // Enviar tamaño CORRECTO
-        uint32_t size = global_storage->block_size; // 16 bytes
-        uint32_t size_network = htonl(size);
-        
-        log_info(logger, "Enviando tamaño de bloque: %u bytes", size);
-        ssize_t bytes_sent = send(socket_cliente, &size_network, sizeof(uint32_t), MSG_NOSIGNAL);
-        
-        if (bytes_sent <= 0) {
-            log_error(logger, "Error al enviar tamaño del buffer");
-        } else {
-            log_info(logger, "Tamaño del buffer enviado: %u bytes", size);
-        }
-        
-        // Enviar exactamente 'size' bytes
-        bytes_sent = send(socket_cliente, buffer, size, MSG_NOSIGNAL);
-        
-        if (bytes_sent != (ssize_t)size) {
-            log_error(logger, "Error al enviar datos del bloque: %zd de %u bytes", 
-                     bytes_sent, size);
-        } else {
-            log_info(logger, "Datos del bloque enviados exitosamente: %zd bytes", bytes_sent);
-        }
+        responder_pedido(pedido, OP_OK, buffer, global_storage->block_size);
+        log_info(logger, "Datos del bloque enviados: %zu bytes", global_storage->block_size);
     }
     
-    free(buffer);
-    free(filename);
-    free(tag);
-    free(file_tag);
+    pool_buffers_devolver(buffer);
+    pool_buffers_devolver(file_tag);
 
     log_info(logger, "READ_PAGE - Procesamiento completamente finalizado para página: %u", pagina);
 }
@@ -3584,27 +3918,27 @@ int storage_tag_file(storage_t* storage, const char* filename, const char* sourc
     return 0;
 }
 
-void manejar_tag_file(int socket_cliente, uint32_t query_id) {
+void manejar_tag_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "Manejando TAG_FILE");
     
     // Recibir origen (formato: filename:tag)
-    char* origen = recibir_string_del_worker(socket_cliente);
+    char* origen = recibir_string_del_worker(lector);
     if (!origen) {
         log_error(logger, "Error al recibir origen en TAG_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     log_info(logger, "TAG_FILE - Origen recibido: %s", origen);
     
     // Recibir destino (formato: filename:tag o solo tag)
-    char* destino = recibir_string_del_worker(socket_cliente);
+    char* destino = recibir_string_del_worker(lector);
     if (!destino) {
-        free(origen);
+        pool_buffers_devolver(origen);
         log_error(logger, "Error al recibir destino en TAG_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
@@ -3652,11 +3986,10 @@ void manejar_tag_file(int socket_cliente, uint32_t query_id) {
         free(source_tag);
         free(filename_destino);
         free(dest_tag);
-        free(origen);
-        free(destino);
+        pool_buffers_devolver(origen);
+        pool_buffers_devolver(destino);
         
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
     
@@ -3668,17 +4001,16 @@ void manejar_tag_file(int socket_cliente, uint32_t query_id) {
     free(source_tag);
     free(filename_destino);
     free(dest_tag);
-    free(origen);
-    free(destino);
+    pool_buffers_devolver(origen);
+    pool_buffers_devolver(destino);
     
     // Enviar respuesta
     if (result == 0) {
         logging_tag_creado(query_id, filename_origen, dest_tag);
         
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
     }
 
     log_info(logger, "TAG_FILE - Procesamiento completamente finalizado");
@@ -3805,39 +4137,33 @@ int storage_delete_tag(storage_t* storage, const char* filename, const char* tag
     return 0;
 }
 
-void manejar_delete_file(int socket_cliente, uint32_t query_id) {
+void manejar_delete_file(t_pedido_storage* pedido) {
+    t_lector_tramas* lector = pedido->worker->lector;
+    uint32_t query_id = pedido->query_id;
     log_info(logger, "Manejando DELETE_FILE");
     
     // Recibir file_tag completo (formato: filename:tag)
-    char* file_tag = recibir_string_del_worker(socket_cliente);
+    char* file_tag = recibir_string_del_worker(lector);
     if (!file_tag) {
         log_error(logger, "Error al recibir file_tag en DELETE_FILE");
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
         return;
     }
 
     log_info(logger, "DELETE_FILE - file_tag recibido: %s", file_tag);
     
-    // Parsear file_tag en filename y tag
-    char* filename = NULL;
-    char* tag = NULL;
+    // Parsear file_tag en filename y tag (sobre el mismo buffer)
+    const char* filename = file_tag;
+    const char* tag = "BASE";
     char* separador = strchr(file_tag, ':');
     
     if (separador) {
         *separador = '\0';
-        filename = strdup(file_tag);
-        tag = strdup(separador + 1);
         
-        // Validar que el tag no esté vacío
-        if (strlen(tag) == 0) {
-            free(tag);
-            tag = strdup("BASE");
+        // Si el tag está vacío se usa BASE
+        if (strlen(separador + 1) > 0) {
+            tag = separador + 1;
         }
-    } else {
-        // Si no hay ':', usar el string completo como filename y tag por defecto
-        filename = strdup(file_tag);
-        tag = strdup("BASE");
     }
     
     log_info(logger, "DELETE_FILE parseado: filename='%s', tag='%s'", filename, tag);
@@ -3846,19 +4172,16 @@ void manejar_delete_file(int socket_cliente, uint32_t query_id) {
     int result = storage_delete_tag(global_storage, filename, tag, query_id);
     
     // Liberar memoria
-    free(filename);
-    free(tag);
-    free(file_tag);
+    pool_buffers_devolver(file_tag);
     
     // Enviar respuesta
     if (result == 0) {
         // ✅ AGREGAR LOG OBLIGATORIO
         logging_tag_eliminado(query_id, filename, tag);
         
-        enviar_ok(socket_cliente);
+        responder_ok(pedido);
     } else {
-        int error = htonl(OP_ERROR);
-        send(socket_cliente, &error, sizeof(int), MSG_NOSIGNAL);
+        responder_error(pedido);
     }
 
     log_info(logger, "DELETE_FILE - Procesamiento completamente finalizado");
@@ -25,6 +25,7 @@
 #include <sys/mman.h>
 #include <sys/types.h>	 	// ssize_t
 #include <sys/socket.h>     // socket, bind, listen, connect, setsockopt
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <netdb.h>          // struct addrinfo, getaddrinfo
 #include <string.h>         // memset, strerror
@@ -35,7 +36,6 @@
 #include <dirent.h>
 
 #include <errno.h>          // errno
-#include <limits.h>
 #include <arpa/inet.h>
 #include <linux/limits.h>
 #include <sys/time.h>
@@ -50,6 +50,10 @@
 #define ERROR -1
 #define MAX_PATH_LENGTH 8192
 
+// Query Control -> Master: un tam_path 0 indica que sigue un lote de queries
+// [0][size][cantidad][[tam_path][path][prioridad]]... en network byte order
+#define MARCA_LOTE_QUERIES 0
+
 #define PORT 4444
 #define MAX_CLIENTS 10
 
@@ -193,12 +197,17 @@ typedef enum
     OP_ERROR = 211,
 
     RESULTADO_READ = 212,
-    OP_PROGRAM_COUNTER = 300,
+    OP_WRITE_VECTORIAL = 213,       // Varios WRITE al mismo File:Tag en un solo pedido
     MENSAJE_LECTURA = 303,
     QUERY_FINALIZADA = 304,
     DESALOJAR_QUERY = 305,
     EJECUTAR_QUERY = 306,
     ERROR_EJECUCION = 307,
+    METRICAS_MEMORIA = 308,
+    RESULTADO_READ_PARCIAL = 309,   // Un tramo de un READ: Worker -> Master -> Query Control
+    QUERIES_ADMITIDAS = 310,        // Ids asignados a un lote de queries: Master -> Query Control
+    PAUSAR_LECTURA = 311,           // [query_id]: su Query Control no consume el READ, Master -> Worker
+    REANUDAR_LECTURA = 312,         // [query_id]: el Query Control vació su cola, Master -> Worker
     
     //Identificadores de módulos
     MENSAJE = 10,
@@ -226,6 +235,27 @@ typedef struct
 	void* stream;
 } t_buffer;
 
+// Encabezado de todo pedido del Worker al Storage, seguido de tam_payload bytes
+// con el cuerpo de la operación (enteros en network byte order). Lleva la query
+// y el PC de la instrucción que lo origina.
+typedef struct {
+    int32_t op;
+    uint32_t query_id;
+    uint32_t pc;
+    uint32_t id_pedido;
+    uint32_t tam_payload;
+} t_encabezado_pedido_storage;
+
+// Respuesta del Storage a un pedido del Worker, seguida de tam_payload bytes
+// (enteros en network byte order). id_pedido es el del pedido que se responde:
+// permite tener varios pedidos en vuelo y que el Storage los responda en
+// cualquier orden.
+typedef struct {
+    int32_t estado;        // OP_OK u OP_ERROR
+    uint32_t id_pedido;
+    uint32_t tam_payload;
+} t_encabezado_respuesta_storage;
+
 
 typedef struct
 {
@@ -246,6 +276,16 @@ typedef struct {
     int escrituras_storage;
 } t_metricas_proceso;
 
+// Métricas de la memoria interna del Worker (se envían al Master con METRICAS_MEMORIA)
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t precargas;          // Páginas traídas por prefetch
+    uint64_t desalojos;
+    uint64_t escrituras;         // WRITE aplicados en el Storage (van directo, no hay páginas sucias)
+    uint64_t bytes_escritos;     // Bytes de esos WRITE
+} t_metricas_memoria;
+
 // Estructura para proceso
 typedef struct {
     int pid;
@@ -0,0 +1,25 @@
+#ifndef POOL_BUFFERS_H_
+#define POOL_BUFFERS_H_
+
+#include "conexion.h"
+
+// POOL DE BUFFERS
+// Cada hilo guarda los buffers que devuelve y los reusa en el próximo mensaje,
+// en vez de hacer malloc/free por pedido. Hay tres clases: strings chicos,
+// páginas (BLOCK_SIZE) y resultados grandes.
+typedef enum {
+    BUFFER_STRING,
+    BUFFER_PAGINA,
+    BUFFER_GRANDE,
+    CANT_CLASES_BUFFER
+} t_clase_buffer;
+
+// Se llama una vez al arrancar, cuando se conoce el BLOCK_SIZE
+void pool_buffers_configurar_pagina(uint32_t tam_pagina);
+
+// Los buffers del pool se liberan con pool_buffers_devolver, nunca con free
+void* pool_buffers_obtener(size_t tam);
+void pool_buffers_devolver(void* buffer);
+uint32_t pool_buffers_capacidad(void* buffer);
+
+#endif /* POOL_BUFFERS_H_ */
@@ -0,0 +1,99 @@
+#ifndef TRAMA_H_
+#define TRAMA_H_
+
+#include "conexion.h"
+
+// ARMADO DE MENSAJES
+// El mensaje se arma en un buffer reutilizable; los datos grandes pueden
+// referenciarse sin copiarlos. Todo sale con un único sendmsg.
+typedef struct {
+    bool externo;             // true: memoria del llamador; false: parte de trama->datos
+    uint32_t desplazamiento;  // Posición en trama->datos (segmentos propios)
+    const void* puntero;      // Memoria del llamador (segmentos externos)
+    uint32_t tam;
+} t_segmento_trama;
+
+typedef struct {
+    char* datos;
+    uint32_t tam;
+    uint32_t capacidad;
+    t_segmento_trama* segmentos;
+    int cant_segmentos;
+    int capacidad_segmentos;
+    uint32_t tam_total;           // Bytes a enviar (propios + referenciados)
+    uint32_t inicio_paquete;      // Dónde quedó el [cod_op][size] del paquete abierto
+    uint32_t total_inicio_paquete;
+} t_trama;
+
+t_trama* trama_crear(uint32_t capacidad);
+void trama_reiniciar(t_trama* trama);
+void trama_destruir(t_trama* trama);
+uint32_t trama_tamanio(t_trama* trama);
+
+uint32_t trama_reservar(t_trama* trama, uint32_t tam);
+void trama_escribir(t_trama* trama, uint32_t desplazamiento, const void* datos, uint32_t tam);
+void trama_agregar(t_trama* trama, const void* datos, uint32_t tam);
+void trama_agregar_referencia(t_trama* trama, const void* datos, uint32_t tam);
+void trama_agregar_uint32_red(t_trama* trama, uint32_t valor);
+void trama_agregar_string_red(t_trama* trama, const char* str);
+
+bool trama_enviar(t_trama* trama, int socket);
+bool enviar_iovec(int socket, struct iovec* iov, int cant);
+
+// Formato t_paquete: [cod_op][size][[tam][valor]...] en host order
+void trama_iniciar_paquete(t_trama* trama, int cod_op);
+void trama_agregar_a_paquete(t_trama* trama, const void* valor, int tam);
+void trama_referenciar_en_paquete(t_trama* trama, const void* valor, int tam);
+void trama_cerrar_paquete(t_trama* trama);
+
+// Lectura de t_paquete sin copias: cada campo apunta al buffer recibido y vale
+// mientras ese buffer no se libere ni se reuse (el mensaje que se está atendiendo).
+#define PAQUETE_MAX_CAMPOS 16
+
+typedef struct {
+    const char* datos;
+    int tam;
+} t_campo_paquete;
+
+typedef struct {
+    const char* actual;
+    const char* fin;
+} t_cursor_paquete;
+
+typedef struct {
+    t_campo_paquete campos[PAQUETE_MAX_CAMPOS];
+    int cantidad;
+    t_cursor_paquete resto;   // Campos que no entraron en 'campos' (listas largas)
+} t_vista_paquete;
+
+void cursor_paquete_iniciar(t_cursor_paquete* cursor, const void* buffer, uint32_t size);
+bool cursor_paquete_siguiente(t_cursor_paquete* cursor, t_campo_paquete* campo);
+bool paquete_decodificar_vista(const void* buffer, uint32_t size, t_vista_paquete* vista);
+bool campo_leer_uint32(const t_campo_paquete* campo, uint32_t* valor);
+const char* campo_string(const t_campo_paquete* campo);
+
+// LECTURA DE TRAMAS
+// Buffer de recepción por conexión: cada recv trae todo lo disponible y los
+// campos se van tomando de memoria.
+typedef struct {
+    int socket;
+    char* datos;
+    uint32_t inicio;      // Primer byte sin consumir
+    uint32_t fin;         // Fin de lo recibido
+    uint32_t capacidad;
+} t_lector_tramas;
+
+t_lector_tramas* lector_crear(int socket, uint32_t capacidad);
+void lector_destruir(t_lector_tramas* lector);
+uint32_t lector_pendientes(t_lector_tramas* lector);
+int lector_recibir_disponible(t_lector_tramas* lector, uint32_t tam);
+const void* lector_ver_recibido(t_lector_tramas* lector, uint32_t tam);
+
+void* lector_ver(t_lector_tramas* lector, uint32_t tam);
+void lector_consumir(t_lector_tramas* lector, uint32_t tam);
+bool lector_leer(t_lector_tramas* lector, void* destino, uint32_t tam);
+bool lector_leer_uint32_red(t_lector_tramas* lector, uint32_t* valor);
+char* lector_leer_string_red(t_lector_tramas* lector);
+bool lector_descartar(t_lector_tramas* lector, uint32_t tam);
+
+#endif /* TRAMA_H_ */
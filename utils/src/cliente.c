@@ -1,5 +1,6 @@
 
 #include "cliente.h"
+#include "trama.h"
 
 
 void saludar(char* quien) {
@@ -124,34 +125,24 @@ void enviar_paquete(t_paquete* paquete, int socket_cliente) {
         return;
     }
     
-    // 1. Enviar código de operación
-    ssize_t bytes_enviados = send(socket_cliente, &(paquete->codigo_operacion), sizeof(int), 0);
-    if (bytes_enviados != sizeof(int)) {
-        if (logger) log_error(logger, "Error al enviar código de operación. Enviados: %zd, esperados: %zu", bytes_enviados, sizeof(int));
+    if (paquete->buffer->size > 0 && paquete->buffer->stream == NULL) {
+        if (logger) log_error(logger, "Error: stream es NULL pero size > 0");
         return;
     }
-    
-    // 2. Enviar tamaño del buffer
-    bytes_enviados = send(socket_cliente, &(paquete->buffer->size), sizeof(int), 0);
-    if (bytes_enviados != sizeof(int)) {
-        if (logger) log_error(logger, "Error al enviar tamaño del buffer. Enviados: %zd, esperados: %zu", bytes_enviados, sizeof(int));
+
+    // [cod_op][size][stream] en un solo envío
+    int encabezado[2] = { paquete->codigo_operacion, paquete->buffer->size };
+    struct iovec iov[2] = {
+        { .iov_base = encabezado, .iov_len = sizeof(encabezado) },
+        { .iov_base = paquete->buffer->stream, .iov_len = paquete->buffer->size }
+    };
+
+    if (!enviar_iovec(socket_cliente, iov, paquete->buffer->size > 0 ? 2 : 1)) {
+        if (logger) log_error(logger, "Error al enviar paquete. Cod OP: %d, Tamaño: %d bytes: %s",
+                              paquete->codigo_operacion, paquete->buffer->size, strerror(errno));
         return;
     }
     
-    // 3. Enviar contenido del buffer (si tiene datos)
-    if (paquete->buffer->size > 0) {
-        if (paquete->buffer->stream == NULL) {
-            if (logger) log_error(logger, "Error: stream es NULL pero size > 0");
-            return;
-        }
-        
-        bytes_enviados = send(socket_cliente, paquete->buffer->stream, paquete->buffer->size, 0);
-        if (bytes_enviados != paquete->buffer->size) {
-            if (logger) log_error(logger, "Error al enviar contenido del buffer. Enviados: %zd, esperados: %d", bytes_enviados, paquete->buffer->size);
-            return;
-        }
-    }
-    
     if (logger) {
         log_info(logger, "Paquete enviado exitosamente - Cod OP: %d, Tamaño: %d bytes", paquete->codigo_operacion, paquete->buffer->size);
     }
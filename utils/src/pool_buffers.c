@@ -0,0 +1,130 @@
+#include "pool_buffers.h"
+
+#define POOL_TAM_STRING 256
+#define POOL_TAM_PAGINA_DEFECTO 4096
+#define POOL_MAX_LIBRES 32           // Buffers guardados por clase y por hilo
+#define POOL_MAX_LIBRES_GRANDES 4
+
+typedef struct t_encabezado_buffer {
+    struct t_encabezado_buffer* siguiente;   // Solo mientras está en la lista de libres
+    uint32_t clase;
+    uint32_t capacidad;
+} t_encabezado_buffer;
+
+// Los datos quedan alineados igual que con malloc
+#define TAM_ENCABEZADO ((sizeof(t_encabezado_buffer) + 15) & ~(size_t)15)
+
+typedef struct {
+    t_encabezado_buffer* libres[CANT_CLASES_BUFFER];
+    uint32_t cantidad[CANT_CLASES_BUFFER];
+} t_cache_buffers;
+
+static uint32_t tam_pagina = POOL_TAM_PAGINA_DEFECTO;
+static pthread_key_t clave_cache;
+static pthread_once_t clave_creada = PTHREAD_ONCE_INIT;
+
+// Al terminar un hilo se liberan los buffers que tenía guardados
+static void destruir_cache(void* elemento) {
+    t_cache_buffers* cache = elemento;
+    for (int clase = 0; clase < CANT_CLASES_BUFFER; clase++) {
+        while (cache->libres[clase]) {
+            t_encabezado_buffer* encabezado = cache->libres[clase];
+            cache->libres[clase] = encabezado->siguiente;
+            free(encabezado);
+        }
+    }
+    free(cache);
+}
+
+static void crear_clave_cache(void) {
+    pthread_key_create(&clave_cache, destruir_cache);
+}
+
+static t_cache_buffers* cache_del_hilo(void) {
+    pthread_once(&clave_creada, crear_clave_cache);
+
+    t_cache_buffers* cache = pthread_getspecific(clave_cache);
+    if (!cache) {
+        cache = calloc(1, sizeof(t_cache_buffers));
+        pthread_setspecific(clave_cache, cache);
+    }
+    return cache;
+}
+
+static t_encabezado_buffer* encabezado_de(void* buffer) {
+    return (t_encabezado_buffer*)((char*)buffer - TAM_ENCABEZADO);
+}
+
+static void* datos_de(t_encabezado_buffer* encabezado) {
+    return (char*)encabezado + TAM_ENCABEZADO;
+}
+
+static t_clase_buffer clase_para(size_t tam) {
+    if (tam <= POOL_TAM_STRING) return BUFFER_STRING;
+    if (tam <= tam_pagina) return BUFFER_PAGINA;
+    return BUFFER_GRANDE;
+}
+
+static size_t capacidad_para(t_clase_buffer clase, size_t tam) {
+    switch (clase) {
+        case BUFFER_STRING: return POOL_TAM_STRING;
+        case BUFFER_PAGINA: return tam_pagina;
+        default: {
+            // Potencias de dos: un resultado grande sirve para los siguientes parecidos
+            size_t capacidad = (size_t)tam_pagina * 2;
+            while (capacidad < tam) capacidad *= 2;
+            return capacidad;
+        }
+    }
+}
+
+void pool_buffers_configurar_pagina(uint32_t tam) {
+    if (tam > POOL_TAM_STRING) tam_pagina = tam;
+}
+
+void* pool_buffers_obtener(size_t tam) {
+    t_clase_buffer clase = clase_para(tam);
+    t_cache_buffers* cache = cache_del_hilo();
+
+    // Primer buffer libre que alcance (en las clases fijas es siempre el primero)
+    t_encabezado_buffer** anterior = cache ? &cache->libres[clase] : NULL;
+    for (t_encabezado_buffer* encabezado = anterior ? *anterior : NULL; encabezado; encabezado = encabezado->siguiente) {
+        if (encabezado->capacidad >= tam) {
+            *anterior = encabezado->siguiente;
+            cache->cantidad[clase]--;
+            return datos_de(encabezado);
+        }
+        anterior = &encabezado->siguiente;
+    }
+
+    size_t capacidad = capacidad_para(clase, tam);
+    t_encabezado_buffer* encabezado = malloc(TAM_ENCABEZADO + capacidad);
+    if (!encabezado) return NULL;
+
+    encabezado->siguiente = NULL;
+    encabezado->clase = clase;
+    encabezado->capacidad = capacidad;
+    return datos_de(encabezado);
+}
+
+// Puede devolverlo otro hilo: queda guardado en el de quien lo devuelve
+void pool_buffers_devolver(void* buffer) {
+    if (!buffer) return;
+
+    t_encabezado_buffer* encabezado = encabezado_de(buffer);
+    t_cache_buffers* cache = cache_del_hilo();
+    uint32_t maximo = encabezado->clase == BUFFER_GRANDE ? POOL_MAX_LIBRES_GRANDES : POOL_MAX_LIBRES;
+
+    if (!cache || cache->cantidad[encabezado->clase] >= maximo) {
+        free(encabezado);
+        return;
+    }
+
+    encabezado->siguiente = cache->libres[encabezado->clase];
+    cache->libres[encabezado->clase] = encabezado;
+    cache->cantidad[encabezado->clase]++;
+}
+
+uint32_t pool_buffers_capacidad(void* buffer) {
+    return encabezado_de(buffer)->capacidad;
+}
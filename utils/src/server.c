@@ -130,8 +130,8 @@ void* recibir_buffer(int* size, int socket_cliente) {
         return NULL;
     }
 
-    // Asignar memoria con verificación adicional
-    void* buffer = malloc(*size);
+    // Buffer del pool: el llamador lo devuelve con pool_buffers_devolver
+    void* buffer = pool_buffers_obtener(*size);
     if (buffer == NULL) {
         log_error(logger, "Error al asignar %d bytes para buffer", *size);
         return NULL;
@@ -141,7 +141,7 @@ void* recibir_buffer(int* size, int socket_cliente) {
     bytes_recibidos = recv(socket_cliente, buffer, *size, MSG_WAITALL);
     if (bytes_recibidos != *size) {
         log_error(logger, "Error al recibir buffer. Esperados: %d, Recibidos: %zd", *size, bytes_recibidos);
-        free(buffer);
+        pool_buffers_devolver(buffer);
         return NULL;
     }
 
@@ -178,226 +178,6 @@ char* recibir_mensaje(t_log* logger, int socket_cliente)
 }
 
 
-// Función específica para recibir paquetes de t_paquete (con código de operación ya leído)
-t_list* recibir_paquete_desde_buffer(t_log* logger, int socket_cliente) {
-    if (socket_cliente <= 0) {
-        if (logger) log_error(logger, "Error: socket inválido: %d", socket_cliente);
-        return NULL;
-    }
-    
-    int buffer_size;
-    
-    // Recibir el tamaño del buffer
-    ssize_t bytes_recibidos = recv(socket_cliente, &buffer_size, sizeof(int), MSG_WAITALL);
-    if (bytes_recibidos != sizeof(int)) {
-        if (logger) log_error(logger, "Error al recibir tamaño del buffer. Recibidos: %zd, esperados: %zu", bytes_recibidos, sizeof(int));
-        return NULL;
-    }
-    
-    if (logger) log_info(logger, "Tamaño de buffer recibido: %d bytes", buffer_size);
-    
-    // Validar que el tamaño sea razonable
-    if (buffer_size <= 0) {
-        if (logger) log_warning(logger, "Paquete vacío recibido (size = %d)", buffer_size);
-        return list_create();
-    }
-    
-    // Validar tamaño máximo (10MB)
-    if (buffer_size > 10 * 1024 * 1024) {
-        if (logger) log_error(logger, "Tamaño de buffer excesivamente grande: %d bytes", buffer_size);
-        return NULL;
-    }
-    
-    // Recibir el contenido del buffer
-    void* buffer = malloc(buffer_size);
-    if (buffer == NULL) {
-        if (logger) log_error(logger, "Error: no se pudo allocar memoria para el buffer de %d bytes", buffer_size);
-        return NULL;
-    }
-    
-    bytes_recibidos = recv(socket_cliente, buffer, buffer_size, MSG_WAITALL);
-    if (bytes_recibidos != buffer_size) {
-        if (logger) log_error(logger, "Error al recibir contenido del buffer. Recibidos: %zd, esperados: %d", bytes_recibidos, buffer_size);
-        free(buffer);
-        return NULL;
-    }
-    
-    if (logger) log_info(logger, "Buffer recibido correctamente (%d bytes)", buffer_size);
-    
-    // Deserializar el buffer en una lista
-    t_list* valores = list_create();
-    int desplazamiento = 0;
-    
-    while (desplazamiento < buffer_size) {
-        // Verificar que hay espacio suficiente para el tamaño del elemento
-        if (desplazamiento + sizeof(int) > (size_t)buffer_size) {
-            if (logger) log_error(logger, "Error: buffer corrupto al leer tamaño del elemento en desplazamiento %d", desplazamiento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        // Leer el tamaño del siguiente elemento
-        int tamanio_elemento;
-        memcpy(&tamanio_elemento, buffer + desplazamiento, sizeof(int));
-        desplazamiento += sizeof(int);
-        
-        if (logger) log_debug(logger, "Tamaño del elemento: %d", tamanio_elemento);
-        
-        // Validar tamaño del elemento
-        if (tamanio_elemento <= 0 || tamanio_elemento > 1024) { // Máximo 1KB por elemento
-            if (logger) log_error(logger, "Error: tamaño de elemento inválido: %d", tamanio_elemento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        if (desplazamiento + tamanio_elemento > buffer_size) {
-            if (logger) log_error(logger, "Error: tamaño de elemento excede el buffer. Elemento: %d, Disponible: %d", 
-                                 tamanio_elemento, buffer_size - desplazamiento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        // Leer el contenido del elemento
-        char* elemento = malloc(tamanio_elemento);
-        if (elemento == NULL) {
-            if (logger) log_error(logger, "Error: no se pudo allocar memoria para elemento de %d bytes", tamanio_elemento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        memcpy(elemento, buffer + desplazamiento, tamanio_elemento);
-        desplazamiento += tamanio_elemento;
-        
-        // Agregar a la lista
-        list_add(valores, elemento);
-        
-        if (logger) log_debug(logger, "Elemento %d agregado a la lista", list_size(valores));
-    }
-    
-    free(buffer);
-    
-    if (logger) {
-        log_info(logger, "Paquete deserializado exitosamente - %d elementos, tamaño total: %d bytes", 
-                list_size(valores), buffer_size);
-    }
-    
-    return valores;
-}
-
-
-t_list* recibir_paquete(t_log* logger, int socket_cliente) {
-    if (socket_cliente <= 0) {
-        if (logger) log_error(logger, "Error: socket inválido: %d", socket_cliente);
-        return NULL;
-    }
-    
-    int size;
-
-    // Recibir el tamaño del buffer (se envía como int en crear_paquete/enviar_paquete)
-    ssize_t bytes_recibidos = recv(socket_cliente, &size, sizeof(int), MSG_WAITALL);
-    if (bytes_recibidos != sizeof(int)) {
-        if (logger) log_error(logger, "Error al recibir tamaño del buffer. Recibidos: %zd, esperados: %zu", bytes_recibidos, sizeof(int));
-        return NULL;
-    }
-
-    if (logger) log_info(logger, "Tamaño de buffer recibido: %d bytes", size);
-
-    // Validar que el tamaño sea razonable
-    if (size <= 0) {
-        if (logger) log_warning(logger, "Paquete vacío recibido (size = %d)", size);
-        return list_create();
-    }
-
-    // Validar tamaño máximo (10MB)
-    if (size > 10 * 1024 * 1024) {
-        if (logger) log_error(logger, "Tamaño de buffer excesivamente grande: %d bytes", size);
-        return NULL;
-    }
-
-    // Recibir el contenido del buffer
-    void* buffer = malloc(size);
-    if (buffer == NULL) {
-        if (logger) log_error(logger, "Error: no se pudo allocar memoria para el buffer de %d bytes", size);
-        return NULL;
-    }
-
-    bytes_recibidos = recv(socket_cliente, buffer, size, MSG_WAITALL);
-    if (bytes_recibidos != (ssize_t)size) {
-        if (logger) log_error(logger, "Error al recibir contenido del buffer. Recibidos: %zd, esperados: %d", bytes_recibidos, size);
-        free(buffer);
-        return NULL;
-    }
-
-    if (logger) log_info(logger, "Buffer recibido correctamente (%d bytes)", size);
-    
-    // Deserializar el buffer en una lista
-    t_list* valores = list_create();
-    size_t desplazamiento = 0;
-    
-    while (desplazamiento < (size_t)size) {
-        // Verificar que hay espacio suficiente para el tamaño del elemento
-        if (desplazamiento + sizeof(int) > (size_t)size) {
-            if (logger) log_error(logger, "Error: buffer corrupto al leer tamaño del elemento en desplazamiento %zu", desplazamiento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        // Leer el tamaño del siguiente elemento
-        int tamanio_elemento;
-        memcpy(&tamanio_elemento, buffer + desplazamiento, sizeof(int));
-        desplazamiento += sizeof(int);
-        
-        if (logger) log_debug(logger, "Tamaño del elemento: %d", tamanio_elemento);
-        
-        // Validar tamaño del elemento
-        if (tamanio_elemento <= 0 || tamanio_elemento > 1024) { // Máximo 1KB por elemento
-            if (logger) log_error(logger, "Error: tamaño de elemento inválido: %d", tamanio_elemento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        if (desplazamiento + (size_t)tamanio_elemento > (size_t)size) {
-            if (logger) log_error(logger, "Error: tamaño de elemento excede el buffer. Elemento: %d, Disponible: %zu", 
-                                 tamanio_elemento, (size_t)size - desplazamiento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        // Leer el contenido del elemento
-        char* elemento = malloc(tamanio_elemento);
-        if (elemento == NULL) {
-            if (logger) log_error(logger, "Error: no se pudo allocar memoria para elemento de %d bytes", tamanio_elemento);
-            list_destroy_and_destroy_elements(valores, free);
-            free(buffer);
-            return NULL;
-        }
-        
-        memcpy(elemento, buffer + desplazamiento, tamanio_elemento);
-        desplazamiento += tamanio_elemento;
-        
-        // Agregar a la lista
-        list_add(valores, elemento);
-        
-        if (logger) log_debug(logger, "Elemento %d agregado a la lista", list_size(valores));
-    }
-    
-    free(buffer);
-    
-    if (logger) {
-        log_info(logger, "Paquete deserializado exitosamente - %d elementos, tamaño total: %d bytes", 
-                list_size(valores), size);
-    }
-    
-    return valores;
-}
-
 void* recibir_contenido_paquete(int* size, int socket_cliente) {
     if (size == NULL || socket_cliente < 0) {
         log_error(logger, "Parámetros inválidos en recibir_contenido_paquete");
@@ -691,7 +471,8 @@ char* recibir_string(int socket_cliente, t_log* logger) {
         return NULL;
     }
 
-    char* buffer = malloc(size + 1);
+    // String del pool: se devuelve con pool_buffers_devolver
+    char* buffer = pool_buffers_obtener(size + 1);
     if (!buffer) {
         if (logger) log_error(logger, "Error al asignar memoria para string de %d bytes", size);
         return NULL;
@@ -700,7 +481,7 @@ char* recibir_string(int socket_cliente, t_log* logger) {
     bytes_recibidos = recv(socket_cliente, buffer, size, MSG_WAITALL);
     if (bytes_recibidos != size) {
         if (logger) log_error(logger, "Error al recibir string. Recibidos: %zd, esperados: %d", bytes_recibidos, size);
-        free(buffer);
+        pool_buffers_devolver(buffer);
         return NULL;
     }
 
@@ -732,7 +513,7 @@ void* handle_client(void* arg) {
         char* mensaje = recibir_string(socket_cliente, logger);
         if (mensaje) {
             if (logger) log_info(logger, "Procesando mensaje del cliente: %s", mensaje);
-            free(mensaje);
+            pool_buffers_devolver(mensaje);
         } else {
             if (logger) log_warning(logger, "No se pudo recibir mensaje del cliente.");
         }
@@ -762,19 +543,6 @@ void enviar_error(int socket_cliente) {
     log_info(logger, "OP_ERROR enviado exitosamente (valor: %d)", OP_ERROR);
 }
 
-char* recibir_mensaje_error(int socket) {
-    t_list* elementos = recibir_paquete(logger, socket);
-    
-    if (elementos == NULL || list_size(elementos) == 0) {
-        return strdup("Error desconocido");
-    }
-    
-    char* mensaje = strdup((char*)list_get(elementos, 0));
-    list_destroy_and_destroy_elements(elementos, free);
-    
-    return mensaje;
-}
-
 void debug_recibir_tamaño_buffer(t_log* logger, int socket_qc) {
     // Leer los primeros 8 bytes crudos del socket
     unsigned char buffer_crudo[8];
@@ -797,136 +565,4 @@ void debug_recibir_tamaño_buffer(t_log* logger, int socket_qc) {
         uint32_t tamaño_host = ntohl(tamaño_network);
         log_info(logger, "🔍 DEBUG - Interpretado como uint32_t (ntohl): %u", tamaño_host);
     }
-}
-
-t_list* deserializar_paquete(void* buffer, uint32_t buffer_size, t_log* logger) {
-    if (buffer == NULL || buffer_size == 0) {
-        if (logger) log_error(logger, "Buffer inválido en deserializar_paquete");
-        return NULL;
-    }
-    
-    t_list* elementos = list_create();
-    size_t desplazamiento = 0;
-    
-    while (desplazamiento < buffer_size) {
-        // Verificar que hay espacio suficiente para el tamaño del elemento
-        if (desplazamiento + sizeof(int) > buffer_size) {
-            if (logger) log_error(logger, "Error: buffer corrupto al leer tamaño del elemento en desplazamiento %zu", desplazamiento);
-            list_destroy_and_destroy_elements(elementos, free);
-            return NULL;
-        }
-        
-        // Leer el tamaño del siguiente elemento
-        int tamanio_elemento;
-        memcpy(&tamanio_elemento, (char*)buffer + desplazamiento, sizeof(int));
-        desplazamiento += sizeof(int);
-        
-        if (logger) log_debug(logger, "Tamaño del elemento: %d", tamanio_elemento);
-        
-        // Validar tamaño del elemento
-        if (tamanio_elemento <= 0 || tamanio_elemento > 1024) { // Máximo 1KB por elemento
-            if (logger) log_error(logger, "Error: tamaño de elemento inválido: %d", tamanio_elemento);
-            list_destroy_and_destroy_elements(elementos, free);
-            return NULL;
-        }
-        
-        if (desplazamiento + (size_t)tamanio_elemento > buffer_size) {
-            if (logger) log_error(logger, "Error: tamaño de elemento excede el buffer. Elemento: %d, Disponible: %zu", 
-                                 tamanio_elemento, buffer_size - desplazamiento);
-            list_destroy_and_destroy_elements(elementos, free);
-            return NULL;
-        }
-        
-        // Leer el contenido del elemento
-        char* elemento = malloc(tamanio_elemento);
-        if (elemento == NULL) {
-            if (logger) log_error(logger, "Error: no se pudo allocar memoria para elemento de %d bytes", tamanio_elemento);
-            list_destroy_and_destroy_elements(elementos, free);
-            return NULL;
-        }
-        
-        memcpy(elemento, (char*)buffer + desplazamiento, tamanio_elemento);
-        desplazamiento += tamanio_elemento;
-        
-        // Agregar a la lista
-        list_add(elementos, elemento);
-        
-        if (logger) log_debug(logger, "Elemento %d agregado a la lista", list_size(elementos));
-    }
-    
-    if (logger) {
-        log_info(logger, "Paquete deserializado exitosamente - %d elementos, tamaño total: %u bytes", 
-                list_size(elementos), buffer_size);
-    }
-    
-    return elementos;
-}
-
-t_list* recibir_paquete_mejorado(t_log* logger, int socket_cliente) {
-    if (socket_cliente <= 0) {
-        if (logger) log_error(logger, "Error: socket inválido: %d", socket_cliente);
-        return NULL;
-    }
-    
-    // 1. Recibir tamaño total del buffer
-    uint32_t buffer_size_network;
-    ssize_t bytes_recv = recv(socket_cliente, &buffer_size_network, sizeof(uint32_t), MSG_WAITALL);
-    
-    if (bytes_recv <= 0) {
-        if (bytes_recv == 0) {
-            if (logger) log_warning(logger, "Cliente cerró la conexión");
-        } else {
-            if (logger) log_error(logger, "Error al recibir tamaño del buffer: %s", strerror(errno));
-        }
-        return NULL;
-    }
-    
-    uint32_t buffer_size = ntohl(buffer_size_network);
-    if (logger) log_info(logger, "Tamaño de buffer recibido: %u bytes", buffer_size);
-    
-    // Validar tamaño razonable
-    if (buffer_size == 0) {
-        if (logger) log_warning(logger, "Paquete vacío recibido");
-        return list_create();
-    }
-    
-    if (buffer_size > 1000000) { // 1MB máximo
-        if (logger) log_error(logger, "Tamaño de buffer excesivamente grande: %u bytes", buffer_size);
-        return NULL;
-    }
-    
-    // 2. Recibir buffer completo
-    void* buffer = malloc(buffer_size);
-    if (buffer == NULL) {
-        if (logger) log_error(logger, "Error al allocar %u bytes para buffer", buffer_size);
-        return NULL;
-    }
-    
-    bytes_recv = recv(socket_cliente, buffer, buffer_size, MSG_WAITALL);
-    
-    if (bytes_recv <= 0) {
-        if (logger) log_error(logger, "Error al recibir buffer: %s", strerror(errno));
-        free(buffer);
-        return NULL;
-    }
-    
-    if ((uint32_t)bytes_recv != buffer_size) {
-        if (logger) log_error(logger, "Buffer incompleto: %zd/%u bytes", bytes_recv, buffer_size);
-        free(buffer);
-        return NULL;
-    }
-    
-    if (logger) log_info(logger, "✅ Buffer recibido correctamente (%u bytes)", buffer_size);
-    
-    // 3. Deserializar usando la nueva función
-    t_list* elementos = deserializar_paquete(buffer, buffer_size, logger);
-    free(buffer);
-    
-    if (elementos == NULL) {
-        if (logger) log_error(logger, "❌ Error al deserializar paquete");
-        return NULL;
-    }
-    
-    if (logger) log_info(logger, "✅ Paquete deserializado - %d elementos", list_size(elementos));
-    return elementos;
 }
\ No newline at end of file
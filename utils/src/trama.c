@@ -0,0 +1,368 @@
+#include "trama.h"
+#include <poll.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024                 // Límite de segmentos por sendmsg si el sistema no lo define
+#endif
+
+#define TRAMA_CAPACIDAD_MINIMA 64
+#define TRAMA_SEGMENTOS_INICIALES 8
+
+// ARMADO DE MENSAJES
+
+t_trama* trama_crear(uint32_t capacidad) {
+    t_trama* trama = malloc(sizeof(t_trama));
+    trama->capacidad = capacidad < TRAMA_CAPACIDAD_MINIMA ? TRAMA_CAPACIDAD_MINIMA : capacidad;
+    trama->datos = malloc(trama->capacidad);
+    trama->capacidad_segmentos = TRAMA_SEGMENTOS_INICIALES;
+    trama->segmentos = malloc(trama->capacidad_segmentos * sizeof(t_segmento_trama));
+    trama_reiniciar(trama);
+    return trama;
+}
+
+// Vacía la trama conservando la memoria ya reservada
+void trama_reiniciar(t_trama* trama) {
+    trama->tam = 0;
+    trama->cant_segmentos = 0;
+    trama->tam_total = 0;
+    trama->inicio_paquete = 0;
+    trama->total_inicio_paquete = 0;
+}
+
+void trama_destruir(t_trama* trama) {
+    if (!trama) return;
+    free(trama->datos);
+    free(trama->segmentos);
+    free(trama);
+}
+
+uint32_t trama_tamanio(t_trama* trama) {
+    return trama->tam_total;
+}
+
+static t_segmento_trama* nuevo_segmento(t_trama* trama) {
+    if (trama->cant_segmentos == trama->capacidad_segmentos) {
+        trama->capacidad_segmentos *= 2;
+        trama->segmentos = realloc(trama->segmentos, trama->capacidad_segmentos * sizeof(t_segmento_trama));
+    }
+    return &trama->segmentos[trama->cant_segmentos++];
+}
+
+// Reserva 'tam' bytes propios al final del mensaje y devuelve su posición en datos
+uint32_t trama_reservar(t_trama* trama, uint32_t tam) {
+    if (trama->tam + tam > trama->capacidad) {
+        while (trama->tam + tam > trama->capacidad) trama->capacidad *= 2;
+        trama->datos = realloc(trama->datos, trama->capacidad);
+    }
+
+    uint32_t desplazamiento = trama->tam;
+    t_segmento_trama* ultimo = trama->cant_segmentos > 0 ? &trama->segmentos[trama->cant_segmentos - 1] : NULL;
+
+    // Bytes propios consecutivos van en el mismo segmento
+    if (ultimo && !ultimo->externo && ultimo->desplazamiento + ultimo->tam == desplazamiento) {
+        ultimo->tam += tam;
+    } else {
+        t_segmento_trama* segmento = nuevo_segmento(trama);
+        segmento->externo = false;
+        segmento->desplazamiento = desplazamiento;
+        segmento->puntero = NULL;
+        segmento->tam = tam;
+    }
+
+    trama->tam += tam;
+    trama->tam_total += tam;
+    return desplazamiento;
+}
+
+// Completa un espacio reservado antes (por ejemplo, un tamaño que se conoce al final)
+void trama_escribir(t_trama* trama, uint32_t desplazamiento, const void* datos, uint32_t tam) {
+    memcpy(trama->datos + desplazamiento, datos, tam);
+}
+
+void trama_agregar(t_trama* trama, const void* datos, uint32_t tam) {
+    if (tam == 0) return;
+    uint32_t desplazamiento = trama_reservar(trama, tam);
+    memcpy(trama->datos + desplazamiento, datos, tam);
+}
+
+// Agrega memoria del llamador sin copiarla: tiene que seguir válida hasta enviar la trama
+void trama_agregar_referencia(t_trama* trama, const void* datos, uint32_t tam) {
+    if (tam == 0) return;
+    t_segmento_trama* segmento = nuevo_segmento(trama);
+    segmento->externo = true;
+    segmento->desplazamiento = 0;
+    segmento->puntero = datos;
+    segmento->tam = tam;
+    trama->tam_total += tam;
+}
+
+void trama_agregar_uint32_red(t_trama* trama, uint32_t valor) {
+    uint32_t valor_network = htonl(valor);
+    trama_agregar(trama, &valor_network, sizeof(uint32_t));
+}
+
+// [tamaño][bytes con \0], tamaño en network order
+void trama_agregar_string_red(t_trama* trama, const char* str) {
+    uint32_t tam_str = strlen(str) + 1;
+    trama_agregar_uint32_red(trama, tam_str);
+    trama_agregar(trama, str, tam_str);
+}
+
+// Envía todo el iovec con una sola llamada mientras el kernel lo acepte completo
+bool enviar_iovec(int socket, struct iovec* iov, int cant) {
+    while (cant > 0) {
+        struct msghdr mensaje = {0};
+        mensaje.msg_iov = iov;
+        mensaje.msg_iovlen = cant < IOV_MAX ? cant : IOV_MAX;
+
+        ssize_t enviados = sendmsg(socket, &mensaje, MSG_NOSIGNAL);
+        if (enviados < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket no bloqueante lleno: se espera a que acepte más
+                struct pollfd espera = { .fd = socket, .events = POLLOUT };
+                if (poll(&espera, 1, -1) < 0 && errno != EINTR) return false;
+                continue;
+            }
+            return false;
+        }
+
+        // Avanzar sobre lo enviado (envío parcial)
+        while (cant > 0 && (size_t)enviados >= iov->iov_len) {
+            enviados -= iov->iov_len;
+            iov++;
+            cant--;
+        }
+        if (cant > 0) {
+            iov->iov_base = (char*)iov->iov_base + enviados;
+            iov->iov_len -= enviados;
+        }
+    }
+    return true;
+}
+
+bool trama_enviar(t_trama* trama, int socket) {
+    if (trama->cant_segmentos == 0) return true;
+
+    struct iovec iov_local[TRAMA_SEGMENTOS_INICIALES];
+    struct iovec* iov = trama->cant_segmentos <= TRAMA_SEGMENTOS_INICIALES ?
+                        iov_local : malloc(trama->cant_segmentos * sizeof(struct iovec));
+
+    // Los segmentos propios se resuelven recién acá: datos pudo moverse con realloc
+    for (int i = 0; i < trama->cant_segmentos; i++) {
+        t_segmento_trama* segmento = &trama->segmentos[i];
+        iov[i].iov_base = segmento->externo ? (void*)segmento->puntero : trama->datos + segmento->desplazamiento;
+        iov[i].iov_len = segmento->tam;
+    }
+
+    bool enviado = enviar_iovec(socket, iov, trama->cant_segmentos);
+
+    if (iov != iov_local) free(iov);
+    return enviado;
+}
+
+// FORMATO t_paquete
+
+void trama_iniciar_paquete(t_trama* trama, int cod_op) {
+    trama->total_inicio_paquete = trama->tam_total;
+    trama->inicio_paquete = trama_reservar(trama, 2 * sizeof(int));
+    trama_escribir(trama, trama->inicio_paquete, &cod_op, sizeof(int));
+}
+
+void trama_agregar_a_paquete(t_trama* trama, const void* valor, int tam) {
+    trama_agregar(trama, &tam, sizeof(int));
+    trama_agregar(trama, valor, tam);
+}
+
+// Como trama_agregar_a_paquete, pero el valor no se copia
+void trama_referenciar_en_paquete(t_trama* trama, const void* valor, int tam) {
+    trama_agregar(trama, &tam, sizeof(int));
+    trama_agregar_referencia(trama, valor, tam);
+}
+
+// Completa el [size] del paquete abierto con todo lo agregado desde trama_iniciar_paquete
+void trama_cerrar_paquete(t_trama* trama) {
+    int size = trama->tam_total - trama->total_inicio_paquete - 2 * sizeof(int);
+    trama_escribir(trama, trama->inicio_paquete + sizeof(int), &size, sizeof(int));
+}
+
+void cursor_paquete_iniciar(t_cursor_paquete* cursor, const void* buffer, uint32_t size) {
+    cursor->actual = buffer;
+    cursor->fin = cursor->actual + size;
+}
+
+// Avanza al próximo [tam][valor]. Devuelve false al terminar o si el campo no entra en el buffer.
+bool cursor_paquete_siguiente(t_cursor_paquete* cursor, t_campo_paquete* campo) {
+    if ((size_t)(cursor->fin - cursor->actual) < sizeof(int)) return false;
+
+    int tam;
+    memcpy(&tam, cursor->actual, sizeof(int));
+    if (tam < 0 || (size_t)tam > (size_t)(cursor->fin - cursor->actual) - sizeof(int)) return false;
+
+    campo->datos = cursor->actual + sizeof(int);
+    campo->tam = tam;
+    cursor->actual = campo->datos + tam;
+    return true;
+}
+
+// Toma los primeros PAQUETE_MAX_CAMPOS campos; si hay más quedan en vista->resto.
+// Devuelve false si el paquete está mal formado.
+bool paquete_decodificar_vista(const void* buffer, uint32_t size, t_vista_paquete* vista) {
+    cursor_paquete_iniciar(&vista->resto, buffer, size);
+    vista->cantidad = 0;
+
+    while (vista->cantidad < PAQUETE_MAX_CAMPOS &&
+           cursor_paquete_siguiente(&vista->resto, &vista->campos[vista->cantidad])) {
+        vista->cantidad++;
+    }
+    return vista->cantidad == PAQUETE_MAX_CAMPOS || vista->resto.actual == vista->resto.fin;
+}
+
+bool campo_leer_uint32(const t_campo_paquete* campo, uint32_t* valor) {
+    if (campo->tam < (int)sizeof(uint32_t)) return false;
+    memcpy(valor, campo->datos, sizeof(uint32_t));
+    return true;
+}
+
+// El string tal cual está en el buffer, o NULL si no viene terminado en \0
+const char* campo_string(const t_campo_paquete* campo) {
+    if (campo->tam <= 0 || campo->datos[campo->tam - 1] != '\0') return NULL;
+    return campo->datos;
+}
+
+// LECTURA DE TRAMAS
+
+t_lector_tramas* lector_crear(int socket, uint32_t capacidad) {
+    t_lector_tramas* lector = malloc(sizeof(t_lector_tramas));
+    lector->socket = socket;
+    lector->capacidad = capacidad < TRAMA_CAPACIDAD_MINIMA ? TRAMA_CAPACIDAD_MINIMA : capacidad;
+    lector->datos = malloc(lector->capacidad);
+    lector->inicio = 0;
+    lector->fin = 0;
+    return lector;
+}
+
+void lector_destruir(t_lector_tramas* lector) {
+    if (!lector) return;
+    free(lector->datos);
+    free(lector);
+}
+
+// Bytes ya recibidos y sin consumir: si hay, puede haber otro mensaje sin que el socket avise
+uint32_t lector_pendientes(t_lector_tramas* lector) {
+    return lector->fin - lector->inicio;
+}
+
+// Deja lugar para 'tam' bytes contiguos desde lector->inicio
+static void lector_preparar(t_lector_tramas* lector, uint32_t tam) {
+    // Mover lo pendiente al principio y agrandar si el mensaje no entra
+    if (lector->inicio > 0) {
+        memmove(lector->datos, lector->datos + lector->inicio, lector_pendientes(lector));
+        lector->fin -= lector->inicio;
+        lector->inicio = 0;
+    }
+    if (tam > lector->capacidad) {
+        while (tam > lector->capacidad) lector->capacidad *= 2;
+        lector->datos = realloc(lector->datos, lector->capacidad);
+    }
+}
+
+// Para sockets no bloqueantes: recibe lo que haya sin esperar, con lugar para al menos
+// 'tam' bytes pendientes. Devuelve 1 si sigue abierto (haya llegado algo o no), 0 si el
+// otro extremo cerró y -1 ante un error.
+int lector_recibir_disponible(t_lector_tramas* lector, uint32_t tam) {
+    if (lector_pendientes(lector) < tam) lector_preparar(lector, tam);
+
+    while (lector->fin < lector->capacidad) {
+        ssize_t recibidos = recv(lector->socket, lector->datos + lector->fin,
+                                 lector->capacidad - lector->fin, MSG_DONTWAIT);
+        if (recibidos < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 1;
+            return -1;
+        }
+        if (recibidos == 0) return 0;
+        lector->fin += recibidos;
+    }
+    return 1;
+}
+
+// Los próximos 'tam' bytes si ya se recibieron (NULL si no), sin recibir ni consumir
+const void* lector_ver_recibido(t_lector_tramas* lector, uint32_t tam) {
+    return lector_pendientes(lector) >= tam ? lector->datos + lector->inicio : NULL;
+}
+
+// Deja al menos 'tam' bytes contiguos en el buffer, recibiendo lo que haga falta
+static bool lector_asegurar(t_lector_tramas* lector, uint32_t tam) {
+    if (lector_pendientes(lector) >= tam) return true;
+
+    lector_preparar(lector, tam);
+
+    while (lector->fin < tam) {
+        ssize_t recibidos = recv(lector->socket, lector->datos + lector->fin, lector->capacidad - lector->fin, 0);
+        if (recibidos < 0 && errno == EINTR) continue;
+        if (recibidos <= 0) return false;
+        lector->fin += recibidos;
+    }
+    return true;
+}
+
+// Devuelve un puntero a los próximos 'tam' bytes sin consumirlos. Vale hasta la
+// próxima llamada sobre el lector.
+void* lector_ver(t_lector_tramas* lector, uint32_t tam) {
+    if (!lector_asegurar(lector, tam)) return NULL;
+    return lector->datos + lector->inicio;
+}
+
+void lector_consumir(t_lector_tramas* lector, uint32_t tam) {
+    lector->inicio += tam;
+    if (lector->inicio == lector->fin) {
+        lector->inicio = 0;
+        lector->fin = 0;
+    }
+}
+
+bool lector_leer(t_lector_tramas* lector, void* destino, uint32_t tam) {
+    if (tam == 0) return true;
+    void* origen = lector_ver(lector, tam);
+    if (!origen) return false;
+    memcpy(destino, origen, tam);
+    lector_consumir(lector, tam);
+    return true;
+}
+
+bool lector_leer_uint32_red(t_lector_tramas* lector, uint32_t* valor) {
+    uint32_t valor_network;
+    if (!lector_leer(lector, &valor_network, sizeof(uint32_t))) return false;
+    *valor = ntohl(valor_network);
+    return true;
+}
+
+// [tamaño][bytes con \0] -> string nuevo (NULL si se cortó la conexión)
+char* lector_leer_string_red(t_lector_tramas* lector) {
+    uint32_t tam;
+    if (!lector_leer_uint32_red(lector, &tam) || tam == 0) return NULL;
+
+    char* str = malloc(tam);
+    if (!lector_leer(lector, str, tam)) {
+        free(str);
+        return NULL;
+    }
+    str[tam - 1] = '\0';
+    return str;
+}
+
+// Descarta 'tam' bytes sin copiarlos (cuerpos de operaciones que no se atienden)
+bool lector_descartar(t_lector_tramas* lector, uint32_t tam) {
+    while (tam > 0) {
+        uint32_t disponibles = lector_pendientes(lector);
+        if (disponibles == 0) {
+            if (!lector_asegurar(lector, 1)) return false;
+            continue;
+        }
+        uint32_t a_descartar = tam < disponibles ? tam : disponibles;
+        lector_consumir(lector, a_descartar);
+        tam -= a_descartar;
+    }
+    return true;
+}
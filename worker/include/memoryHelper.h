@@ -10,10 +10,12 @@ typedef struct {
     char* file_tag;          // "MATERIAS:BASE"
     uint32_t nro_pagina;     // Número de página lógica
     bool presente;           // Está cargada en memoria?
-    bool modificada;         // Bit M (modificada)
+    bool modificada;         // Bit M de CLOCK-M: WRITE va directo al Storage, la página nunca queda sucia
     bool usada;              // Bit U (usada) para CLOCK
     uint32_t marco;          // Número de marco físico
     uint64_t last_used;      // Timestamp para LRU
+    uint8_t lista_reemplazo; // Lista de la política de reemplazo donde está la página
+    uint32_t fijaciones;     // Pin count: con > 0 la página no se puede desalojar
 } t_pagina;
 
 // Tabla de páginas por File:Tag
@@ -22,33 +24,89 @@ typedef struct {
     t_list* paginas;         // Lista de t_pagina*
 } t_tabla_paginas_interna;
 
+// Política de reemplazo enchufable (LRU, CLOCK, CLOCK-M, ARC, 2Q)
+typedef struct {
+    const char* nombre;                            // Valor de ALGORITMO_REEMPLAZO
+    void (*inicializar)(uint32_t cant_marcos);
+    void (*destruir)(void);
+    void (*on_hit)(t_pagina* pagina);              // Acceso a una página presente
+    void (*on_insert)(t_pagina* pagina);           // Página recién cargada en un marco
+    t_pagina* (*pick_victim)(t_pagina* entrante);  // Víctima a desalojar (entrante puede ser NULL)
+    void (*on_remove)(t_pagina* pagina);           // La página se descarta (DELETE/TRUNCATE)
+} t_politica_reemplazo;
+
+// Perfil de page faults de la query que corre en un ejecutor
+typedef struct {
+    uint32_t query_id;
+    t_metricas_memoria metricas;
+    t_dictionary* por_archivo;   // file_tag -> t_metricas_memoria*
+} t_perfil_query;
+
 // Estructura principal de la memoria interna
 typedef struct {
-    void* base_memoria;      // Puntero al malloc()
+    void* base_memoria;      // Pool de marcos (malloc alineado o mmap anónimo)
+    size_t tamanio_reservado; // Bytes realmente reservados (redondeado en mmap)
+    bool mapeada;            // true si base_memoria viene de mmap()
+    bool bloqueada;          // true si se aplicó mlock() al pool
     uint32_t tamanio;        // Tamaño total
     uint32_t tam_pagina;     // Tamaño de página (= BLOCK_SIZE)
     uint32_t cant_marcos;    // Cantidad de marcos
     uint32_t retardo;        // RETARDO_MEMORIA en ms
-    char* algoritmo;         // "LRU" o "CLOCK-M"
+    char* algoritmo;         // "LRU", "CLOCK", "CLOCK-M", "ARC" o "2Q"
+    const t_politica_reemplazo* politica;
     t_list* tablas;          // Lista de t_tabla_paginas_interna*
     t_list* marcos_libres;   // Lista de marcos libres
-    uint32_t puntero_clock;  // Para algoritmo CLOCK
+    t_dictionary* generaciones; // file_tag -> generación (ver memory_invalidar_lecturas)
+
+    // Métricas (protegidas por mutex_metricas: el dump corre en otro hilo)
+    pthread_mutex_t mutex_metricas;
+    t_metricas_memoria metricas;               // Totales del Worker
+    t_dictionary* metricas_por_archivo;        // file_tag -> t_metricas_memoria*
+    t_list* perfiles_query;                    // t_perfil_query* de cada ejecutor
 } t_memoria_interna;
 
+// CONSTANTES
+#define MEMORIA_ALINEACION_CACHE 64              // Línea de caché
+#define MEMORIA_TAM_HUGE_PAGE (2 * 1024 * 1024)  // Huge page x86-64
+
 // FUNCIONES DE INICIALIZACIÓN Y DESTRUCCIÓN
-void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, const char* algoritmo);
+void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, const char* algoritmo,
+                 bool huge_pages, bool bloquear_memoria);
 void memory_destroy(void);
 
+// FUNCIONES DE SINCRONIZACIÓN
+// Los ejecutores de queries comparten la memoria, el prefetch y la conexión al Storage
+// y los usan de a uno: cada ejecutor la toma mientras corre y la suelta solo para
+// esperar al Storage o el retardo de memoria.
+void memory_tomar(void);
+void memory_soltar(void);
+void memory_esperar(pthread_cond_t* condicion);
+
 // FUNCIONES DE ACCESO A MEMORIA
 void* memory_leer(const char* file_tag, uint32_t nro_pagina);
-void memory_escribir(const char* file_tag, uint32_t nro_pagina, void* contenido);
 void memory_cargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* buffer);
+bool memory_precargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* buffer);
+void memory_actualizar_rango(const char* file_tag, uint32_t offset, const void* datos, uint32_t size);
+
+// Coherencia con las lecturas en vuelo: cada WRITE, TRUNCATE o DELETE enviado al Storage
+// cambia la generación del archivo, y una página pedida antes de ese cambio no se carga
+// (la respuesta puede traer los datos anteriores a la escritura).
+uint32_t memory_generacion_archivo(const char* file_tag);
+void memory_invalidar_lecturas(const char* file_tag);
 
 // FUNCIONES AUXILIARES
 t_tabla_paginas_interna* memory_get_tabla(const char* file_tag);
 t_pagina* memory_buscar_pagina(const char* file_tag, uint32_t nro_pagina);
 void* memory_get_marco_ptr(uint32_t marco);
 uint64_t memory_timestamp(void);
+uint32_t memory_cant_marcos_libres(void);
+void memory_fijar_pagina(t_pagina* pagina);
+void memory_soltar_pagina(t_pagina* pagina);
+
+// FUNCIONES DE MÉTRICAS
+void memory_iniciar_metricas_query(uint32_t query_id);
+void memory_agregar_metricas_query_a_paquete(t_paquete* paquete);
+void memory_dump_metricas(void);
 
 // Nueva función para DELETE
 void memory_liberar_archivo(const char* file_tag);
@@ -0,0 +1,41 @@
+#ifndef PREFETCH_HELPER_H_
+#define PREFETCH_HELPER_H_
+
+#include "worker.h"
+
+
+// ESTRUCTURAS
+// Estado de lectura secuencial por File:Tag (ventana adaptativa estilo readahead)
+typedef struct {
+    char* file_tag;          // "MATERIAS:BASE"
+    bool hay_acceso_previo;  // Se registró al menos un acceso
+    uint32_t ultima_pagina;  // Última página accedida
+    uint32_t ventana;        // Páginas a pedir por adelantado (0 = sin secuencia detectada)
+    uint32_t proxima_pagina; // Primera página todavía no pedida al Storage
+    uint32_t marcador;       // Al acceder a esta página se pide la ventana siguiente
+} t_prefetch_estado;
+
+// Pedido de página enviado al Storage cuya respuesta todavía no se leyó
+typedef struct {
+    char* file_tag;
+    uint32_t nro_pagina;
+    uint32_t id_pedido;      // Id con el que vuelve la respuesta del Storage
+    bool esperada;           // Un ejecutor ya está esperando la respuesta
+    uint32_t generacion;     // Generación del archivo al pedirla (ver memory_invalidar_lecturas)
+} t_prefetch_pendiente;
+
+// FUNCIONES DE INICIALIZACIÓN Y DESTRUCCIÓN
+void prefetch_init(uint32_t max_paginas);
+void prefetch_destroy(void);
+
+// FUNCIONES DE PREFETCH
+void prefetch_registrar_acceso(const char* file_tag, uint32_t nro_pagina);
+void prefetch_drenar(void);
+bool prefetch_hay_pendientes(void);
+bool prefetch_es_pedido(uint32_t id_pedido);
+bool prefetch_pagina_en_vuelo(const char* file_tag, uint32_t nro_pagina);
+void prefetch_completar(t_respuesta_storage* respuesta);
+bool prefetch_esperar_pagina(const char* file_tag, uint32_t nro_pagina);
+void prefetch_olvidar_archivo(const char* file_tag);
+
+#endif
@@ -18,13 +18,36 @@ typedef enum {
     QUERY_INST_END
 } t_query_instruccion;
 
+// Instrucción de un script ya decodificada (ver scriptHelper): los argumentos se
+// separan y convierten una sola vez al compilar, no en cada ejecución
+typedef struct {
+    t_query_instruccion tipo;
+    char* linea;               // Texto original, para los logs
+    int cant_args;
+    char* file_tag;            // Primer argumento tal cual (TAG: origen)
+    char* filename;
+    char* tag;                 // BASE si no se indicó
+    char* file_tag_destino;    // TAG: destino completo filename:tag
+    char* filename_destino;
+    char* tag_destino;
+    char* contenido;           // WRITE
+    uint32_t direccion;        // WRITE y READ
+    uint32_t tamanio;          // READ y TRUNCATE
+} t_instruccion_compilada;
+
 typedef enum {
     ERROR_CRITICO,      // Detiene la query
     ERROR_NO_CRITICO    // Continúa la ejecución
 } t_tipo_error;
 
+// Máximo de WRITE consecutivos que viajan juntos en un OP_WRITE_VECTORIAL
+#define MAX_WRITES_AGRUPADOS 16
+
 // Declaraciones de funciones
-bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc);
+bool ejecutar_instruccion(uint32_t id, const t_instruccion_compilada* inst, uint32_t pc);
+uint32_t writes_agrupables(const t_instruccion_compilada* inst, uint32_t disponibles);
+bool ejecutar_WRITE_agrupado(uint32_t id, const t_instruccion_compilada* inst, uint32_t cantidad);
+t_query_instruccion instruccion_from_string(const char* str);
 void enviar_mensaje_storage(op_code codigo, void* buffer, size_t size, int socket);
 bool ejecutar_END(uint32_t id);
 
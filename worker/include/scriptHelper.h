@@ -0,0 +1,35 @@
+#ifndef SCRIPT_HELPER_H_
+#define SCRIPT_HELPER_H_
+
+#include "queryHelper.h"
+#include <sys/stat.h>
+
+
+// ESTRUCTURAS
+// Script de query compilado: una instrucción por PC (sin líneas vacías ni comentarios),
+// así reanudar en el PC N es acceder a instrucciones[N]
+typedef struct {
+    char* path;
+    t_instruccion_compilada* instrucciones;
+    uint32_t cantidad;
+    // Identidad del archivo al compilarlo: si cambia, el script se recompila
+    dev_t dispositivo;
+    ino_t inodo;
+    struct timespec modificacion;
+    off_t tam;
+    uint32_t referencias;    // Ejecuciones que lo están usando
+    bool en_cache;
+} t_script;
+
+// FUNCIONES DE INICIALIZACIÓN Y DESTRUCCIÓN
+// Cache de scripts compilados por path (0 = deshabilitada)
+void script_cache_init(uint32_t max_scripts);
+void script_cache_destroy(void);
+
+// FUNCIONES DE SCRIPTS
+// Devuelve el script compilado (del cache si el archivo no cambió) o NULL si no se pudo
+// abrir. Cada script_obtener se corresponde con un script_liberar.
+t_script* script_obtener(const char* path);
+void script_liberar(t_script* script);
+
+#endif
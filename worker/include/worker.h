@@ -4,6 +4,9 @@
 #include <conexion.h>
 #include <cliente.h>
 #include <server.h>
+#include <trama.h>
+#include <pool_buffers.h>
+#include <stddef.h>
 
 // Códigos de operación
 #define GET_BLOCK_SIZE 100
@@ -17,8 +20,16 @@ typedef struct {
     uint32_t id;
     uint32_t pc;
     char* path;
+    void* buffer;    // Paquete recibido del que cuelga path (se devuelve al pool al terminar)
 } t_query;
 
+// Respuesta del Storage a un pedido: [estado][id_pedido][tam_payload][payload]
+typedef struct {
+    int estado;
+    uint32_t id_pedido;
+    t_buffer* payload;   // NULL si la respuesta no trae datos
+} t_respuesta_storage;
+
 // Variables globales que usa worker.c
 extern t_log* logger;
 extern t_config* config;
@@ -32,10 +43,21 @@ void iniciar_worker(char* config_path, char* log_path, char* worker_id);
 void iniciar_logger_worker(void);
 t_config* iniciar_config(char* config_path);
 void iniciar_memoria();
+void iniciar_dump_metricas(void);
 
 // ---- Conexión y handshake con Storage ----
 int conectar_storage(void);
 int handshake_storage_pedir_blocksize(void);
+t_trama* iniciar_pedido_storage(int cod_op);
+bool enviar_pedido_storage(t_trama* pedido, uint32_t* id_pedido);
+t_respuesta_storage* storage_esperar_respuesta(uint32_t id_pedido);
+void storage_esperar_novedad(void);
+void storage_avisar_novedad(void);
+void storage_descartar_respuesta(uint32_t id_pedido);
+void destruir_respuesta_storage(t_respuesta_storage* respuesta);
+bool recibir_respuesta_storage_simple(t_log* logger, uint32_t id_pedido);
+uint32_t enviar_pedido_pagina_storage(const char* file_tag, uint32_t nro_pagina);
+t_buffer* recibir_pagina_storage(t_log* logger, uint32_t id_pedido);
 
 // ---- Conexión y handshake con Master ----
 int conectar_master(void);
@@ -49,7 +71,10 @@ void ejecutar_query(t_query* q);
 void enviar_notificacion_lectura_master(uint32_t query_id);
 void enviar_finalizacion_exitosa_master(uint32_t query_id);
 void enviar_error_a_master(uint32_t query_id, const char* mensaje_error);
-bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc);
+void enviar_metricas_memoria_master(uint32_t query_id);
+void enviar_paquete_master(t_paquete* paquete);
+bool enviar_trama_master(t_trama* trama);
+void esperar_lectura_habilitada(uint32_t query_id);
 
 // ---- Finalizar ----
 void finalizar_worker(void);
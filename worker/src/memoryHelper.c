@@ -2,12 +2,116 @@
 
 extern t_log* logger;
 static t_memoria_interna* memoria = NULL;
+static pthread_mutex_t mutex_memoria = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_fijaciones = PTHREAD_COND_INITIALIZER;  // Alguna página quedó sin fijar
+static __thread t_perfil_query* perfil_query = NULL;   // Perfil de la query de este ejecutor
+
+// Listas de las políticas de reemplazo (t_pagina.lista_reemplazo)
+#define LISTA_NINGUNA             0
+#define LISTA_RECIENTES           1
+#define LISTA_FRECUENTES          2
+#define LISTA_FANTASMA_RECIENTES  3
+#define LISTA_FANTASMA_FRECUENTES 4
+
+// Eventos contabilizados en las métricas
+typedef enum {
+    EVENTO_HIT,
+    EVENTO_MISS,
+    EVENTO_PRECARGA,
+    EVENTO_DESALOJO,
+    EVENTO_ESCRITURA
+} t_evento_memoria;
+
+static const t_politica_reemplazo* buscar_politica(const char* nombre);
+static void registrar_evento(const char* file_tag, t_evento_memoria evento, uint32_t bytes);
+
+// Reserva el pool de marcos. Con huge_pages se usa un mmap anónimo (MAP_HUGETLB y, si no hay
+// huge pages reservadas en el sistema, THP vía madvise); si no, un bloque alineado a línea de caché.
+static void* reservar_pool_marcos(t_memoria_interna* m, size_t tamanio, bool huge_pages, bool bloquear_memoria) {
+    void* base = NULL;
+    m->mapeada = false;
+    m->bloqueada = false;
+    m->tamanio_reservado = tamanio;
+
+    if (huge_pages) {
+        size_t tamanio_mapeo = ((tamanio + MEMORIA_TAM_HUGE_PAGE - 1) / MEMORIA_TAM_HUGE_PAGE) * MEMORIA_TAM_HUGE_PAGE;
+
+#ifdef MAP_HUGETLB
+        base = mmap(NULL, tamanio_mapeo, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            log_info(logger, "Pool de marcos en huge pages (MAP_HUGETLB): %zu bytes", tamanio_mapeo);
+        } else {
+            log_warning(logger, "MAP_HUGETLB no disponible (%s), se intenta con THP", strerror(errno));
+            base = NULL;
+        }
+#endif
+
+        if (!base) {
+            base = mmap(NULL, tamanio_mapeo, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) {
+                log_error(logger, "mmap del pool de marcos falló (%s), se usa memoria alineada", strerror(errno));
+                base = NULL;
+            } else {
+#ifdef MADV_HUGEPAGE
+                if (madvise(base, tamanio_mapeo, MADV_HUGEPAGE) != 0) {
+                    log_warning(logger, "madvise(MADV_HUGEPAGE) falló: %s", strerror(errno));
+                }
+#endif
+                log_info(logger, "Pool de marcos mapeado con THP: %zu bytes", tamanio_mapeo);
+            }
+        }
+
+        if (base) {
+            m->mapeada = true;
+            m->tamanio_reservado = tamanio_mapeo;
+        }
+    }
+
+    if (!base) {
+        if (posix_memalign(&base, MEMORIA_ALINEACION_CACHE, tamanio) != 0) {
+            return NULL;
+        }
+    }
+
+    if (bloquear_memoria) {
+        if (mlock(base, m->tamanio_reservado) == 0) {
+            m->bloqueada = true;
+            log_info(logger, "Pool de marcos bloqueado en RAM (mlock): %zu bytes", m->tamanio_reservado);
+        } else {
+            log_warning(logger, "mlock del pool de marcos falló (%s), revisar RLIMIT_MEMLOCK", strerror(errno));
+        }
+    }
+
+    return base;
+}
+
+static void liberar_pool_marcos(t_memoria_interna* m) {
+    if (!m->base_memoria) return;
+
+    if (m->bloqueada) {
+        munlock(m->base_memoria, m->tamanio_reservado);
+    }
+
+    if (m->mapeada) {
+        munmap(m->base_memoria, m->tamanio_reservado);
+    } else {
+        free(m->base_memoria);
+    }
+    m->base_memoria = NULL;
+}
 
 // FUNCIONES DE INICIALIZACIÓN Y DESTRUCCIÓN
-void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, const char* algoritmo) {
+void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, const char* algoritmo,
+                 bool huge_pages, bool bloquear_memoria) {
     memoria = malloc(sizeof(t_memoria_interna));
 
-    memoria->base_memoria = malloc(tam_memoria);
+    memoria->base_memoria = reservar_pool_marcos(memoria, tam_memoria, huge_pages, bloquear_memoria);
+    if (!memoria->base_memoria) {
+        log_error(logger, "Error fatal: No se pudo reservar el pool de marcos (%u bytes)", tam_memoria);
+        exit(1);
+    }
     memoria->tamanio = tam_memoria;
     memoria->tam_pagina = tam_pagina;
     memoria->cant_marcos = tam_memoria / tam_pagina;
@@ -15,7 +119,19 @@ void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, co
     memoria->algoritmo = strdup(algoritmo);
     memoria->tablas = list_create();
     memoria->marcos_libres = list_create();
-    memoria->puntero_clock = 0;
+
+    memoria->politica = buscar_politica(algoritmo);
+    if (!memoria->politica) {
+        log_warning(logger, "Algoritmo de reemplazo desconocido: %s, se usa LRU", algoritmo);
+        memoria->politica = buscar_politica("LRU");
+    }
+    memoria->politica->inicializar(memoria->cant_marcos);
+
+    pthread_mutex_init(&memoria->mutex_metricas, NULL);
+    memset(&memoria->metricas, 0, sizeof(t_metricas_memoria));
+    memoria->metricas_por_archivo = dictionary_create();
+    memoria->perfiles_query = list_create();
+    memoria->generaciones = dictionary_create();
 
     for (uint32_t i = 0; i < memoria->cant_marcos; i++)
         list_add(memoria->marcos_libres, (void*)(intptr_t)i);
@@ -25,9 +141,17 @@ void memory_init(uint32_t tam_memoria, uint32_t tam_pagina, uint32_t retardo, co
     }
 }
 
+static void destruir_perfil_query(void* elemento) {
+    t_perfil_query* perfil = elemento;
+    dictionary_destroy_and_destroy_elements(perfil->por_archivo, free);
+    free(perfil);
+}
+
 void memory_destroy(void) {
     if (!memoria) return;
 
+    memoria->politica->destruir();
+
     // Liberar tablas y páginas
     for (int i = 0; i < list_size(memoria->tablas); i++) {
         t_tabla_paginas_interna* tabla = list_get(memoria->tablas, i);
@@ -44,8 +168,13 @@ void memory_destroy(void) {
     list_destroy(memoria->tablas);
     list_destroy(memoria->marcos_libres);
 
+    dictionary_destroy_and_destroy_elements(memoria->metricas_por_archivo, free);
+    list_destroy_and_destroy_elements(memoria->perfiles_query, destruir_perfil_query);
+    dictionary_destroy(memoria->generaciones);
+    pthread_mutex_destroy(&memoria->mutex_metricas);
+
     free(memoria->algoritmo);
-    free(memoria->base_memoria);
+    liberar_pool_marcos(memoria);
     free(memoria);
     memoria = NULL;
 
@@ -53,6 +182,20 @@ void memory_destroy(void) {
 }
 
 // FUNCIONES DE TABLAS Y PÁGINAS
+// FUNCIONES DE SINCRONIZACIÓN
+void memory_tomar(void) {
+    pthread_mutex_lock(&mutex_memoria);
+}
+
+void memory_soltar(void) {
+    pthread_mutex_unlock(&mutex_memoria);
+}
+
+// Espera la condición soltando la memoria mientras tanto
+void memory_esperar(pthread_cond_t* condicion) {
+    pthread_cond_wait(condicion, &mutex_memoria);
+}
+
 t_tabla_paginas_interna* memory_get_tabla(const char* file_tag) {
     // Busco existente
     for (int i = 0; i < list_size(memoria->tablas); i++) {
@@ -80,39 +223,44 @@ t_pagina* memory_buscar_pagina(const char* file_tag, uint32_t nro_pagina) {
     return NULL;
 }
 
-// FUNCIONES DE ACCESO A MEMORIA
-void* memory_leer(const char* file_tag, uint32_t nro_pagina) {
-    usleep(memoria->retardo * 1000);
+// Como memory_buscar_pagina, pero sin crear la tabla si el archivo no tiene páginas
+static t_pagina* buscar_pagina_existente(const char* file_tag, uint32_t nro_pagina) {
+    for (int i = 0; i < list_size(memoria->tablas); i++) {
+        t_tabla_paginas_interna* tabla = list_get(memoria->tablas, i);
+        if (strcmp(tabla->file_tag, file_tag) != 0) continue;
 
-    t_pagina* pagina = memory_buscar_pagina(file_tag, nro_pagina);
-    if (!pagina || !pagina->presente) {
-        log_info(logger, "PAGE FAULT en lectura (%s, pag=%u)", file_tag, nro_pagina);
-        // Aquí se invocará luego a memory_cargar_pagina()
+        for (int j = 0; j < list_size(tabla->paginas); j++) {
+            t_pagina* p = list_get(tabla->paginas, j);
+            if (p->nro_pagina == nro_pagina) return p;
+        }
         return NULL;
     }
-
-    pagina->last_used = memory_timestamp();
-    pagina->usada = true;
-
-    return memory_get_marco_ptr(pagina->marco);
+    return NULL;
 }
 
-void memory_escribir(const char* file_tag, uint32_t nro_pagina, void* contenido) {
+// El retardo no retiene la memoria: los otros ejecutores siguen mientras tanto
+static void esperar_retardo(void) {
+    memory_soltar();
     usleep(memoria->retardo * 1000);
+    memory_tomar();
+}
+
+// FUNCIONES DE ACCESO A MEMORIA
+void* memory_leer(const char* file_tag, uint32_t nro_pagina) {
+    esperar_retardo();
 
     t_pagina* pagina = memory_buscar_pagina(file_tag, nro_pagina);
     if (!pagina || !pagina->presente) {
-        log_info(logger, "PAGE FAULT en escritura (%s, pag=%u)", file_tag, nro_pagina);
-        // cargamos la página desde storage si hace falta
-        return;
+        log_info(logger, "PAGE FAULT en lectura (%s, pag=%u)", file_tag, nro_pagina);
+        registrar_evento(file_tag, EVENTO_MISS, 0);
+        // Aquí se invocará luego a memory_cargar_pagina()
+        return NULL;
     }
 
-    void* ptr = memory_get_marco_ptr(pagina->marco);
-    memcpy(ptr, contenido, memoria->tam_pagina);
+    registrar_evento(file_tag, EVENTO_HIT, 0);
+    memoria->politica->on_hit(pagina);
 
-    pagina->modificada = true;
-    pagina->usada = true;
-    pagina->last_used = memory_timestamp();
+    return memory_get_marco_ptr(pagina->marco);
 }
 
 // FUNCIONES AUXILIARES
@@ -126,172 +274,329 @@ uint64_t memory_timestamp(void) {
     return (uint64_t)tv.tv_sec * 1000u + (uint64_t)tv.tv_usec / 1000u;
 }
 
+uint32_t memory_cant_marcos_libres(void) {
+    if (!memoria) return 0;
+    return (uint32_t)list_size(memoria->marcos_libres);
+}
 
-// FUNCIONES PARA REEMPLAZO DE PÁGINAS
-
-// Escribir página modificada al Storage antes de desalojarla
-static void escribir_pagina_modificada_a_storage(t_pagina* pagina) {
-    if (!pagina->modificada) {
-        return; // No hace falta escribir
-    }
-
-    log_info(logger, "Escribiendo página modificada %s:%u al Storage antes de reemplazo", 
-             pagina->file_tag, pagina->nro_pagina);
+// Mientras esté fijada, el marco de la página puede usarse como origen de un envío sin copiarlo,
+// incluso con la memoria suelta: no se desaloja ni la libera un DELETE o TRUNCATE
+void memory_fijar_pagina(t_pagina* pagina) {
+    if (pagina) pagina->fijaciones++;
+}
 
-    // Parsear file_tag en filename y tag
-    char* filename;
-    char* tag;
-    char* copia = strdup(pagina->file_tag);
-    char* separador = strchr(copia, ':');
-    
-    if (separador) {
-        *separador = '\0';
-        filename = strdup(copia);
-        tag = strdup(separador + 1);
-    } else {
-        filename = strdup(copia);
-        tag = strdup("BASE");
-    }
-    free(copia);
-
-    // Enviar OP_WRITE al Storage
-    int cod_op_write = htonl(OP_WRITE);
-    send(socket_storage, &cod_op_write, sizeof(int), MSG_NOSIGNAL);
-
-    // Enviar filename
-    uint32_t tam_filename = htonl((uint32_t)(strlen(filename) + 1));
-    send(socket_storage, &tam_filename, sizeof(uint32_t), MSG_NOSIGNAL);
-    send(socket_storage, filename, strlen(filename) + 1, MSG_NOSIGNAL);
-
-    // Enviar tag
-    uint32_t tam_tag = htonl((uint32_t)(strlen(tag) + 1));
-    send(socket_storage, &tam_tag, sizeof(uint32_t), MSG_NOSIGNAL);
-    send(socket_storage, tag, strlen(tag) + 1, MSG_NOSIGNAL);
-
-    // Enviar número de página (= número de bloque)
-    uint32_t pagina_network = htonl(pagina->nro_pagina);
-    send(socket_storage, &pagina_network, sizeof(uint32_t), MSG_NOSIGNAL);
-
-    // Enviar datos del marco
-    void* ptr_marco = memory_get_marco_ptr(pagina->marco);
-    uint32_t data_size = memoria->tam_pagina;
-    uint32_t data_size_network = htonl(data_size);
-    send(socket_storage, &data_size_network, sizeof(uint32_t), MSG_NOSIGNAL);
-    send(socket_storage, ptr_marco, data_size, MSG_NOSIGNAL);
-
-    // Esperar respuesta
-    int respuesta_network;
-    recv(socket_storage, &respuesta_network, sizeof(int), MSG_WAITALL);
-    int respuesta = ntohl(respuesta_network);
-
-    if (respuesta == OP_OK) {
-        log_info(logger, "✓ Página %s:%u escrita exitosamente al Storage", 
-                 pagina->file_tag, pagina->nro_pagina);
-        pagina->modificada = false;
-    } else {
-        log_error(logger, "✗ Error al escribir página %s:%u al Storage", 
-                  pagina->file_tag, pagina->nro_pagina);
+void memory_soltar_pagina(t_pagina* pagina) {
+    if (pagina && pagina->fijaciones > 0 && --pagina->fijaciones == 0) {
+        pthread_cond_broadcast(&cond_fijaciones);
     }
-
-    free(filename);
-    free(tag);
 }
 
-// Seleccionar víctima usando LRU
-static t_pagina* seleccionar_victima_lru(void) {
-    t_pagina* victima = NULL;
-    uint64_t min_timestamp = UINT64_MAX;
-
-    // Recorrer TODAS las páginas de TODAS las tablas
+static bool archivo_tiene_fijadas(const char* file_tag) {
     for (int i = 0; i < list_size(memoria->tablas); i++) {
         t_tabla_paginas_interna* tabla = list_get(memoria->tablas, i);
-        
+        if (strcmp(tabla->file_tag, file_tag) != 0) continue;
+
         for (int j = 0; j < list_size(tabla->paginas); j++) {
             t_pagina* p = list_get(tabla->paginas, j);
-            
-            if (p->presente && p->last_used < min_timestamp) {
-                min_timestamp = p->last_used;
-                victima = p;
-            }
+            if (p->fijaciones > 0) return true;
         }
+        return false;
     }
+    return false;
+}
+
+
+// FUNCIONES PARA REEMPLAZO DE PÁGINAS
+
+// POLÍTICAS DE REEMPLAZO
+// Todas comparten estas listas; t_pagina.lista_reemplazo indica en cuál está cada página.
+// Las listas no son dueñas de las páginas (lo son las tablas): la cabeza es el extremo LRU.
+static t_list* lista_recientes = NULL;      // LRU: única lista / CLOCK: reloj / ARC: T1 / 2Q: A1in
+static t_list* lista_frecuentes = NULL;     // ARC: T2 / 2Q: Am
+static t_list* fantasmas_recientes = NULL;  // ARC: B1 / 2Q: A1out (páginas ya no presentes)
+static t_list* fantasmas_frecuentes = NULL; // ARC: B2
+static uint32_t capacidad = 0;              // c = cantidad de marcos
+static uint32_t objetivo_arc = 0;           // p de ARC: tamaño objetivo de T1
+static uint32_t puntero_clock = 0;
+
+static t_list* lista_por_id(uint8_t id) {
+    switch (id) {
+        case LISTA_RECIENTES:           return lista_recientes;
+        case LISTA_FRECUENTES:          return lista_frecuentes;
+        case LISTA_FANTASMA_RECIENTES:  return fantasmas_recientes;
+        case LISTA_FANTASMA_FRECUENTES: return fantasmas_frecuentes;
+        default:                        return NULL;
+    }
+}
+
+// Saca la página de su lista actual y la agrega como MRU de 'destino'
+static void mover_a_lista(t_pagina* pagina, uint8_t destino) {
+    t_list* origen = lista_por_id(pagina->lista_reemplazo);
+    if (origen) list_remove_element(origen, pagina);
+
+    pagina->lista_reemplazo = destino;
+    t_list* lista = lista_por_id(destino);
+    if (lista) list_add(lista, pagina);
+}
 
+// Primera página (desde el extremo LRU) que no está fijada
+static t_pagina* primera_desalojable(t_list* lista) {
+    for (int i = 0; i < list_size(lista); i++) {
+        t_pagina* p = list_get(lista, i);
+        if (p->fijaciones == 0) return p;
+    }
+    return NULL;
+}
+
+static void descartar_lru(t_list* lista) {
+    t_pagina* pagina = list_remove(lista, 0);
+    pagina->lista_reemplazo = LISTA_NINGUNA;
+}
+
+static void listas_inicializar(uint32_t cant_marcos) {
+    lista_recientes = list_create();
+    lista_frecuentes = list_create();
+    fantasmas_recientes = list_create();
+    fantasmas_frecuentes = list_create();
+    capacidad = cant_marcos;
+    objetivo_arc = 0;
+    puntero_clock = 0;
+}
+
+static void listas_destruir(void) {
+    list_destroy(lista_recientes);
+    list_destroy(lista_frecuentes);
+    list_destroy(fantasmas_recientes);
+    list_destroy(fantasmas_frecuentes);
+    lista_recientes = lista_frecuentes = fantasmas_recientes = fantasmas_frecuentes = NULL;
+}
+
+static void listas_quitar(t_pagina* pagina) {
+    mover_a_lista(pagina, LISTA_NINGUNA);
+}
+
+// LRU: lista ordenada por recencia, la víctima es la cabeza
+static void lru_on_acceso(t_pagina* pagina) {
+    pagina->last_used = memory_timestamp();
+    mover_a_lista(pagina, LISTA_RECIENTES);
+}
+
+static t_pagina* lru_pick_victim(t_pagina* entrante) {
+    (void)entrante;
+    t_pagina* victima = primera_desalojable(lista_recientes);
+    if (victima) listas_quitar(victima);
     return victima;
 }
 
-// Seleccionar víctima usando CLOCK-M
-static t_pagina* seleccionar_victima_clock(void) {
-    // Crear lista plana de todas las páginas presentes
-    t_list* todas_paginas = list_create();
-    
-    for (int i = 0; i < list_size(memoria->tablas); i++) {
-        t_tabla_paginas_interna* tabla = list_get(memoria->tablas, i);
-        for (int j = 0; j < list_size(tabla->paginas); j++) {
-            t_pagina* p = list_get(tabla->paginas, j);
-            if (p->presente) {
-                list_add(todas_paginas, p);
-            }
+// CLOCK / CLOCK-M: lista_recientes es el reloj; la página nueva ocupa el lugar de la víctima
+static void clock_on_hit(t_pagina* pagina) {
+    pagina->usada = true;
+}
+
+static void clock_on_insert(t_pagina* pagina) {
+    if (puntero_clock > (uint32_t)list_size(lista_recientes)) puntero_clock = 0;
+
+    list_add_in_index(lista_recientes, puntero_clock, pagina);
+    pagina->lista_reemplazo = LISTA_RECIENTES;
+    pagina->usada = true;
+
+    puntero_clock++;
+    if (puntero_clock >= (uint32_t)list_size(lista_recientes)) puntero_clock = 0;
+}
+
+static t_pagina* clock_quitar_en(uint32_t indice) {
+    t_pagina* pagina = list_remove(lista_recientes, indice);
+    pagina->lista_reemplazo = LISTA_NINGUNA;
+
+    if (indice < puntero_clock) puntero_clock--;
+    if (puntero_clock >= (uint32_t)list_size(lista_recientes)) puntero_clock = 0;
+    return pagina;
+}
+
+static void clock_on_remove(t_pagina* pagina) {
+    for (int i = 0; i < list_size(lista_recientes); i++) {
+        if (list_get(lista_recientes, i) == pagina) {
+            clock_quitar_en(i);
+            return;
         }
     }
+}
 
-    if (list_is_empty(todas_paginas)) {
-        list_destroy(todas_paginas);
-        return NULL;
-    }
+static void clock_avanzar(void) {
+    puntero_clock = (puntero_clock + 1) % list_size(lista_recientes);
+}
 
-    int total_paginas = list_size(todas_paginas);
-    int intentos = 0;
-    int max_intentos = total_paginas * 2; // Dos vueltas completas
-    t_pagina* victima = NULL;
+// CLOCK: segunda oportunidad sobre el bit U
+static t_pagina* clock_pick_victim(t_pagina* entrante) {
+    (void)entrante;
+    if (!primera_desalojable(lista_recientes)) return NULL;
 
-    while (intentos < max_intentos && !victima) {
-        // Ajustar puntero si está fuera de rango
-        if (memoria->puntero_clock >= total_paginas) {
-            memoria->puntero_clock = 0;
+    if (puntero_clock >= (uint32_t)list_size(lista_recientes)) puntero_clock = 0;
+
+    while (true) {
+        t_pagina* p = list_get(lista_recientes, puntero_clock);
+        if (p->fijaciones > 0) {
+            clock_avanzar();
+            continue;
         }
+        if (!p->usada) return clock_quitar_en(puntero_clock);
 
-        t_pagina* p = list_get(todas_paginas, memoria->puntero_clock);
+        // Dar segunda oportunidad: limpiar bit de uso
+        p->usada = false;
+        clock_avanzar();
+    }
+}
 
+// CLOCK-M: primero (U=0, M=0) sin tocar bits; después (U=0, M=1) limpiando U; repetir
+static t_pagina* clock_m_pick_victim(t_pagina* entrante) {
+    (void)entrante;
+    if (!primera_desalojable(lista_recientes)) return NULL;
+
+    if (puntero_clock >= (uint32_t)list_size(lista_recientes)) puntero_clock = 0;
+    uint32_t total = list_size(lista_recientes);
+
+    while (true) {
         // Prioridad 1: página no usada y no modificada
-        if (!p->usada && !p->modificada) {
-            victima = p;
-            memoria->puntero_clock = (memoria->puntero_clock + 1) % total_paginas;
-            break;
+        for (uint32_t i = 0; i < total; i++) {
+            t_pagina* p = list_get(lista_recientes, puntero_clock);
+            if (p->fijaciones == 0 && !p->usada && !p->modificada) return clock_quitar_en(puntero_clock);
+            clock_avanzar();
         }
 
-        // Prioridad 2: página no usada pero modificada
-        if (!p->usada && p->modificada) {
-            victima = p;
-            memoria->puntero_clock = (memoria->puntero_clock + 1) % total_paginas;
-            break;
+        // Prioridad 2: página no usada pero modificada, dando segunda oportunidad al resto
+        for (uint32_t i = 0; i < total; i++) {
+            t_pagina* p = list_get(lista_recientes, puntero_clock);
+            if (p->fijaciones == 0 && !p->usada && p->modificada) return clock_quitar_en(puntero_clock);
+            if (p->fijaciones == 0) p->usada = false;
+            clock_avanzar();
         }
+    }
+}
 
-        // Dar segunda oportunidad: limpiar bit de uso
-        if (p->usada) {
-            p->usada = false;
+// ARC (Megiddo & Modha): T1/T2 residentes, B1/B2 fantasmas; p se adapta con los aciertos fantasma
+static void arc_on_hit(t_pagina* pagina) {
+    pagina->last_used = memory_timestamp();
+    mover_a_lista(pagina, LISTA_FRECUENTES);
+}
+
+static void arc_on_insert(t_pagina* pagina) {
+    pagina->last_used = memory_timestamp();
+    uint32_t b1 = list_size(fantasmas_recientes);
+    uint32_t b2 = list_size(fantasmas_frecuentes);
+
+    if (pagina->lista_reemplazo == LISTA_FANTASMA_RECIENTES) {
+        // Acierto en B1: hacía falta más espacio para recencia
+        uint32_t delta = (b2 > b1) ? b2 / b1 : 1;
+        objetivo_arc = (objetivo_arc + delta < capacidad) ? objetivo_arc + delta : capacidad;
+        mover_a_lista(pagina, LISTA_FRECUENTES);
+    } else if (pagina->lista_reemplazo == LISTA_FANTASMA_FRECUENTES) {
+        // Acierto en B2: hacía falta más espacio para frecuencia
+        uint32_t delta = (b1 > b2) ? b1 / b2 : 1;
+        objetivo_arc = (objetivo_arc > delta) ? objetivo_arc - delta : 0;
+        mover_a_lista(pagina, LISTA_FRECUENTES);
+    } else {
+        mover_a_lista(pagina, LISTA_RECIENTES);
+
+        // Acotar el directorio: |T1| + |B1| <= c y |T1| + |T2| + |B1| + |B2| <= 2c
+        while ((uint32_t)(list_size(lista_recientes) + list_size(fantasmas_recientes)) > capacidad &&
+               !list_is_empty(fantasmas_recientes)) {
+            descartar_lru(fantasmas_recientes);
         }
+        while ((uint32_t)(list_size(lista_recientes) + list_size(lista_frecuentes) +
+                          list_size(fantasmas_recientes) + list_size(fantasmas_frecuentes)) > 2 * capacidad &&
+               !list_is_empty(fantasmas_frecuentes)) {
+            descartar_lru(fantasmas_frecuentes);
+        }
+    }
+}
+
+static t_pagina* arc_pick_victim(t_pagina* entrante) {
+    uint32_t t1 = list_size(lista_recientes);
+    bool entrante_en_b2 = entrante && entrante->lista_reemplazo == LISTA_FANTASMA_FRECUENTES;
+    t_pagina* candidata_t1 = primera_desalojable(lista_recientes);
+    t_pagina* candidata_t2 = primera_desalojable(lista_frecuentes);
+    t_pagina* victima = NULL;
 
-        memoria->puntero_clock = (memoria->puntero_clock + 1) % total_paginas;
-        intentos++;
+    if (candidata_t1 && (t1 > objetivo_arc || (entrante_en_b2 && t1 == objetivo_arc) || !candidata_t2)) {
+        victima = candidata_t1;
+        mover_a_lista(victima, LISTA_FANTASMA_RECIENTES);
+    } else if (candidata_t2) {
+        victima = candidata_t2;
+        mover_a_lista(victima, LISTA_FANTASMA_FRECUENTES);
     }
 
-    // Si no encontramos ninguna después de dos vueltas, tomar la actual
-    if (!victima && !list_is_empty(todas_paginas)) {
-        victima = list_get(todas_paginas, memoria->puntero_clock);
-        memoria->puntero_clock = (memoria->puntero_clock + 1) % total_paginas;
+    return victima;
+}
+
+// 2Q (Johnson & Shasha): A1in FIFO de primeras referencias, A1out fantasmas, Am LRU de páginas calientes
+static uint32_t q2_tam_a1in(void) {
+    return capacidad / 4 > 0 ? capacidad / 4 : 1;
+}
+
+static uint32_t q2_tam_a1out(void) {
+    return capacidad / 2 > 0 ? capacidad / 2 : 1;
+}
+
+static void q2_on_hit(t_pagina* pagina) {
+    pagina->last_used = memory_timestamp();
+    // En A1in no se reordena: una ráfaga de accesos no vuelve caliente a la página
+    if (pagina->lista_reemplazo == LISTA_FRECUENTES)
+        mover_a_lista(pagina, LISTA_FRECUENTES);
+}
+
+static void q2_on_insert(t_pagina* pagina) {
+    pagina->last_used = memory_timestamp();
+    if (pagina->lista_reemplazo == LISTA_FANTASMA_RECIENTES)
+        mover_a_lista(pagina, LISTA_FRECUENTES);
+    else
+        mover_a_lista(pagina, LISTA_RECIENTES);
+}
+
+static t_pagina* q2_pick_victim(t_pagina* entrante) {
+    (void)entrante;
+    t_pagina* candidata_a1in = primera_desalojable(lista_recientes);
+    t_pagina* candidata_am = primera_desalojable(lista_frecuentes);
+    t_pagina* victima = NULL;
+
+    if (candidata_a1in &&
+        ((uint32_t)list_size(lista_recientes) > q2_tam_a1in() || !candidata_am)) {
+        victima = candidata_a1in;
+        mover_a_lista(victima, LISTA_FANTASMA_RECIENTES);
+        while ((uint32_t)list_size(fantasmas_recientes) > q2_tam_a1out())
+            descartar_lru(fantasmas_recientes);
+    } else if (candidata_am) {
+        victima = candidata_am;
+        listas_quitar(victima);
     }
 
-    list_destroy(todas_paginas);
     return victima;
 }
 
+static const t_politica_reemplazo politicas[] = {
+    { "LRU",     listas_inicializar, listas_destruir, lru_on_acceso, lru_on_acceso,   lru_pick_victim,     listas_quitar },
+    { "CLOCK",   listas_inicializar, listas_destruir, clock_on_hit,  clock_on_insert, clock_pick_victim,   clock_on_remove },
+    { "CLOCK-M", listas_inicializar, listas_destruir, clock_on_hit,  clock_on_insert, clock_m_pick_victim, clock_on_remove },
+    { "ARC",     listas_inicializar, listas_destruir, arc_on_hit,    arc_on_insert,   arc_pick_victim,     listas_quitar },
+    { "2Q",      listas_inicializar, listas_destruir, q2_on_hit,     q2_on_insert,    q2_pick_victim,      listas_quitar },
+};
+
+static const t_politica_reemplazo* buscar_politica(const char* nombre) {
+    for (size_t i = 0; i < sizeof(politicas) / sizeof(politicas[0]); i++) {
+        if (strcmp(politicas[i].nombre, nombre) == 0)
+            return &politicas[i];
+    }
+    return NULL;
+}
+
 // Liberar marco y devolver a la lista de libres
 static void liberar_marco(uint32_t marco) {
     list_add(memoria->marcos_libres, (void*)(intptr_t)marco);
 }
 
-// Obtener marco libre o aplicar reemplazo
-static uint32_t obtener_marco_libre_o_reemplazar(void) {
+// Obtener marco libre o aplicar reemplazo para la página (file_tag, nro_pagina).
+// WRITE escribe directo al Storage, así que la víctima nunca tiene nada pendiente:
+// su marco se reusa sin escribirla.
+static uint32_t obtener_marco_libre_o_reemplazar(const char* file_tag, uint32_t nro_pagina) {
     // Primero intentar obtener marco libre
     if (!list_is_empty(memoria->marcos_libres)) {
         uint32_t marco = (uint32_t)(intptr_t)list_remove(memoria->marcos_libres, 0);
@@ -303,33 +608,18 @@ static uint32_t obtener_marco_libre_o_reemplazar(void) {
     log_info(logger, "⚠ MEMORIA LLENA - Aplicando algoritmo de reemplazo: %s", 
              memoria->algoritmo);
 
-    t_pagina* victima = NULL;
-
-    if (strcmp(memoria->algoritmo, "LRU") == 0) {
-        victima = seleccionar_victima_lru();
-    } else if (strcmp(memoria->algoritmo, "CLOCK") == 0 || 
-               strcmp(memoria->algoritmo, "CLOCK-M") == 0) {
-        victima = seleccionar_victima_clock();
-    } else {
-        log_error(logger, "Algoritmo de reemplazo desconocido: %s", memoria->algoritmo);
-        return (uint32_t)-1;
-    }
+    t_pagina* victima = memoria->politica->pick_victim(buscar_pagina_existente(file_tag, nro_pagina));
 
     if (!victima) {
         log_error(logger, "No se pudo seleccionar página víctima");
         return (uint32_t)-1;
     }
 
-    log_info(logger, "Página víctima: %s:%u (marco %u, modificada=%s)", 
-             victima->file_tag, victima->nro_pagina, victima->marco,
-             victima->modificada ? "SÍ" : "NO");
-
-    // Si está modificada, escribir al Storage
-    if (victima->modificada) {
-        escribir_pagina_modificada_a_storage(victima);
-    }
+    log_info(logger, "Página víctima: %s:%u (marco %u)", 
+             victima->file_tag, victima->nro_pagina, victima->marco);
 
     uint32_t marco_liberado = victima->marco;
+    registrar_evento(victima->file_tag, EVENTO_DESALOJO, 0);
 
     // Marcar página como no presente
     victima->presente = false;
@@ -354,16 +644,15 @@ void memory_cargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* b
     t_pagina* pagina = memory_buscar_pagina(file_tag, nro_pagina);
 
     if (pagina && pagina->presente) {
-        // Ya está cargada, solo actualizar timestamp
+        // Ya está cargada, cuenta como acceso
         log_debug(logger, "Página %s:%u ya presente en marco %u", 
                  file_tag, nro_pagina, pagina->marco);
-        pagina->last_used = memory_timestamp();
-        pagina->usada = true;
+        memoria->politica->on_hit(pagina);
         return;
     }
 
     // Obtener marco (libre o mediante reemplazo)
-    uint32_t marco = obtener_marco_libre_o_reemplazar();
+    uint32_t marco = obtener_marco_libre_o_reemplazar(file_tag, nro_pagina);
 
     if (marco == (uint32_t)-1) {
         log_error(logger, "CRÍTICO: No se pudo obtener marco para %s:%u", 
@@ -371,6 +660,9 @@ void memory_cargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* b
         return;
     }
 
+    // La política pudo descartar la entrada de la página (fantasma de ARC o 2Q)
+    pagina = memory_buscar_pagina(file_tag, nro_pagina);
+
     // Si la página no existe, crearla
     if (!pagina) {
         pagina = malloc(sizeof(t_pagina));
@@ -381,6 +673,8 @@ void memory_cargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* b
         pagina->usada = false;
         pagina->marco = (uint32_t)-1;
         pagina->last_used = 0;
+        pagina->lista_reemplazo = LISTA_NINGUNA;
+        pagina->fijaciones = 0;
 
         t_tabla_paginas_interna* tabla = memory_get_tabla(file_tag);
         list_add(tabla->paginas, pagina);
@@ -406,17 +700,193 @@ void memory_cargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* b
     pagina->presente = true;
     pagina->marco = marco;
     pagina->modificada = false;
-    pagina->usada = true;
-    pagina->last_used = memory_timestamp();
+    memoria->politica->on_insert(pagina);
 
     log_info(logger, "✓ Página %s:%u cargada en marco %u", file_tag, nro_pagina, marco);
 }
 
+// Carga una página traída por prefetch solo si hay un marco libre (nunca reemplaza)
+bool memory_precargar_pagina(const char* file_tag, uint32_t nro_pagina, t_buffer* buffer) {
+    if (!memoria || list_is_empty(memoria->marcos_libres)) return false;
+
+    t_pagina* pagina = memory_buscar_pagina(file_tag, nro_pagina);
+    if (pagina && pagina->presente) return true;
+
+    memory_cargar_pagina(file_tag, nro_pagina, buffer);
+    registrar_evento(file_tag, EVENTO_PRECARGA, 0);
+
+    // Hasta que la query la lea, la página precargada es la primera candidata para CLOCK
+    pagina = memory_buscar_pagina(file_tag, nro_pagina);
+    if (pagina) pagina->usada = false;
+
+    return pagina && pagina->presente;
+}
+
+// La generación se guarda en el puntero del diccionario (sin entrada = 0)
+uint32_t memory_generacion_archivo(const char* file_tag) {
+    if (!memoria) return 0;
+    return (uint32_t)(intptr_t)dictionary_get(memoria->generaciones, (char*)file_tag);
+}
+
+// Se llama con la memoria tomada justo antes de enviar la modificación: los pedidos de
+// página enviados antes quedan viejos y los que se envíen después ya la ven
+void memory_invalidar_lecturas(const char* file_tag) {
+    if (!memoria) return;
+    uint32_t generacion = memory_generacion_archivo(file_tag) + 1;
+    dictionary_put(memoria->generaciones, (char*)file_tag, (void*)(intptr_t)generacion);
+}
+
+// Mantiene coherentes las páginas presentes cuando un WRITE se hace directo en el Storage.
+// Se llama con cada WRITE que el Storage confirmó, así que también lo cuenta en las métricas.
+void memory_actualizar_rango(const char* file_tag, uint32_t offset, const void* datos, uint32_t size) {
+    if (!memoria || size == 0) return;
+
+    registrar_evento(file_tag, EVENTO_ESCRITURA, size);
+
+    uint32_t fin = offset + size;
+
+    for (uint32_t nro = offset / memoria->tam_pagina; nro * memoria->tam_pagina < fin; nro++) {
+        t_pagina* pagina = memory_buscar_pagina(file_tag, nro);
+        if (!pagina || !pagina->presente) continue;
+
+        uint32_t inicio_pagina = nro * memoria->tam_pagina;
+        uint32_t desde = offset > inicio_pagina ? offset : inicio_pagina;
+        uint32_t hasta = fin < inicio_pagina + memoria->tam_pagina ? fin : inicio_pagina + memoria->tam_pagina;
+
+        memcpy((char*)memory_get_marco_ptr(pagina->marco) + (desde - inicio_pagina),
+               (const char*)datos + (desde - offset), hasta - desde);
+
+        log_debug(logger, "Página %s:%u actualizada en marco %u (%u bytes)",
+                  file_tag, nro, pagina->marco, hasta - desde);
+    }
+}
+
+
+// FUNCIONES DE MÉTRICAS
+static void sumar_evento(t_metricas_memoria* m, t_evento_memoria evento, uint32_t bytes) {
+    switch (evento) {
+        case EVENTO_HIT:             m->hits++; break;
+        case EVENTO_MISS:            m->misses++; break;
+        case EVENTO_PRECARGA:        m->precargas++; break;
+        case EVENTO_DESALOJO:        m->desalojos++; break;
+        case EVENTO_ESCRITURA:       m->escrituras++; m->bytes_escritos += bytes; break;
+    }
+}
+
+static t_metricas_memoria* metricas_de_archivo(t_dictionary* metricas, const char* file_tag) {
+    t_metricas_memoria* m = dictionary_get(metricas, (char*)file_tag);
+    if (!m) {
+        m = calloc(1, sizeof(t_metricas_memoria));
+        dictionary_put(metricas, (char*)file_tag, m);
+    }
+    return m;
+}
+
+static void registrar_evento(const char* file_tag, t_evento_memoria evento, uint32_t bytes) {
+    pthread_mutex_lock(&memoria->mutex_metricas);
+    sumar_evento(&memoria->metricas, evento, bytes);
+    sumar_evento(metricas_de_archivo(memoria->metricas_por_archivo, file_tag), evento, bytes);
+    if (perfil_query) {
+        sumar_evento(&perfil_query->metricas, evento, bytes);
+        sumar_evento(metricas_de_archivo(perfil_query->por_archivo, file_tag), evento, bytes);
+    }
+    pthread_mutex_unlock(&memoria->mutex_metricas);
+}
+
+static double hit_ratio(const t_metricas_memoria* m) {
+    uint64_t accesos = m->hits + m->misses;
+    return accesos ? (100.0 * m->hits) / accesos : 0.0;
+}
+
+static void log_metricas(const char* titulo, const t_metricas_memoria* m) {
+    log_info(logger, "%s: hits=%lu misses=%lu (hit ratio %.1f%%) precargas=%lu desalojos=%lu escrituras=%lu (%lu bytes)",
+             titulo, (unsigned long)m->hits, (unsigned long)m->misses, hit_ratio(m),
+             (unsigned long)m->precargas, (unsigned long)m->desalojos,
+             (unsigned long)m->escrituras, (unsigned long)m->bytes_escritos);
+}
+
+static void log_metricas_por_archivo(t_dictionary* metricas) {
+    t_list* file_tags = dictionary_keys(metricas);
+    for (int i = 0; i < list_size(file_tags); i++) {
+        char* file_tag = list_get(file_tags, i);
+        char titulo[PATH_MAX];
+        snprintf(titulo, sizeof(titulo), "  - %s", file_tag);
+        log_metricas(titulo, dictionary_get(metricas, file_tag));
+    }
+    list_destroy(file_tags);
+}
+
+// Al empezar una query se reinicia el perfil de page faults del ejecutor que la corre
+void memory_iniciar_metricas_query(uint32_t query_id) {
+    if (!memoria) return;
+
+    pthread_mutex_lock(&memoria->mutex_metricas);
+    if (!perfil_query) {
+        perfil_query = malloc(sizeof(t_perfil_query));
+        perfil_query->por_archivo = dictionary_create();
+        list_add(memoria->perfiles_query, perfil_query);
+    }
+    perfil_query->query_id = query_id;
+    memset(&perfil_query->metricas, 0, sizeof(t_metricas_memoria));
+    dictionary_clean_and_destroy_elements(perfil_query->por_archivo, free);
+    pthread_mutex_unlock(&memoria->mutex_metricas);
+}
+
+// Serializa: [t_metricas_memoria de la query][cantidad de file_tags][file_tag, t_metricas_memoria]...
+void memory_agregar_metricas_query_a_paquete(t_paquete* paquete) {
+    if (!memoria) return;
+
+    if (!perfil_query) memory_iniciar_metricas_query(0);
+
+    pthread_mutex_lock(&memoria->mutex_metricas);
+    agregar_a_paquete(paquete, &perfil_query->metricas, sizeof(t_metricas_memoria));
+
+    t_list* file_tags = dictionary_keys(perfil_query->por_archivo);
+    uint32_t cantidad = list_size(file_tags);
+    agregar_a_paquete(paquete, &cantidad, sizeof(uint32_t));
+
+    for (int i = 0; i < list_size(file_tags); i++) {
+        char* file_tag = list_get(file_tags, i);
+        agregar_a_paquete(paquete, file_tag, strlen(file_tag) + 1);
+        agregar_a_paquete(paquete, dictionary_get(perfil_query->por_archivo, file_tag),
+                          sizeof(t_metricas_memoria));
+    }
+    list_destroy(file_tags);
+
+    log_metricas("Métricas de memoria de la query", &perfil_query->metricas);
+    pthread_mutex_unlock(&memoria->mutex_metricas);
+}
+
+void memory_dump_metricas(void) {
+    if (!memoria) return;
+
+    pthread_mutex_lock(&memoria->mutex_metricas);
+    log_info(logger, "═══ DUMP MÉTRICAS MEMORIA (%u marcos de %u bytes, algoritmo=%s) ═══",
+             memoria->cant_marcos, memoria->tam_pagina, memoria->algoritmo);
+    log_metricas("Totales", &memoria->metricas);
+    log_metricas_por_archivo(memoria->metricas_por_archivo);
+
+    // Una query por ejecutor (la que corre o la última que corrió)
+    for (int i = 0; i < list_size(memoria->perfiles_query); i++) {
+        t_perfil_query* perfil = list_get(memoria->perfiles_query, i);
+        char titulo[64];
+        snprintf(titulo, sizeof(titulo), "Query %u (actual/última)", perfil->query_id);
+        log_metricas(titulo, &perfil->metricas);
+        log_metricas_por_archivo(perfil->por_archivo);
+    }
+    log_info(logger, "═══ FIN DUMP MÉTRICAS ═══");
+    pthread_mutex_unlock(&memoria->mutex_metricas);
+}
 
 // NUEVA FUNCIÓN (para DELETE)
 void memory_liberar_archivo(const char* file_tag) {
     if (!memoria) return;
 
+    // Un READ de otro ejecutor puede estar enviando desde un marco de este archivo
+    while (archivo_tiene_fijadas(file_tag)) {
+        memory_esperar(&cond_fijaciones);
+    }
+
     log_info(logger, "Liberando páginas de: %s", file_tag);
 
     // Buscar la tabla correspondiente
@@ -451,7 +921,8 @@ void memory_liberar_archivo(const char* file_tag) {
                      pagina->marco, file_tag, pagina->nro_pagina);
         }
 
-        // Liberar página
+        // Liberar página (también de las listas de la política, incluidas las fantasma)
+        memoria->politica->on_remove(pagina);
         free(pagina->file_tag);
         list_remove(tabla->paginas, i);
         free(pagina);
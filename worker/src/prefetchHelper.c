@@ -0,0 +1,245 @@
+#include "prefetchHelper.h"
+#include "memoryHelper.h"
+
+// CONSTANTES
+#define PREFETCH_VENTANA_INICIAL 2
+
+extern t_log* logger;
+
+static uint32_t max_paginas_prefetch = 0;
+static t_dictionary* estados = NULL;    // file_tag -> t_prefetch_estado*
+static t_list* pendientes = NULL;       // t_prefetch_pendiente* en orden de envío
+
+// FUNCIONES DE INICIALIZACIÓN Y DESTRUCCIÓN
+void prefetch_init(uint32_t max_paginas) {
+    max_paginas_prefetch = max_paginas;
+    estados = dictionary_create();
+    pendientes = list_create();
+
+    if (max_paginas == 0) {
+        log_info(logger, "Prefetch secuencial deshabilitado (PREFETCH_MAX_PAGINAS=0)");
+    } else {
+        log_info(logger, "Prefetch secuencial habilitado: ventana inicial=%u, máxima=%u páginas",
+                 PREFETCH_VENTANA_INICIAL < max_paginas ? PREFETCH_VENTANA_INICIAL : max_paginas,
+                 max_paginas);
+    }
+}
+
+static void destruir_estado(void* elemento) {
+    t_prefetch_estado* estado = elemento;
+    free(estado->file_tag);
+    free(estado);
+}
+
+static void destruir_pendiente(void* elemento) {
+    t_prefetch_pendiente* pendiente = elemento;
+    free(pendiente->file_tag);
+    free(pendiente);
+}
+
+void prefetch_destroy(void) {
+    if (!estados) return;
+
+    dictionary_destroy_and_destroy_elements(estados, destruir_estado);
+    list_destroy_and_destroy_elements(pendientes, destruir_pendiente);
+    estados = NULL;
+    pendientes = NULL;
+}
+
+// FUNCIONES AUXILIARES
+static t_prefetch_pendiente* buscar_pendiente(const char* file_tag, uint32_t nro_pagina) {
+    for (int i = 0; i < list_size(pendientes); i++) {
+        t_prefetch_pendiente* p = list_get(pendientes, i);
+        if (p->nro_pagina == nro_pagina && strcmp(p->file_tag, file_tag) == 0)
+            return p;
+    }
+    return NULL;
+}
+
+static t_prefetch_pendiente* buscar_pendiente_por_id(uint32_t id_pedido) {
+    for (int i = 0; i < list_size(pendientes); i++) {
+        t_prefetch_pendiente* p = list_get(pendientes, i);
+        if (p->id_pedido == id_pedido)
+            return p;
+    }
+    return NULL;
+}
+
+// Pide al Storage hasta 'cantidad' páginas desde 'desde' sin esperar las respuestas.
+// Solo se usan marcos libres: el prefetch nunca desaloja páginas de la memoria.
+static uint32_t pedir_ventana(t_prefetch_estado* estado, uint32_t desde, uint32_t cantidad) {
+    uint32_t libres = memory_cant_marcos_libres();
+    uint32_t reservados = (uint32_t)list_size(pendientes);
+    uint32_t disponibles = libres > reservados ? libres - reservados : 0;
+    uint32_t pedidas = 0;
+    uint32_t pagina = desde;
+
+    for (; pagina < desde + cantidad && pedidas < disponibles; pagina++) {
+        t_pagina* p = memory_buscar_pagina(estado->file_tag, pagina);
+        if ((p && p->presente) || buscar_pendiente(estado->file_tag, pagina))
+            continue;
+
+        uint32_t generacion = memory_generacion_archivo(estado->file_tag);
+        uint32_t id_pedido = enviar_pedido_pagina_storage(estado->file_tag, pagina);
+        if (id_pedido == 0) {
+            log_warning(logger, "Prefetch: no se pudo pedir %s pag=%u al Storage", estado->file_tag, pagina);
+            break;
+        }
+
+        t_prefetch_pendiente* pendiente = malloc(sizeof(t_prefetch_pendiente));
+        pendiente->file_tag = strdup(estado->file_tag);
+        pendiente->nro_pagina = pagina;
+        pendiente->id_pedido = id_pedido;
+        pendiente->esperada = false;
+        pendiente->generacion = generacion;
+        list_add(pendientes, pendiente);
+        pedidas++;
+    }
+
+    estado->proxima_pagina = pagina;
+    return pedidas;
+}
+
+// FUNCIONES DE PREFETCH
+void prefetch_registrar_acceso(const char* file_tag, uint32_t nro_pagina) {
+    if (max_paginas_prefetch == 0 || !estados || socket_storage < 0) return;
+
+    t_prefetch_estado* estado = dictionary_get(estados, (char*)file_tag);
+    if (!estado) {
+        estado = malloc(sizeof(t_prefetch_estado));
+        estado->file_tag = strdup(file_tag);
+        estado->hay_acceso_previo = false;
+        estado->ultima_pagina = 0;
+        estado->ventana = 0;
+        estado->proxima_pagina = 0;
+        estado->marcador = 0;
+        dictionary_put(estados, estado->file_tag, estado);
+    }
+
+    // Leer desde el inicio del archivo también se considera secuencial
+    bool secuencial = estado->hay_acceso_previo
+        ? (nro_pagina == estado->ultima_pagina || nro_pagina == estado->ultima_pagina + 1)
+        : nro_pagina == 0;
+
+    estado->hay_acceso_previo = true;
+    estado->ultima_pagina = nro_pagina;
+
+    if (!secuencial) {
+        // Acceso aleatorio: se descarta la ventana acumulada
+        estado->ventana = 0;
+        return;
+    }
+
+    if (estado->ventana == 0) {
+        estado->ventana = PREFETCH_VENTANA_INICIAL < max_paginas_prefetch ?
+                          PREFETCH_VENTANA_INICIAL : max_paginas_prefetch;
+        estado->proxima_pagina = nro_pagina + 1;
+    } else if (nro_pagina < estado->marcador) {
+        // Todavía se está consumiendo la ventana anterior
+        return;
+    } else {
+        // Se alcanzó el marcador: la secuencia continúa, se duplica la ventana
+        estado->ventana = estado->ventana * 2 < max_paginas_prefetch ?
+                          estado->ventana * 2 : max_paginas_prefetch;
+    }
+
+    if (estado->proxima_pagina <= nro_pagina)
+        estado->proxima_pagina = nro_pagina + 1;
+
+    uint32_t desde = estado->proxima_pagina;
+    uint32_t pedidas = pedir_ventana(estado, desde, estado->ventana);
+    estado->marcador = desde;
+
+    if (pedidas > 0) {
+        log_info(logger, "Prefetch %s: ventana=%u, %u páginas pedidas desde pag=%u",
+                 file_tag, estado->ventana, pedidas, desde);
+    }
+}
+
+// Carga en un marco libre la página que trae la respuesta de un pedido de prefetch
+void prefetch_completar(t_respuesta_storage* respuesta) {
+    t_prefetch_pendiente* pendiente = pendientes ? buscar_pendiente_por_id(respuesta->id_pedido) : NULL;
+    if (!pendiente) {
+        destruir_respuesta_storage(respuesta);
+        return;
+    }
+    list_remove_element(pendientes, pendiente);
+
+    t_buffer* buffer = respuesta->payload;
+    if (memory_generacion_archivo(pendiente->file_tag) != pendiente->generacion) {
+        // El archivo se modificó después del pedido: la página puede ser anterior
+        log_debug(logger, "Prefetch: %s pag=%u pedida antes de una modificación, se descarta",
+                  pendiente->file_tag, pendiente->nro_pagina);
+    } else if (respuesta->estado == OP_OK && buffer && buffer->size == WORKER_BLOCK_SIZE) {
+        if (!memory_precargar_pagina(pendiente->file_tag, pendiente->nro_pagina, buffer)) {
+            log_debug(logger, "Prefetch: sin marco libre para %s pag=%u, se descarta",
+                      pendiente->file_tag, pendiente->nro_pagina);
+        }
+    } else {
+        log_warning(logger, "Prefetch: página %s pag=%u no disponible en Storage",
+                    pendiente->file_tag, pendiente->nro_pagina);
+    }
+
+    destruir_respuesta_storage(respuesta);
+    destruir_pendiente(pendiente);
+}
+
+// Espera la respuesta de una página pedida por adelantado. Devuelve false si no estaba en vuelo.
+bool prefetch_esperar_pagina(const char* file_tag, uint32_t nro_pagina) {
+    t_prefetch_pendiente* pendiente = pendientes ? buscar_pendiente(file_tag, nro_pagina) : NULL;
+    if (!pendiente) return false;
+
+    uint32_t id_pedido = pendiente->id_pedido;
+
+    // La espera otro ejecutor: alcanza con que deje de estar en vuelo
+    if (pendiente->esperada) {
+        while (buscar_pendiente_por_id(id_pedido)) {
+            storage_esperar_novedad();
+        }
+        return true;
+    }
+
+    pendiente->esperada = true;
+    t_respuesta_storage* respuesta = storage_esperar_respuesta(id_pedido);
+    if (!respuesta) {
+        pendiente = buscar_pendiente_por_id(id_pedido);
+        if (pendiente) {
+            list_remove_element(pendientes, pendiente);
+            destruir_pendiente(pendiente);
+        }
+    } else {
+        prefetch_completar(respuesta);
+    }
+
+    storage_avisar_novedad();
+    return true;
+}
+
+// Consume las respuestas de todos los pedidos en vuelo y las carga en marcos libres.
+// Debe llamarse antes de modificar un archivo, para no precargar datos viejos.
+void prefetch_drenar(void) {
+    if (!pendientes) return;
+
+    while (!list_is_empty(pendientes)) {
+        t_prefetch_pendiente* pendiente = list_get(pendientes, 0);
+        prefetch_esperar_pagina(pendiente->file_tag, pendiente->nro_pagina);
+    }
+}
+
+bool prefetch_hay_pendientes(void) {
+    return pendientes && !list_is_empty(pendientes);
+}
+
+bool prefetch_es_pedido(uint32_t id_pedido) {
+    return pendientes && buscar_pendiente_por_id(id_pedido) != NULL;
+}
+
+bool prefetch_pagina_en_vuelo(const char* file_tag, uint32_t nro_pagina) {
+    return pendientes && buscar_pendiente(file_tag, nro_pagina) != NULL;
+}
+
+// Para DELETE y TRUNCATE: el patrón de acceso anterior deja de ser válido
+void prefetch_olvidar_archivo(const char* file_tag) {
+    if (!estados || !dictionary_has_key(estados, (char*)file_tag)) return;
+    dictionary_remove_and_destroy(estados, (char*)file_tag, destruir_estado);
+}
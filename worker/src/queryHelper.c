@@ -1,28 +1,28 @@
 #include "queryHelper.h"
 #include "memoryHelper.h"
+#include "prefetchHelper.h"
 
 // CONSTANTES
 #define FILES_DIR "files"
 #define METADATA_FILENAME "metadata.config"
+#define READ_MAX_PEDIDOS_EN_VUELO 8   // Páginas de un READ pedidas por adelantado al Storage
 
-static bool ejecutar_CREATE(uint32_t id, char* file_tag);
-static bool ejecutar_TRUNCATE(uint32_t id, char* file_tag, char* size);
-static bool ejecutar_WRITE(uint32_t id, char* file_tag, char* direccion, char* contenido);
-static bool ejecutar_READ(uint32_t id, char* file_tag, char* direccion, char* size);
-static bool ejecutar_TAG(uint32_t id, char* origen, char* destino);
-static bool ejecutar_COMMIT(uint32_t id, char* file_tag);
-static bool ejecutar_FLUSH(uint32_t id, char* file_tag);
-static bool ejecutar_DELETE(uint32_t id, char* file_tag);
+static bool ejecutar_CREATE(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_TRUNCATE(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_WRITE(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_READ(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_TAG(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_COMMIT(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_FLUSH(uint32_t id, const t_instruccion_compilada* inst);
+static bool ejecutar_DELETE(uint32_t id, const t_instruccion_compilada* inst);
 
-static t_query_instruccion instruccion_from_string(const char* str);
-extern bool recibir_respuesta_storage_simple(t_log* logger, int socket);
-extern t_buffer* recibir_pagina_storage(t_log* logger, int socket);
-
-uint32_t current_pc = 0;
+// Query e instrucción del ejecutor (van en el encabezado de los pedidos al Storage)
+__thread uint32_t current_pc = 0;
+__thread uint32_t current_query_id = 0;
 
 // FUNCIONES AUXILIARES
 
-static t_query_instruccion instruccion_from_string(const char* str) {
+t_query_instruccion instruccion_from_string(const char* str) {
     if (strcmp(str, "CREATE") == 0) return QUERY_INST_CREATE;
     if (strcmp(str, "TRUNCATE") == 0) return QUERY_INST_TRUNCATE;
     if (strcmp(str, "WRITE") == 0) return QUERY_INST_WRITE;
@@ -35,112 +35,154 @@ static t_query_instruccion instruccion_from_string(const char* str) {
     return QUERY_INST_INVALID;
 }
 
-// Función auxiliar para parsear file:tag y separar en filename y tag
-static void parse_file_tag(const char* file_tag_str, char** filename, char** tag) {
-    if (!file_tag_str) {
-        *filename = strdup("unknown");
-        *tag = strdup("BASE");
-        return;
+// Devuelve el inicio de la página para armar el resultado de un READ sin copiarla. Si la
+// página quedó en un marco se la fija (*fijada) para que no se desaloje hasta enviar el
+// resultado; si no hubo marco disponible se devuelve la página recibida (buffer del pool),
+// que el llamador devuelve con pool_buffers_devolver.
+// id_pedido es el pedido de la página ya enviado al Storage (con la generación del archivo
+// en ese momento), o 0 si todavía no se pidió.
+static void* obtener_pagina_lectura(uint32_t id, const char* file_tag, uint32_t nro_pagina,
+                                    uint32_t id_pedido, uint32_t generacion, t_pagina** fijada) {
+    *fijada = NULL;
+    t_pagina* pagina = memory_buscar_pagina(file_tag, nro_pagina);
+
+    // La página puede venir en camino como parte de una ventana de prefetch
+    if ((!pagina || !pagina->presente) && id_pedido == 0) {
+        prefetch_esperar_pagina(file_tag, nro_pagina);
     }
-    
-    char* copia = strdup(file_tag_str);
-    char* separador = strchr(copia, ':');
-    
-    if (separador) {
-        *separador = '\0';
-        *filename = strdup(copia);
-        *tag = strdup(separador + 1);
-        
-        // Validar que el tag no esté vacío
-        if (strlen(*tag) == 0) {
-            free(*tag);
-            *tag = strdup("BASE");
+
+    void* marco = memory_leer(file_tag, nro_pagina);
+
+    if (marco && id_pedido != 0) {
+        // La trajo el prefetch mientras tanto: el pedido propio ya no hace falta
+        storage_descartar_respuesta(id_pedido);
+    }
+
+    if (!marco) {
+        log_info(logger, "## Query %u: PAGE FAULT %s pag=%u - se solicita al Storage", id, file_tag, nro_pagina);
+
+        t_buffer* bloque_buffer = NULL;
+        while (!bloque_buffer) {
+            if (id_pedido == 0) {
+                generacion = memory_generacion_archivo(file_tag);
+                id_pedido = enviar_pedido_pagina_storage(file_tag, nro_pagina);
+                if (id_pedido == 0) {
+                    return NULL;
+                }
+            }
+
+            bloque_buffer = recibir_pagina_storage(logger, id_pedido);
+            id_pedido = 0;
+            if (!bloque_buffer || bloque_buffer->size == 0 || bloque_buffer->stream == NULL) {
+                log_warning(logger, "## Query %u: Bloque %u vacío o error del Storage", id, nro_pagina);
+                if (bloque_buffer) {
+                    pool_buffers_devolver(bloque_buffer->stream);
+                    free(bloque_buffer);
+                }
+                return NULL;
+            }
+
+            // Otro ejecutor modificó el archivo mientras se esperaba: la respuesta puede
+            // ser anterior a esa escritura y se vuelve a pedir
+            if (memory_generacion_archivo(file_tag) != generacion) {
+                log_info(logger, "## Query %u: %s pag=%u cambió durante la lectura - se vuelve a pedir",
+                         id, file_tag, nro_pagina);
+                pool_buffers_devolver(bloque_buffer->stream);
+                free(bloque_buffer);
+                bloque_buffer = NULL;
+            }
         }
+
+        memory_cargar_pagina(file_tag, nro_pagina, bloque_buffer);
+        pagina = memory_buscar_pagina(file_tag, nro_pagina);
+
+        if (!pagina || !pagina->presente) {
+            // Sin marco disponible (todos fijados): se responde con lo recibido
+            void* copia = bloque_buffer->stream;
+            free(bloque_buffer);
+            prefetch_registrar_acceso(file_tag, nro_pagina);
+            return copia;
+        }
+
+        pool_buffers_devolver(bloque_buffer->stream);
+        free(bloque_buffer);
+        marco = memory_get_marco_ptr(pagina->marco);
     } else {
-        // Si no hay ':', usar el string completo como filename y tag por defecto
-        *filename = strdup(copia);
-        *tag = strdup("BASE");
+        pagina = memory_buscar_pagina(file_tag, nro_pagina);
     }
-    
-    free(copia);
-    
-    log_debug(logger, "Parseado file:tag: '%s' -> filename='%s', tag='%s'", 
-              file_tag_str, *filename, *tag);
-}
 
-// Función auxiliar para enviar string al storage
-static void enviar_string_storage(const char* str, int socket) {
-    uint32_t tam_str = htonl((uint32_t)(strlen(str) + 1));
-    send(socket, &tam_str, sizeof(uint32_t), MSG_NOSIGNAL);
-    send(socket, str, strlen(str) + 1, MSG_NOSIGNAL);
+    memory_fijar_pagina(pagina);
+    *fijada = pagina;
+
+    // Detectar acceso secuencial y pedir la ventana siguiente
+    prefetch_registrar_acceso(file_tag, nro_pagina);
+    return marco;
 }
 
-// Función auxiliar para enviar PC al Storage
-static void enviar_pc_a_storage(uint32_t pc, int socket) {
-    if (socket < 0) {
-        log_warning(logger, "Socket de storage inválido, saltando envío de PC");
-        return;
+// Un tramo del resultado de un READ: t_paquete RESULTADO_READ_PARCIAL con
+// [query_id][file_tag][offset][ultimo][datos]. Los datos salen directo del marco
+// y el Master los reenvía al Query Control a medida que llegan.
+// Se envía con la memoria suelta: si el Master pausó esta lectura o el socket se llena,
+// los demás ejecutores siguen. Los datos vienen de una página fijada o de un buffer propio.
+static bool enviar_tramo_lectura(uint32_t query_id, const char* file_tag, uint32_t offset,
+                                 bool ultimo, const void* datos, uint32_t tam) {
+    static __thread t_trama* trama = NULL;
+    if (!trama) trama = trama_crear(256);
+    trama_reiniciar(trama);
+
+    uint32_t es_ultimo = ultimo ? 1 : 0;
+    trama_iniciar_paquete(trama, RESULTADO_READ_PARCIAL);
+    trama_agregar_a_paquete(trama, &query_id, sizeof(uint32_t));
+    trama_agregar_a_paquete(trama, file_tag, strlen(file_tag) + 1);
+    trama_agregar_a_paquete(trama, &offset, sizeof(uint32_t));
+    trama_agregar_a_paquete(trama, &es_ultimo, sizeof(uint32_t));
+    trama_referenciar_en_paquete(trama, datos, tam);
+    trama_cerrar_paquete(trama);
+
+    memory_soltar();
+    esperar_lectura_habilitada(query_id);
+    bool enviado = enviar_trama_master(trama);
+    memory_tomar();
+
+    if (!enviado) {
+        log_error(logger, "Error al enviar resultado READ al Master - Query %u: %s", query_id, strerror(errno));
+        return false;
     }
 
-    log_info(logger, "📤 Enviando PC al Storage: %u", pc);
-    
-    // Enviar código especial para PC
-    int cod_op_pc = htonl(OP_PROGRAM_COUNTER);
-    ssize_t bytes_sent = send(socket, &cod_op_pc, sizeof(int), MSG_NOSIGNAL);
-    
-    if (bytes_sent <= 0) {
-        log_error(logger, "Error al enviar código OP_PROGRAM_COUNTER al Storage");
-        return;
-    }
-    
-    // Enviar el valor del PC
-    uint32_t pc_network = htonl(pc);
-    bytes_sent = send(socket, &pc_network, sizeof(uint32_t), MSG_NOSIGNAL);
-    
-    if (bytes_sent <= 0) {
-        log_error(logger, "Error al enviar valor de PC al Storage");
-        return;
-    }
-    
-    // ESPERAR BREVE CONFIRMACIÓN
-    usleep(10000); // 10ms para que el Storage procese
-    
-    log_info(logger, "PC enviado exitosamente al Storage: %u", pc);
+    log_debug(logger, "Tramo READ enviado al Master - Query %u | File: %s | offset=%u | %u bytes%s",
+              query_id, file_tag, offset, tam, ultimo ? " (último)" : "");
+    return true;
 }
 
-// FUNCIONES DE EJECUCION
-bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
-    log_info(logger, "## Query %u: Ejecutando instrucción: %s", id, line);
-    
-    if (!line || strlen(line) == 0) return true;
+// Mantiene pedidas por adelantado las páginas que faltan de [bloque_actual, bloque_actual +
+// READ_MAX_PEDIDOS_EN_VUELO): así las respuestas que llegan antes de tiempo no retienen
+// en el Worker más que esa ventana. pedidos es un anillo indexado por nro de página.
+static void pedir_ventana_lectura(const char* file_tag, uint32_t* pedidos, uint32_t* generaciones,
+                                  uint32_t* proximo, uint32_t bloque_actual, uint32_t bloque_final) {
+    for (; *proximo <= bloque_final && *proximo - bloque_actual < READ_MAX_PEDIDOS_EN_VUELO; (*proximo)++) {
+        uint32_t* pedido = &pedidos[*proximo % READ_MAX_PEDIDOS_EN_VUELO];
+        *pedido = 0;
 
-    char* copia = strdup(line);
-    char* token = strtok(copia, " ");
-    if (!token) {
-        free(copia);
-        return true;
+        t_pagina* pagina = memory_buscar_pagina(file_tag, *proximo);
+        if (pagina && pagina->presente) continue;
+        if (prefetch_pagina_en_vuelo(file_tag, *proximo)) continue;
+
+        generaciones[*proximo % READ_MAX_PEDIDOS_EN_VUELO] = memory_generacion_archivo(file_tag);
+        *pedido = enviar_pedido_pagina_storage(file_tag, *proximo);
     }
+}
 
-    // LOG DETALLADO DE PARSING
-    log_info(logger, "## Query %u: Token principal: '%s'", id, token);
-    t_query_instruccion inst = instruccion_from_string(token);
-    
-    char* arg1 = strtok(NULL, " ");
-    char* arg2 = strtok(NULL, " ");
-    char* arg3 = strtok(NULL, " ");
-
-    log_info(logger, "## Query %u: Args: '%s' '%s' '%s'", id, 
-             arg1 ? arg1 : "NULL", 
-             arg2 ? arg2 : "NULL", 
-             arg3 ? arg3 : "NULL");
+// FUNCIONES DE EJECUCION
+bool ejecutar_instruccion(uint32_t id, const t_instruccion_compilada* inst, uint32_t pc) {
+    log_info(logger, "## Query %u: Ejecutando instrucción: %s", id, inst->linea);
     
     bool resultado = true;
     bool es_operacion_critica = false;
     
-    switch (inst) {
+    switch (inst->tipo) {
         case QUERY_INST_CREATE:
-            if (arg1) {
-                resultado = ejecutar_CREATE(id, arg1);
+            if (inst->cant_args >= 1) {
+                resultado = ejecutar_CREATE(id, inst);
                 es_operacion_critica = true; // CREATE es crítico
             } else {
                 log_error(logger, "## Query %u: CREATE requiere parámetro file:tag", id);
@@ -150,8 +192,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_TRUNCATE:
-            if (arg1 && arg2) {
-                resultado = ejecutar_TRUNCATE(id, arg1, arg2);
+            if (inst->cant_args >= 2) {
+                resultado = ejecutar_TRUNCATE(id, inst);
             } else {
                 log_error(logger, "## Query %u: TRUNCATE requiere parámetros file:tag y size", id);
                 resultado = false;
@@ -159,8 +201,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_WRITE:
-            if (arg1 && arg2 && arg3) {
-                resultado = ejecutar_WRITE(id, arg1, arg2, arg3);
+            if (inst->cant_args >= 3) {
+                resultado = ejecutar_WRITE(id, inst);
             } else {
                 log_error(logger, "## Query %u: WRITE requiere parámetros file:tag, dirección y contenido", id);
                 resultado = false;
@@ -168,9 +210,9 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_READ:
-            if (arg1 && arg2 && arg3) {
-                log_info(logger, "## Query %u: EJECUTANDO READ %s %s %s", id, arg1, arg2, arg3);
-                resultado = ejecutar_READ(id, arg1, arg2, arg3);
+            if (inst->cant_args >= 3) {
+                log_info(logger, "## Query %u: EJECUTANDO READ %s %u %u", id, inst->file_tag, inst->direccion, inst->tamanio);
+                resultado = ejecutar_READ(id, inst);
                 // READ NO ES CRÍTICO - puede fallar sin detener query
                 es_operacion_critica = false;
             } else {
@@ -181,8 +223,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_TAG:
-            if (arg1 && arg2) {
-                resultado = ejecutar_TAG(id, arg1, arg2);
+            if (inst->cant_args >= 2) {
+                resultado = ejecutar_TAG(id, inst);
             } else {
                 log_error(logger, "## Query %u: TAG requiere parámetros origen y destino", id);
                 resultado = false;
@@ -190,8 +232,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_COMMIT:
-            if (arg1) {
-                resultado = ejecutar_COMMIT(id, arg1);
+            if (inst->cant_args >= 1) {
+                resultado = ejecutar_COMMIT(id, inst);
             } else {
                 log_error(logger, "## Query %u: COMMIT requiere parámetro file:tag", id);
                 resultado = false;
@@ -199,8 +241,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_FLUSH:
-            if (arg1) {
-                resultado = ejecutar_FLUSH(id, arg1);
+            if (inst->cant_args >= 1) {
+                resultado = ejecutar_FLUSH(id, inst);
             } else {
                 log_error(logger, "## Query %u: FLUSH requiere parámetro file:tag", id);
                 resultado = false;
@@ -208,8 +250,8 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         case QUERY_INST_DELETE:
-            if (arg1) {
-                resultado = ejecutar_DELETE(id, arg1);
+            if (inst->cant_args >= 1) {
+                resultado = ejecutar_DELETE(id, inst);
             } else {
                 log_error(logger, "## Query %u: DELETE requiere parámetro file:tag", id);
                 resultado = false;
@@ -223,13 +265,11 @@ bool ejecutar_instruccion(uint32_t id, const char* line, uint32_t pc) {
             break;
             
         default:
-            log_error(logger, "## Query %u: Instrucción desconocida: %s", id, line);
+            log_error(logger, "## Query %u: Instrucción desconocida: %s", id, inst->linea);
             resultado = false;
             break;
     }
 
-    free(copia);
-    
     // SOLO DETENER QUERY SI ES UNA OPERACIÓN CRÍTICA QUE FALLÓ
     if (!resultado && es_operacion_critica) {
         log_error(logger, "## Query %u: Error crítico en instrucción, abortando ejecución", id);
@@ -251,88 +291,34 @@ void enviar_mensaje_storage(op_code codigo, void* buffer, size_t size, int socke
     eliminar_paquete(paquete);
 }
 
-// Función auxiliar para enviar resultado READ al Master
-void enviar_resultado_read_a_master(uint32_t query_id, const char* file_tag, const char* datos, uint32_t size) {
-    log_info(logger, "Enviando resultado READ al Master - Query %u | File: %s | Tamaño: %u bytes", 
-             query_id, file_tag, size);
-
-    if (socket_master == -1) {
-        log_error(logger, "No hay conexión con el Master");
-        return;
-    }
-
-    // PERMITIR DATOS NULL O SIZE 0 (para errores no críticos)
-    if (datos == NULL || size == 0) {
-        log_warning(logger, "Enviando resultado READ vacío para Query %u (error no crítico)", query_id);
-        // Enviar resultado vacío en lugar de no enviar nada
-        datos = "";
-        size = 0;
-    }
-    
-    // Crear paquete con RESULTADO_READ
-    t_paquete* paquete = crear_paquete(RESULTADO_READ, logger);
-    
-    if (paquete == NULL) {
-        log_error(logger, "Error al crear paquete para resultado READ");
-        return;
-    }
-    
-    // Agregar query_id (4 bytes)
-    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
-    
-    // AGREGAR FILE_TAG (asegurarse que no sea NULL)
-    const char* safe_file_tag = file_tag ? file_tag : "unknown:BASE";
-    agregar_a_paquete(paquete, (void*)safe_file_tag, strlen(safe_file_tag) + 1);
-    
-    // Agregar tamaño (4 bytes)
-    agregar_a_paquete(paquete, &size, sizeof(uint32_t));
-    
-    // Agregar datos (size bytes)
-    agregar_a_paquete(paquete, (void*)datos, size);
-    
-    // Enviar paquete al Master
-    enviar_paquete(paquete, socket_master);
-    
-    log_info(logger, "Resultado READ enviado al Master - Query %u | File: %s | Tamaño: %u bytes", 
-             query_id, safe_file_tag, size);
-    
-    eliminar_paquete(paquete);
-}
-
 // IMPLEMENTACION DE OPERACIONES
 
-static bool ejecutar_CREATE(uint32_t id, char* file_tag) {
+static bool ejecutar_CREATE(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
     log_info(logger, "## Query %u: Ejecutar CREATE %s", id, file_tag);
 
-    // Parsear file_tag en filename y tag
-    char* filename;
-    char* tag;
-    parse_file_tag(file_tag, &filename, &tag);
     
     log_info(logger, "CREATE parseado: filename='%s', tag='%s'", filename, tag);
 
-    // ENVIAR PC ANTES DE LA OPERACIÓN
-    enviar_pc_a_storage(current_pc, socket_storage);
+    prefetch_drenar();
+
+    log_info(logger, "Enviando CREATE para %s:%s al Storage", filename, tag);
+
+    // Cuerpo: filename y tag (el PC viaja en el encabezado)
+    t_trama* pedido = iniciar_pedido_storage(OP_CREATE);
+    trama_agregar_string_red(pedido, filename);
+    trama_agregar_string_red(pedido, tag);
 
-    // Enviar código de operación
-    int cod_op = htonl(OP_CREATE);
-    if (send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL) <= 0) {
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
         log_error(logger, "Error al enviar OP_CREATE al Storage");
-        free(filename);
-        free(tag);
         return false;
     }
 
-    log_info(logger, "Enviando CREATE para %s:%s al Storage", filename, tag);
-    
-    // Enviar filename
-    enviar_string_storage(filename, socket_storage);
-    
-    // Enviar tag
-    enviar_string_storage(tag, socket_storage);
-
     // Esperar respuesta
-    bool resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     // VERIFICACIÓN ESTRICTA
     if (resultado) {
@@ -343,115 +329,84 @@ static bool ejecutar_CREATE(uint32_t id, char* file_tag) {
         enviar_error_a_master(id, "CREATE falló - no se puede continuar la query");
     }
     
-    free(filename);
-    free(tag);
     return resultado;  // Si esto es false, la query debería detenerse
 }
 
-static bool ejecutar_TRUNCATE(uint32_t id, char* file_tag, char* size_str) {
-    int32_t size = (uint32_t)atoi(size_str);
+static bool ejecutar_TRUNCATE(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
+    uint32_t size = inst->tamanio;
     log_info(logger, "## Query %u: Ejecutar TRUNCATE %s %u", id, file_tag, size);
-
-    char* filename;
-    char* tag;
-    parse_file_tag(file_tag, &filename, &tag);
     
     log_info(logger, "TRUNCATE parseado: filename='%s', tag='%s', size=%u", filename, tag, size);
 
-    enviar_pc_a_storage(current_pc, socket_storage);
-
     if (socket_storage < 0) {
         log_error(logger, "Socket de storage inválido");
-        free(filename);
-        free(tag);
         return false;  // CORREGIDO: retornar false en lugar de return sin valor
     }
 
-    int cod_op = htonl(OP_TRUNCATE);
-    send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL);
+    prefetch_drenar();
 
     log_info(logger, "Enviando TRUNCATE para %s:%s al Storage", filename, tag);
     
-    enviar_string_storage(filename, socket_storage);
-    enviar_string_storage(tag, socket_storage);
-    
-    uint32_t size_network = htonl(size);
-    if (send(socket_storage, &size_network, sizeof(uint32_t), MSG_NOSIGNAL) != sizeof(uint32_t)) {
-        log_error(logger, "Error enviando tamaño en TRUNCATE");
-        free(filename);
-        free(tag);
+    t_trama* pedido = iniciar_pedido_storage(OP_TRUNCATE);
+    trama_agregar_string_red(pedido, filename);
+    trama_agregar_string_red(pedido, tag);
+    trama_agregar_uint32_red(pedido, size);
+
+    memory_invalidar_lecturas(file_tag);
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        log_error(logger, "Error enviando TRUNCATE al Storage");
         return false;  // Retornar false en lugar de return sin valor
     }
     
-    bool resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     if (resultado) {
         log_info(logger, "TRUNCATE %s:%s exitoso", filename, tag);
+        // Las páginas cacheadas pueden haber quedado fuera del nuevo tamaño
+        memory_liberar_archivo(file_tag);
+        prefetch_olvidar_archivo(file_tag);
     } else {
         log_error(logger, "Fallo TRUNCATE %s:%s", filename, tag);
         enviar_error_a_master(id, "TRUNCATE falló");
     }
     
-    free(filename);
-    free(tag);
-    usleep(50000);
     return resultado;
 }
 
-static bool ejecutar_WRITE(uint32_t id, char* file_tag, char* direccion_str, char* contenido) {
-    uint32_t offset = (uint32_t)atoi(direccion_str);
+static bool ejecutar_WRITE(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
+    const char* contenido = inst->contenido;
+    uint32_t offset = inst->direccion;
     uint32_t size = strlen(contenido);
 
     log_info(logger, "## Query %u: Ejecutar WRITE %s offset=%u size=%u contenido='%s'", 
              id, file_tag, offset, size, contenido);
 
-    // Parsear filename:tag
-    char* filename;
-    char* tag;
-    parse_file_tag(file_tag, &filename, &tag);
+    prefetch_drenar();
 
-    // ENVIAR PC
-    enviar_pc_a_storage(current_pc, socket_storage);
+    // Cuerpo: filename, tag, offset, tamaño y los datos (solo size bytes, no un bloque completo)
+    t_trama* pedido = iniciar_pedido_storage(OP_WRITE);
+    trama_agregar_string_red(pedido, filename);
+    trama_agregar_string_red(pedido, tag);
+    trama_agregar_uint32_red(pedido, offset);
+    trama_agregar_uint32_red(pedido, size);
+    trama_agregar_referencia(pedido, contenido, size);
 
-    // Enviar código de operación WRITE
-    int cod_op_write = htonl(OP_WRITE);
-    if (send(socket_storage, &cod_op_write, sizeof(int), MSG_NOSIGNAL) <= 0) {
+    memory_invalidar_lecturas(file_tag);
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
         log_error(logger, "Error al enviar OP_WRITE");
-        free(filename); free(tag);
-        return false; // Error crítico
-    }
-
-    // Enviar filename
-    enviar_string_storage(filename, socket_storage);
-
-    // Enviar tag
-    enviar_string_storage(tag, socket_storage);
-
-    // Enviar offset (uint32_t)
-    uint32_t offset_net = htonl(offset);
-    if (send(socket_storage, &offset_net, sizeof(uint32_t), MSG_NOSIGNAL) <= 0) {
-        log_error(logger, "Error al enviar offset");
-        free(filename); free(tag);
-        return false; // Error crítico
-    }
-
-    // Enviar tamaño real del contenido
-    uint32_t size_net = htonl(size);
-    if (send(socket_storage, &size_net, sizeof(uint32_t), MSG_NOSIGNAL) <= 0) {
-        log_error(logger, "Error al enviar size");
-        free(filename); free(tag);
-        return false; // Error crítico
-    }
-
-    // Enviar los datos (solo size bytes, no un bloque completo)
-    if (send(socket_storage, contenido, size, MSG_NOSIGNAL) != (ssize_t)size) {
-        log_error(logger, "Error al enviar datos de WRITE");
-        free(filename); free(tag);
         return false; // Error crítico
     }
 
     // Esperar respuesta
-    bool resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
 
     if (!resultado) {
         // DIFERENCIAR TIPOS DE ERROR
@@ -460,19 +415,93 @@ static bool ejecutar_WRITE(uint32_t id, char* file_tag, char* direccion_str, cha
         // NO llamar a enviar_error_a_master aquí
     } else {
         log_info(logger, "WRITE Storage %s:%s exitoso", filename, tag);
+        memory_actualizar_rango(file_tag, offset, contenido, size);
     }
 
-    free(filename);
-    free(tag);
     
     // SIEMPRE RETORNAR TRUE PARA CONTINUAR LA QUERY
     // Incluso si el WRITE falló, continuamos con las siguientes instrucciones
     return true;
 }
 
-static bool ejecutar_READ(uint32_t id, char* file_tag, char* direccion_str, char* size_str) {
-    uint32_t direccion = (uint32_t)atoi(direccion_str);
-    uint32_t size_solicitado = (uint32_t)atoi(size_str);
+static bool es_write_valido(const t_instruccion_compilada* inst) {
+    return inst->tipo == QUERY_INST_WRITE && inst->cant_args >= 3 && inst->contenido != NULL;
+}
+
+// Cuántas instrucciones desde 'inst' son WRITE al mismo File:Tag que la primera
+// (hasta MAX_WRITES_AGRUPADOS). 1 o 0 si no hay nada para agrupar.
+uint32_t writes_agrupables(const t_instruccion_compilada* inst, uint32_t disponibles) {
+    if (disponibles == 0 || !es_write_valido(&inst[0])) return 0;
+
+    uint32_t cantidad = 1;
+    while (cantidad < disponibles && cantidad < MAX_WRITES_AGRUPADOS &&
+           es_write_valido(&inst[cantidad]) &&
+           strcmp(inst[cantidad].filename, inst[0].filename) == 0 &&
+           strcmp(inst[cantidad].tag, inst[0].tag) == 0) {
+        cantidad++;
+    }
+    return cantidad;
+}
+
+// WRITE consecutivos al mismo File:Tag en un único OP_WRITE_VECTORIAL:
+// [filename][tag][cantidad][[offset][size][datos]]... El Storage los aplica en orden
+// y devuelve un byte por escritura, así cada una se trata igual que un WRITE suelto:
+// la que falla se informa y la query sigue.
+bool ejecutar_WRITE_agrupado(uint32_t id, const t_instruccion_compilada* inst, uint32_t cantidad) {
+    log_info(logger, "## Query %u: Ejecutar %u WRITE agrupados en %s", id, cantidad, inst[0].file_tag);
+
+    prefetch_drenar();
+
+    t_trama* pedido = iniciar_pedido_storage(OP_WRITE_VECTORIAL);
+    trama_agregar_string_red(pedido, inst[0].filename);
+    trama_agregar_string_red(pedido, inst[0].tag);
+    trama_agregar_uint32_red(pedido, cantidad);
+    for (uint32_t i = 0; i < cantidad; i++) {
+        uint32_t size = strlen(inst[i].contenido);
+        trama_agregar_uint32_red(pedido, inst[i].direccion);
+        trama_agregar_uint32_red(pedido, size);
+        trama_agregar_referencia(pedido, inst[i].contenido, size);
+    }
+
+    memory_invalidar_lecturas(inst[0].file_tag);
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        log_error(logger, "Error al enviar OP_WRITE_VECTORIAL");
+        return false;
+    }
+
+    t_respuesta_storage* respuesta = storage_esperar_respuesta(id_pedido);
+    if (!respuesta) {
+        log_error(logger, "Error al recibir respuesta de OP_WRITE_VECTORIAL");
+        return false;
+    }
+
+    // OP_ERROR: el archivo no admite escrituras, ninguna se aplicó
+    const uint8_t* estados = NULL;
+    if (respuesta->estado == OP_OK && respuesta->payload && respuesta->payload->size >= (int)cantidad) {
+        estados = respuesta->payload->stream;
+    }
+
+    for (uint32_t i = 0; i < cantidad; i++) {
+        if (estados && estados[i]) {
+            log_info(logger, "WRITE Storage %s offset=%u exitoso", inst[i].file_tag, inst[i].direccion);
+            memory_actualizar_rango(inst[i].file_tag, inst[i].direccion, inst[i].contenido, strlen(inst[i].contenido));
+        } else {
+            log_warning(logger, "WRITE no ejecutado en %s offset=%u (posiblemente COMMITTED)",
+                        inst[i].file_tag, inst[i].direccion);
+        }
+    }
+
+    destruir_respuesta_storage(respuesta);
+
+    // Igual que WRITE: la query sigue aunque alguna escritura haya fallado
+    return true;
+}
+
+static bool ejecutar_READ(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    uint32_t direccion = inst->direccion;
+    uint32_t size_solicitado = inst->tamanio;
 
     log_info(logger, "## Query %u: Ejecutar READ %s dir=%u size=%u (BLOCK_SIZE=%u)", 
              id, file_tag, direccion, size_solicitado, WORKER_BLOCK_SIZE);
@@ -483,8 +512,11 @@ static bool ejecutar_READ(uint32_t id, char* file_tag, char* direccion_str, char
         return false; // Error crítico
     }
 
-    enviar_pc_a_storage(current_pc, socket_storage);
-    usleep(50000);
+    // Sin bytes que leer: solo se cierra el resultado (evita el desborde de direccion_final)
+    if (size_solicitado == 0) {
+        enviar_tramo_lectura(id, file_tag, 0, true, NULL, 0);
+        return true;
+    }
 
     // CALCULAR BLOQUES CON BLOCK_SIZE=16
     uint32_t bloque_inicial = direccion / WORKER_BLOCK_SIZE;
@@ -496,21 +528,17 @@ static bool ejecutar_READ(uint32_t id, char* file_tag, char* direccion_str, char
     log_info(logger, "READ: dir=%u, size=%u -> bloques %u-%u (%u bloques), offset_inicial=%u", 
              direccion, size_solicitado, bloque_inicial, bloque_final, total_bloques, offset_inicial);
 
-    char* buffer_completo = malloc(size_solicitado + 1);
-    if (!buffer_completo) {
-        log_error(logger, "Error al allocar buffer para READ");
-        // NO ES CRÍTICO - CONTINUAR QUERY
-        log_warning(logger, "## Query %u: READ falló por falta de memoria, continuando query", id);
-        return true;
-    }
-    memset(buffer_completo, 0, size_solicitado + 1);
+    uint32_t pedidos[READ_MAX_PEDIDOS_EN_VUELO] = { 0 };
+    uint32_t generaciones[READ_MAX_PEDIDOS_EN_VUELO] = { 0 };
+    uint32_t proximo_a_pedir = bloque_inicial;
 
     uint32_t total_bytes_leidos = 0;
     uint32_t bytes_restantes = size_solicitado;
 
     bool lectura_exitosa = true;
+    bool ultimo_enviado = false;
 
-    // LEER CADA BLOQUE REQUERIDO
+    // LEER CADA BLOQUE REQUERIDO Y ENVIARLO APENAS ESTÁ
     for (uint32_t bloque_actual = bloque_inicial; 
          bloque_actual <= bloque_final && bytes_restantes > 0; 
          bloque_actual++) {
@@ -523,166 +551,93 @@ static bool ejecutar_READ(uint32_t id, char* file_tag, char* direccion_str, char
         log_info(logger, "Leyendo bloque %u: offset=%u, bytes_a_leer=%u, bytes_restantes=%u", 
                  bloque_actual, offset_en_bloque, bytes_a_leer_de_bloque, bytes_restantes);
 
-        // Solicitar bloque al Storage
-        int cod_op = OP_READ;
-        int cod_op_network = htonl(cod_op);
-        
-        if (send(socket_storage, &cod_op_network, sizeof(int), MSG_NOSIGNAL) <= 0) {
-            log_error(logger, "Error al enviar OP_READ al Storage");
-            // NO ES CRÍTICO - CONTINUAR
-            log_warning(logger, "## Query %u: Error de comunicación en READ, continuando query", id);
-            lectura_exitosa = false;
-            break;
-        }
-
-        // Enviar file_tag
-        uint32_t tam_file_tag = strlen(file_tag) + 1;
-        uint32_t tam_file_tag_network = htonl(tam_file_tag);
-        
-        if (send(socket_storage, &tam_file_tag_network, sizeof(uint32_t), MSG_NOSIGNAL) <= 0 ||
-            send(socket_storage, file_tag, tam_file_tag, MSG_NOSIGNAL) <= 0) {
-            log_error(logger, "Error al enviar file_tag al Storage");
-            // NO ES CRÍTICO - CONTINUAR
-            lectura_exitosa = false;
-            break;
-        }
-
-        // Enviar número de bloque
-        uint32_t bloque_network = htonl(bloque_actual);
-        if (send(socket_storage, &bloque_network, sizeof(uint32_t), MSG_NOSIGNAL) <= 0) {
-            log_error(logger, "Error al enviar número de bloque al Storage");
-            // NO ES CRÍTICO - CONTINUAR
-            lectura_exitosa = false;
-            break;
-        }
-
-        log_info(logger, "Solicitado bloque %u para %s", bloque_actual, file_tag);
-
-        // Recibir bloque del Storage
-        t_buffer* bloque_buffer = recibir_pagina_storage(logger, socket_storage);
-        
-        if (!bloque_buffer) {
-            log_error(logger, "Error al recibir bloque %u del Storage", bloque_actual);
+        // Los bloques siguientes se piden mientras se espera este: el Storage los lee en
+        // paralelo y se recogen por id a medida que los necesita este bucle
+        pedir_ventana_lectura(file_tag, pedidos, generaciones, &proximo_a_pedir, bloque_actual, bloque_final);
+
+        // Memoria interna primero; ante PAGE FAULT se trae la página del Storage
+        t_pagina* fijada = NULL;
+        uint32_t id_pedido = pedidos[bloque_actual % READ_MAX_PEDIDOS_EN_VUELO];
+        pedidos[bloque_actual % READ_MAX_PEDIDOS_EN_VUELO] = 0;
+        void* datos_pagina = obtener_pagina_lectura(id, file_tag, bloque_actual, id_pedido,
+                                                    generaciones[bloque_actual % READ_MAX_PEDIDOS_EN_VUELO], &fijada);
+        if (!datos_pagina) {
+            log_error(logger, "Error al obtener bloque %u de %s", bloque_actual, file_tag);
             // NO ES CRÍTICO - CONTINUAR QUERY
             log_warning(logger, "## Query %u: Bloque %u no disponible, continuando query", id, bloque_actual);
             lectura_exitosa = false;
             break;
         }
 
-        log_info(logger, "Bloque %u recibido - %u bytes", bloque_actual, bloque_buffer->size);
-
-        // VERIFICAR SI EL STORAGE ENVIÓ UN ERROR
-        if (bloque_buffer->size == 0 || bloque_buffer->stream == NULL) {
-            log_warning(logger, "## Query %u: Bloque %u vacío o error del Storage", id, bloque_actual);
-            free(bloque_buffer->stream);
-            free(bloque_buffer);
-            lectura_exitosa = false;
-            break;
+        // El tramo sale directo del marco (o de la página recibida) y se suelta enseguida:
+        // un READ grande no retiene más de una página a la vez
+        bool ultimo = bytes_restantes == bytes_a_leer_de_bloque;
+        bool enviado = enviar_tramo_lectura(id, file_tag, total_bytes_leidos, ultimo,
+                                            (char*)datos_pagina + offset_en_bloque, bytes_a_leer_de_bloque);
+        if (fijada) {
+            memory_soltar_pagina(fijada);
+        } else {
+            pool_buffers_devolver(datos_pagina);
         }
-
-        // Validar offset dentro del bloque
-        if (offset_en_bloque >= bloque_buffer->size) {
-            log_error(logger, "ERROR: offset=%u >= tamaño_bloque=%u", 
-                     offset_en_bloque, bloque_buffer->size);
-            free(bloque_buffer->stream);
-            free(bloque_buffer);
-            // NO ES CRÍTICO - CONTINUAR QUERY
-            log_warning(logger, "## Query %u: Offset fuera de rango en READ, continuando query", id);
+        if (!enviado) {
             lectura_exitosa = false;
             break;
         }
+        ultimo_enviado = ultimo;
 
-        // Calcular bytes disponibles desde el offset
-        uint32_t bytes_disponibles = bloque_buffer->size - offset_en_bloque;
-        uint32_t bytes_a_copiar = (bytes_disponibles < bytes_a_leer_de_bloque) ? 
-                                 bytes_disponibles : bytes_a_leer_de_bloque;
-
-        if (bytes_a_copiar == 0) {
-            log_warning(logger, "No hay bytes para copiar del bloque %u", bloque_actual);
-            free(bloque_buffer->stream);
-            free(bloque_buffer);
-            continue;
-        }
-
-        // Copiar datos al buffer completo
-        memcpy(buffer_completo + total_bytes_leidos, 
-               (char*)bloque_buffer->stream + offset_en_bloque, 
-               bytes_a_copiar);
+        total_bytes_leidos += bytes_a_leer_de_bloque;
+        bytes_restantes -= bytes_a_leer_de_bloque;
         
-        total_bytes_leidos += bytes_a_copiar;
-        bytes_restantes -= bytes_a_copiar;
-        
-        log_info(logger, "Copiados %u bytes desde bloque %u -> total_leidos=%u", 
-                 bytes_a_copiar, bloque_actual, total_bytes_leidos);
+        log_info(logger, "Enviados %u bytes desde bloque %u -> total_leidos=%u", 
+                 bytes_a_leer_de_bloque, bloque_actual, total_bytes_leidos);
+    }
 
-        free(bloque_buffer->stream);
-        free(bloque_buffer);
+    // Bloques pedidos que ya no se van a usar (READ cortado por un error)
+    for (uint32_t i = 0; i < READ_MAX_PEDIDOS_EN_VUELO; i++) {
+        if (pedidos[i] != 0) storage_descartar_respuesta(pedidos[i]);
     }
 
     // MANEJAR RESULTADO DE LA LECTURA
-    if (lectura_exitosa && total_bytes_leidos > 0) {
-        if (total_bytes_leidos < size_solicitado) {
-            log_warning(logger, "READ incompleto: solicitados=%u, leídos=%u", 
-                       size_solicitado, total_bytes_leidos);
-        } else {
-            log_info(logger, "READ completado exitosamente: %u bytes leídos", total_bytes_leidos);
-        }
-
-        buffer_completo[total_bytes_leidos] = '\0';
-        
-        // Log de contenido leído
-        log_info(logger, "Datos leídos (primeros %u bytes): '%s'", 
-                 (total_bytes_leidos < 64 ? total_bytes_leidos : 64), buffer_completo);
-        
-        // Enviar resultado al Master
-        enviar_resultado_read_a_master(id, file_tag, buffer_completo, total_bytes_leidos);
-        
+    if (lectura_exitosa && total_bytes_leidos == size_solicitado) {
+        log_info(logger, "READ completado exitosamente: %u bytes leídos", total_bytes_leidos);
     } else {
-        log_warning(logger, "## Query %u: READ no pudo completarse para %s", id, file_tag);
-        
-        // ENVIAR RESULTADO VACÍO AL MASTER EN LUGAR DE ERROR
-        char* resultado_vacio = malloc(1);
-        resultado_vacio[0] = '\0';
-        enviar_resultado_read_a_master(id, file_tag, resultado_vacio, 0);
-        free(resultado_vacio);
+        log_warning(logger, "## Query %u: READ no pudo completarse para %s (%u de %u bytes)",
+                    id, file_tag, total_bytes_leidos, size_solicitado);
     }
-    
-    free(buffer_completo);
-    
+
+    // El Query Control cierra el resultado con el tramo marcado como último (vacío si se cortó)
+    if (!ultimo_enviado) {
+        enviar_tramo_lectura(id, file_tag, total_bytes_leidos, true, NULL, 0);
+    }
+
     // SIEMPRE RETORNAR TRUE PARA CONTINUAR LA QUERY
     // Incluso si READ falló, continuamos con las siguientes instrucciones
     return true;
 }
 
-static bool ejecutar_FLUSH(uint32_t id, char* file_tag) {
+static bool ejecutar_FLUSH(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
     log_info(logger, "## Query %u: Ejecutar FLUSH %s", id, file_tag);
 
-    // Parsear file_tag en filename y tag
-    char* filename;
-    char* tag;
-    parse_file_tag(file_tag, &filename, &tag);
     
     log_info(logger, "FLUSH parseado: filename='%s', tag='%s'", filename, tag);
 
-    // ENVIAR PC
-    enviar_pc_a_storage(current_pc, socket_storage);
-
-    // Enviar código de operación
-    int cod_op = htonl(OP_FLUSH);
-    send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL);
+    prefetch_drenar();
 
     log_info(logger, "Enviando FLUSH para %s:%s al Storage", filename, tag);
-    
-    // Enviar filename
-    enviar_string_storage(filename, socket_storage);
-    
-    // Enviar tag
-    enviar_string_storage(tag, socket_storage);
 
-    // Esperar un momento para que el Storage procese
-    usleep(100000); // 100ms
-    
-    bool resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    t_trama* pedido = iniciar_pedido_storage(OP_FLUSH);
+    trama_agregar_string_red(pedido, filename);
+    trama_agregar_string_red(pedido, tag);
+
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        return false;
+    }
+
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     if (resultado) {
         log_info(logger, "FLUSH %s:%s exitoso", filename, tag);
@@ -690,40 +645,32 @@ static bool ejecutar_FLUSH(uint32_t id, char* file_tag) {
         log_error(logger, "Fallo FLUSH %s:%s", filename, tag);
     }
     
-    free(filename);
-    free(tag);
     return resultado;
 }
 
-static bool ejecutar_COMMIT(uint32_t id, char* file_tag) {
+static bool ejecutar_COMMIT(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
     log_info(logger, "## Query %u: Ejecutar COMMIT %s", id, file_tag);
 
-    // Parsear file_tag en filename y tag
-    char* filename;
-    char* tag;
-    parse_file_tag(file_tag, &filename, &tag);
     
     log_info(logger, "COMMIT parseado: filename='%s', tag='%s'", filename, tag);
 
-    // ENVIAR PC
-    enviar_pc_a_storage(current_pc, socket_storage);
-
-    // Enviar código de operación
-    int cod_op = htonl(OP_COMMIT);
-    send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL);
+    prefetch_drenar();
 
     log_info(logger, "Enviando COMMIT para %s:%s al Storage", filename, tag);
-    
-    // Enviar filename
-    enviar_string_storage(filename, socket_storage);
-    
-    // Enviar tag
-    enviar_string_storage(tag, socket_storage);
 
-    // Esperar un momento para que el Storage procese
-    usleep(100000); // 100ms
-    
-    bool resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    t_trama* pedido = iniciar_pedido_storage(OP_COMMIT);
+    trama_agregar_string_red(pedido, filename);
+    trama_agregar_string_red(pedido, tag);
+
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        return false;
+    }
+
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     if (resultado) {
         log_info(logger, "COMMIT %s:%s exitoso", filename, tag);
@@ -731,89 +678,39 @@ static bool ejecutar_COMMIT(uint32_t id, char* file_tag) {
         log_error(logger, "Fallo COMMIT %s:%s", filename, tag);
     }
     
-    free(filename);
-    free(tag);
     return resultado;
 }
 
-static bool ejecutar_TAG(uint32_t id, char* origen, char* destino) {
-    log_info(logger, "## Query %u: Ejecutar TAG %s -> %s", id, origen, destino);
+static bool ejecutar_TAG(uint32_t id, const t_instruccion_compilada* inst) {
+    log_info(logger, "## Query %u: Ejecutar TAG %s -> %s", id, inst->file_tag, inst->file_tag_destino);
 
-    // DECLARAR VARIABLES AL INICIO
-    char* filename_origen = NULL;
-    char* source_tag = NULL;
-    char* filename_destino = NULL;
-    char* dest_tag = NULL;
-    char* origen_completo = NULL;
-    char* destino_completo = NULL;
-    bool resultado = false;
-
-    // Parsear origen
-    char* separador = strchr(origen, ':');
-    if (separador) {
-        *separador = '\0';
-        filename_origen = strdup(origen);
-        source_tag = strdup(separador + 1);
-        *separador = ':'; // Restaurar para construir origen_completo
-    } else {
-        filename_origen = strdup(origen);
-        source_tag = strdup("BASE");
-    }
-    
-    // Parsear destino
-    separador = strchr(destino, ':');
-    if (separador) {
-        *separador = '\0';
-        filename_destino = strdup(destino);
-        dest_tag = strdup(separador + 1);
-        *separador = ':'; // Restaurar para construir destino_completo
-    } else {
-        filename_destino = strdup(filename_origen);
-        dest_tag = strdup(destino);
-    }
-    
-    // Verificar que coincidan los filenames
-    if (strcmp(filename_origen, filename_destino) != 0) {
+    // Origen y destino ya vienen separados desde la compilación del script
+    if (strcmp(inst->filename, inst->filename_destino) != 0) {
         log_error(logger, "TAG: No se permite copia entre archivos diferentes");
-        goto cleanup;
+        return false;
     }
-    
-    // Construir strings completos formato filename:tag para enviar al Storage
-    origen_completo = malloc(strlen(filename_origen) + strlen(source_tag) + 2);
-    sprintf(origen_completo, "%s:%s", filename_origen, source_tag);
-    
-    destino_completo = malloc(strlen(filename_destino) + strlen(dest_tag) + 2);
-    sprintf(destino_completo, "%s:%s", filename_destino, dest_tag);
+
+    // Strings completos formato filename:tag para enviar al Storage
+    char origen_completo[256];
+    snprintf(origen_completo, sizeof(origen_completo), "%s:%s", inst->filename, inst->tag);
+    const char* destino_completo = inst->file_tag_destino;
     
     log_info(logger, "TAG parseado: %s -> %s", origen_completo, destino_completo);
 
-    enviar_pc_a_storage(current_pc, socket_storage);
+    prefetch_drenar();
 
-    int cod_op = htonl(OP_TAG);
-    if (send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL) <= 0) {
-        log_error(logger, "TAG: Error al enviar código de operación");
-        goto cleanup;
-    }
-    
-    // Enviar origen completo (filename:tag)
-    uint32_t tam_origen = strlen(origen_completo) + 1;
-    uint32_t tam_origen_network = htonl(tam_origen);
-    if (send(socket_storage, &tam_origen_network, sizeof(uint32_t), MSG_NOSIGNAL) <= 0 ||
-        send(socket_storage, origen_completo, tam_origen, MSG_NOSIGNAL) <= 0) {
-        log_error(logger, "TAG: Error al enviar origen");
-        goto cleanup;
-    }
-    
-    // Enviar destino completo (filename:tag)
-    uint32_t tam_destino = strlen(destino_completo) + 1;
-    uint32_t tam_destino_network = htonl(tam_destino);
-    if (send(socket_storage, &tam_destino_network, sizeof(uint32_t), MSG_NOSIGNAL) <= 0 ||
-        send(socket_storage, destino_completo, tam_destino, MSG_NOSIGNAL) <= 0) {
-        log_error(logger, "TAG: Error al enviar destino");
-        goto cleanup;
+    // Cuerpo: origen y destino completos (filename:tag)
+    t_trama* pedido = iniciar_pedido_storage(OP_TAG);
+    trama_agregar_string_red(pedido, origen_completo);
+    trama_agregar_string_red(pedido, destino_completo);
+
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        log_error(logger, "TAG: Error al enviar pedido");
+        return false;
     }
 
-    resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    bool resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     if (resultado) {
         log_info(logger, "TAG %s -> %s exitoso", origen_completo, destino_completo);
@@ -821,54 +718,44 @@ static bool ejecutar_TAG(uint32_t id, char* origen, char* destino) {
         log_error(logger, "Fallo TAG %s -> %s", origen_completo, destino_completo);
         enviar_error_a_master(id, "TAG falló");
     }
-
-cleanup:
-    // Limpieza segura
-    if (filename_origen) free(filename_origen);
-    if (source_tag) free(source_tag);
-    if (filename_destino) free(filename_destino);
-    if (dest_tag) free(dest_tag);
-    if (origen_completo) free(origen_completo);
-    if (destino_completo) free(destino_completo);
     
     return resultado;
 }
 
-static bool ejecutar_DELETE(uint32_t id, char* file_tag) {
+static bool ejecutar_DELETE(uint32_t id, const t_instruccion_compilada* inst) {
+    const char* file_tag = inst->file_tag;
+    const char* filename = inst->filename;
+    const char* tag = inst->tag;
     log_info(logger, "## Query %u: Ejecutar DELETE %s", id, file_tag);
 
-    // DECLARAR VARIABLES
-    char* filename = NULL;
-    char* tag = NULL;
     bool resultado = false;
-
-    parse_file_tag(file_tag, &filename, &tag);
     
     log_info(logger, "DELETE parseado: filename='%s', tag='%s'", filename, tag);
 
-    enviar_pc_a_storage(current_pc, socket_storage);
-
-    int cod_op = htonl(OP_DELETE);
-    send(socket_storage, &cod_op, sizeof(int), MSG_NOSIGNAL);
+    prefetch_drenar();
 
     log_info(logger, "Enviando DELETE para %s:%s al Storage", filename, tag);
-    
-    enviar_string_storage(file_tag, socket_storage);
 
-    resultado = recibir_respuesta_storage_simple(logger, socket_storage);
+    t_trama* pedido = iniciar_pedido_storage(OP_DELETE);
+    trama_agregar_string_red(pedido, file_tag);
+
+    memory_invalidar_lecturas(file_tag);
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        return false;
+    }
+
+    resultado = recibir_respuesta_storage_simple(logger, id_pedido);
     
     if (resultado) {
         log_info(logger, "DELETE %s:%s exitoso", filename, tag);
         memory_liberar_archivo(file_tag);
+        prefetch_olvidar_archivo(file_tag);
     } else {
         log_error(logger, "Fallo DELETE %s:%s", filename, tag);
         enviar_error_a_master(id, "DELETE falló");
     }
     
-    // Limpieza
-    free(filename);
-    free(tag);
-    
     return resultado;
 }
 
@@ -877,37 +764,33 @@ static bool ejecutar_DELETE(uint32_t id, char* file_tag) {
 bool ejecutar_END(uint32_t id) {
     log_info(logger, "## Query %u: Ejecutar END (finalizar query)", id);
 
-    // ENVIAR PC FINAL AL STORAGE ANTES DE FINALIZAR
-    if (socket_storage >= 0) {
-        log_info(logger, "Enviando PC final al Storage: %u", current_pc);
-        enviar_pc_a_storage(current_pc, socket_storage);
-    }
+    // Perfil de memoria de la query, justo antes del END
+    enviar_metricas_memoria_master(id);
 
-    // 1. Enviar END al Master (201)
-    op_code cod_op = END;
-    ssize_t bytes_sent = send(socket_master, &cod_op, sizeof(op_code), MSG_NOSIGNAL);
-    
-    if (bytes_sent <= 0) {
-        log_error(logger, "❌ Error al enviar END al Master para query %u", id);
+    // 1. Enviar END al Master (201) como paquete [query_id]
+    t_paquete* paquete = crear_paquete(END, logger);
+    if (paquete == NULL) {
+        log_error(logger, "❌ Error al crear paquete END para query %u", id);
         return false;
     }
+    agregar_a_paquete(paquete, &id, sizeof(uint32_t));
+    enviar_paquete_master(paquete);
+    eliminar_paquete(paquete);
     
     log_info(logger, "END (201) enviado al Master para query %u (PC: %u)", id, current_pc);
 
     // 2. Informar al Storage con OP_END (209) si está conectado
     if (socket_storage != -1) {
-        int cod_op_storage = htonl(OP_END);
-        bytes_sent = send(socket_storage, &cod_op_storage, sizeof(int), MSG_NOSIGNAL);
-        
-        if (bytes_sent <= 0) {
+        // El encabezado lleva el PC final; el cuerpo, el ID del worker
+        t_trama* pedido = iniciar_pedido_storage(OP_END);
+        trama_agregar_string_red(pedido, WORKER_ID);
+
+        uint32_t id_pedido;
+        if (!enviar_pedido_storage(pedido, &id_pedido)) {
             log_warning(logger, "Error al enviar OP_END al Storage");
         } else {
-            // Enviar ID del worker al Storage
-            uint32_t tam_id = strlen(WORKER_ID) + 1;
-            uint32_t tam_id_network = htonl(tam_id);
-            send(socket_storage, &tam_id_network, sizeof(uint32_t), MSG_NOSIGNAL);
-            send(socket_storage, WORKER_ID, tam_id, MSG_NOSIGNAL);
-            
+            // Nadie espera la confirmación: se descarta cuando llegue
+            storage_descartar_respuesta(id_pedido);
             log_info(logger, "OP_END (209) enviado al Storage para worker %s", WORKER_ID);
         }
     }
@@ -0,0 +1,240 @@
+#include "scriptHelper.h"
+
+// CONSTANTES
+#define SCRIPT_INSTRUCCIONES_INICIALES 16
+#define SCRIPT_MAX_ARGS 3
+
+extern t_log* logger;
+
+// Scripts compilados por path. Varias ejecuciones pueden compartir el mismo script;
+// uno reemplazado o desalojado se libera cuando termina la última que lo usa.
+static t_dictionary* scripts_compilados = NULL;
+static uint32_t max_scripts_cache = 0;
+static pthread_mutex_t mutex_scripts = PTHREAD_MUTEX_INITIALIZER;
+
+// FUNCIONES AUXILIARES
+// "filename:tag" -> filename y tag (BASE si no hay tag)
+static void separar_file_tag(const char* file_tag, char** filename, char** tag) {
+    const char* separador = strchr(file_tag, ':');
+
+    if (separador) {
+        *filename = strndup(file_tag, separador - file_tag);
+        *tag = strdup(strlen(separador + 1) > 0 ? separador + 1 : "BASE");
+    } else {
+        *filename = strdup(file_tag);
+        *tag = strdup("BASE");
+    }
+}
+
+// Decodifica una línea no vacía. Los argumentos que faltan quedan en NULL/0 y
+// ejecutar_instruccion informa el error recién al llegar a esa instrucción.
+static void compilar_linea(const char* linea, t_instruccion_compilada* inst) {
+    memset(inst, 0, sizeof(t_instruccion_compilada));
+    inst->linea = strdup(linea);
+
+    char* copia = strdup(linea);
+    char* args[SCRIPT_MAX_ARGS] = { NULL };
+    char* token = strtok(copia, " ");
+    inst->tipo = token ? instruccion_from_string(token) : QUERY_INST_INVALID;
+
+    while (inst->cant_args < SCRIPT_MAX_ARGS && (token = strtok(NULL, " ")) != NULL) {
+        args[inst->cant_args++] = token;
+    }
+
+    if (args[0]) {
+        inst->file_tag = strdup(args[0]);
+        separar_file_tag(args[0], &inst->filename, &inst->tag);
+    }
+
+    switch (inst->tipo) {
+        case QUERY_INST_TRUNCATE:
+            if (args[1]) inst->tamanio = (uint32_t)atoi(args[1]);
+            break;
+
+        case QUERY_INST_WRITE:
+            if (args[1]) inst->direccion = (uint32_t)atoi(args[1]);
+            if (args[2]) inst->contenido = strdup(args[2]);
+            break;
+
+        case QUERY_INST_READ:
+            if (args[1]) inst->direccion = (uint32_t)atoi(args[1]);
+            if (args[2]) inst->tamanio = (uint32_t)atoi(args[2]);
+            break;
+
+        case QUERY_INST_TAG:
+            // Destino: filename:tag, o solo el tag (mismo archivo que el origen)
+            if (args[1] && inst->filename) {
+                if (strchr(args[1], ':')) {
+                    separar_file_tag(args[1], &inst->filename_destino, &inst->tag_destino);
+                } else {
+                    inst->filename_destino = strdup(inst->filename);
+                    inst->tag_destino = strdup(args[1]);
+                }
+                inst->file_tag_destino = string_from_format("%s:%s", inst->filename_destino, inst->tag_destino);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    free(copia);
+}
+
+static void destruir_instruccion(t_instruccion_compilada* inst) {
+    free(inst->linea);
+    free(inst->file_tag);
+    free(inst->filename);
+    free(inst->tag);
+    free(inst->file_tag_destino);
+    free(inst->filename_destino);
+    free(inst->tag_destino);
+    free(inst->contenido);
+}
+
+// FUNCIONES DE COMPILACIÓN
+// Lee el script una sola vez. Devuelve NULL si no se pudo abrir.
+static t_script* script_compilar(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return NULL;
+
+    t_script* script = calloc(1, sizeof(t_script));
+    script->path = strdup(path);
+    script->cantidad = 0;
+    uint32_t capacidad = SCRIPT_INSTRUCCIONES_INICIALES;
+    script->instrucciones = malloc(capacidad * sizeof(t_instruccion_compilada));
+
+    char* line = NULL;
+    size_t len = 0;
+    while (getline(&line, &len, file) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        // Las líneas vacías y los comentarios no ocupan PC
+        if (strlen(line) == 0 || line[0] == '#') continue;
+
+        if (script->cantidad == capacidad) {
+            capacidad *= 2;
+            script->instrucciones = realloc(script->instrucciones, capacidad * sizeof(t_instruccion_compilada));
+        }
+        compilar_linea(line, &script->instrucciones[script->cantidad++]);
+    }
+
+    free(line);
+    fclose(file);
+
+    log_info(logger, "Script %s compilado: %u instrucciones", path, script->cantidad);
+    return script;
+}
+
+static void script_destruir(t_script* script) {
+    if (!script) return;
+
+    for (uint32_t i = 0; i < script->cantidad; i++) {
+        destruir_instruccion(&script->instrucciones[i]);
+    }
+    free(script->instrucciones);
+    free(script->path);
+    free(script);
+}
+
+// FUNCIONES DE CACHE
+static bool mismo_archivo(const t_script* script, const struct stat* st) {
+    return script->dispositivo == st->st_dev && script->inodo == st->st_ino &&
+           script->tam == st->st_size &&
+           script->modificacion.tv_sec == st->st_mtim.tv_sec &&
+           script->modificacion.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+// Saca el script del cache; si nadie lo está usando se libera ya
+static void sacar_del_cache(t_script* script) {
+    dictionary_remove(scripts_compilados, script->path);
+    script->en_cache = false;
+    if (script->referencias == 0) script_destruir(script);
+}
+
+// Con el cache lleno se desaloja algún script que no se esté ejecutando
+static bool hacer_lugar_en_cache(void) {
+    if (dictionary_size(scripts_compilados) < max_scripts_cache) return true;
+
+    t_list* paths = dictionary_keys(scripts_compilados);
+    t_script* victima = NULL;
+    for (int i = 0; i < list_size(paths) && !victima; i++) {
+        t_script* script = dictionary_get(scripts_compilados, list_get(paths, i));
+        if (script->referencias == 0) victima = script;
+    }
+    list_destroy(paths);
+
+    if (!victima) return false;
+    log_debug(logger, "Cache de scripts: se desaloja %s", victima->path);
+    sacar_del_cache(victima);
+    return true;
+}
+
+void script_cache_init(uint32_t max_scripts) {
+    max_scripts_cache = max_scripts;
+    scripts_compilados = dictionary_create();
+    log_info(logger, "Cache de scripts compilados: %u scripts%s", max_scripts,
+             max_scripts == 0 ? " (deshabilitada)" : "");
+}
+
+void script_cache_destroy(void) {
+    if (!scripts_compilados) return;
+
+    pthread_mutex_lock(&mutex_scripts);
+    dictionary_destroy_and_destroy_elements(scripts_compilados, (void*)script_destruir);
+    scripts_compilados = NULL;
+    pthread_mutex_unlock(&mutex_scripts);
+}
+
+t_script* script_obtener(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) return NULL;
+
+    if (scripts_compilados && max_scripts_cache > 0) {
+        pthread_mutex_lock(&mutex_scripts);
+        t_script* cacheado = dictionary_get(scripts_compilados, (char*)path);
+        if (cacheado && mismo_archivo(cacheado, &st)) {
+            cacheado->referencias++;
+            pthread_mutex_unlock(&mutex_scripts);
+            log_debug(logger, "Cache de scripts: %s ya compilado", path);
+            return cacheado;
+        }
+        // El archivo cambió desde que se compiló
+        if (cacheado) sacar_del_cache(cacheado);
+        pthread_mutex_unlock(&mutex_scripts);
+    }
+
+    // Se compila fuera del mutex: leer el archivo no frena a las otras ejecuciones
+    t_script* script = script_compilar(path);
+    if (!script) return NULL;
+
+    // Si el archivo cambia mientras se lee, la próxima vez no coincide y se recompila
+    script->dispositivo = st.st_dev;
+    script->inodo = st.st_ino;
+    script->modificacion = st.st_mtim;
+    script->tam = st.st_size;
+    script->referencias = 1;
+
+    if (scripts_compilados && max_scripts_cache > 0) {
+        pthread_mutex_lock(&mutex_scripts);
+        // Otra ejecución pudo haberlo compilado mientras tanto: queda el que ya estaba
+        if (!dictionary_has_key(scripts_compilados, (char*)path) && hacer_lugar_en_cache()) {
+            dictionary_put(scripts_compilados, (char*)path, script);
+            script->en_cache = true;
+        }
+        pthread_mutex_unlock(&mutex_scripts);
+    }
+
+    return script;
+}
+
+void script_liberar(t_script* script) {
+    if (!script) return;
+
+    pthread_mutex_lock(&mutex_scripts);
+    script->referencias--;
+    bool destruir = !script->en_cache && script->referencias == 0;
+    pthread_mutex_unlock(&mutex_scripts);
+
+    if (destruir) script_destruir(script);
+}
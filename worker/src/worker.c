@@ -1,6 +1,8 @@
 
 #include "queryHelper.h"
 #include "memoryHelper.h"
+#include "prefetchHelper.h"
+#include "scriptHelper.h"
 
 // VARIABLES GLOBALES
 t_log* logger = NULL;
@@ -10,7 +12,39 @@ int socket_master  = -1;
 uint32_t WORKER_BLOCK_SIZE = 0;
 char* WORKER_ID = NULL;
 static bool IS_MOCK = false;
-extern uint32_t current_pc;
+
+// Pedidos al Storage en vuelo (ver storage_esperar_respuesta)
+#define CAPACIDAD_PEDIDO_STORAGE 512
+#define CAPACIDAD_LECTOR_STORAGE 65536
+static t_trama* trama_pedido_storage = NULL;
+static t_lector_tramas* lector_storage = NULL;
+static uint32_t proximo_id_pedido_storage = 1;
+static t_dictionary* respuestas_adelantadas = NULL;  // id -> t_respuesta_storage* que llegó antes de esperarla
+static t_dictionary* pedidos_sin_espera = NULL;      // id -> respuesta que se descarta al llegar
+static t_dictionary* pedidos_esperados = NULL;       // id de pedidos que algún ejecutor está esperando
+static bool lector_storage_ocupado = false;          // Un ejecutor está leyendo del socket del Storage
+static pthread_cond_t cond_respuestas_storage = PTHREAD_COND_INITIALIZER;
+static void destruir_respuesta_storage_elemento(void* respuesta);
+extern __thread uint32_t current_pc;
+extern __thread uint32_t current_query_id;
+
+// EJECUTORES DE QUERIES
+// El hilo que escucha al Master solo encola: las queries corren en QUERIES_SIMULTANEAS
+// hilos ejecutores que comparten la memoria y la conexión al Storage. Un DESALOJAR_QUERY
+// se atiende mientras la query ejecuta y la corta entre dos instrucciones.
+#define MAX_QUERIES_SIMULTANEAS 64
+static t_queue* queries_a_ejecutar = NULL;
+static sem_t sem_queries_a_ejecutar;
+static pthread_t* hilos_ejecutores = NULL;
+static uint32_t cantidad_ejecutores = 0;
+static pthread_mutex_t mutex_ejecutor = PTHREAD_MUTEX_INITIALIZER;
+static t_dictionary* desalojos_pedidos = NULL;   // query_id de las queries a desalojar
+static t_dictionary* lecturas_pausadas = NULL;   // query_id de las queries cuyo READ frenó el Master
+static pthread_cond_t cond_lecturas = PTHREAD_COND_INITIALIZER;
+// Los ejecutores envían al Master con o sin la memoria tomada (los tramos de READ salen
+// sin ella): este mutex evita que se mezclen los mensajes en el socket
+static pthread_mutex_t mutex_envio_master = PTHREAD_MUTEX_INITIALIZER;
+static bool deteniendo_ejecutores = false;
 
 // INICIALIZACION
 void iniciar_worker(char* config_path, char* log_path, char* worker_id) {
@@ -45,13 +79,15 @@ void iniciar_worker(char* config_path, char* log_path, char* worker_id) {
     char* propiedades[] = {
         "IP_MASTER", "PUERTO_MASTER", "IP_STORAGE", "PUERTO_STORAGE",
         "TAM_MEMORIA", "RETARDO_MEMORIA", "ALGORITMO_REEMPLAZO", 
-        "PATH_QUERIES", "LOG_LEVEL", "MODE"
+        "PATH_QUERIES", "LOG_LEVEL", "MODE", "PREFETCH_MAX_PAGINAS",
+        "MEMORIA_HUGE_PAGES", "MEMORIA_MLOCK"
     };
     
-    for (int i = 0; i < 10; i++) {
+    for (int i = 0; i < (int)(sizeof(propiedades) / sizeof(propiedades[0])); i++) {
         if (config_has_property(config, propiedades[i])) {
             if (strcmp(propiedades[i], "TAM_MEMORIA") == 0 || 
                 strcmp(propiedades[i], "RETARDO_MEMORIA") == 0 ||
+                strcmp(propiedades[i], "PREFETCH_MAX_PAGINAS") == 0 ||
                 strcmp(propiedades[i], "PUERTO_MASTER") == 0 ||
                 strcmp(propiedades[i], "PUERTO_STORAGE") == 0) {
                 int valor = config_get_int_value(config, propiedades[i]);
@@ -142,9 +178,65 @@ void iniciar_memoria(){
     const char* algoritmo = config_get_string_value(config, "ALGORITMO_REEMPLAZO");
     uint32_t tam_pagina = WORKER_BLOCK_SIZE;
 
-    log_info(logger, "Inicializando memoria interna: %u bytes, página=%u, retardo=%u ms, algoritmo=%s", tam_memoria, tam_pagina, retardo, algoritmo);
+    // Respaldo opcional del pool de marcos con huge pages y/o mlock
+    bool huge_pages = false;
+    bool bloquear_memoria = false;
+    if (config_has_property(config, "MEMORIA_HUGE_PAGES")) {
+        char* valor = config_get_string_value(config, "MEMORIA_HUGE_PAGES");
+        huge_pages = valor && strcasecmp(valor, "TRUE") == 0;
+    }
+    if (config_has_property(config, "MEMORIA_MLOCK")) {
+        char* valor = config_get_string_value(config, "MEMORIA_MLOCK");
+        bloquear_memoria = valor && strcasecmp(valor, "TRUE") == 0;
+    }
+
+    log_info(logger, "Inicializando memoria interna: %u bytes, página=%u, retardo=%u ms, algoritmo=%s, huge_pages=%s, mlock=%s",
+             tam_memoria, tam_pagina, retardo, algoritmo,
+             huge_pages ? "TRUE" : "FALSE", bloquear_memoria ? "TRUE" : "FALSE");
+
+    memory_init(tam_memoria, tam_pagina, retardo, algoritmo, huge_pages, bloquear_memoria);
+
+    // Lectura anticipada de páginas secuenciales (0 = deshabilitada)
+    uint32_t prefetch_max = 0;
+    if (config_has_property(config, "PREFETCH_MAX_PAGINAS")) {
+        prefetch_max = config_get_int_value(config, "PREFETCH_MAX_PAGINAS");
+    }
+    prefetch_init(prefetch_max);
+
+    // Scripts de query compilados que se reusan entre ejecuciones (0 = deshabilitada)
+    uint32_t scripts_max = 32;
+    if (config_has_property(config, "SCRIPT_CACHE_MAX")) {
+        scripts_max = config_get_int_value(config, "SCRIPT_CACHE_MAX");
+    }
+    script_cache_init(scripts_max);
+
+    iniciar_dump_metricas();
+}
+
+// Dump de métricas de memoria a pedido: kill -USR1 <pid del worker>
+static sigset_t senales_dump;
+
+static void* hilo_dump_metricas(void* arg) {
+    int senal;
+    while (sigwait(&senales_dump, &senal) == 0) {
+        memory_dump_metricas();
+    }
+    return NULL;
+}
+
+void iniciar_dump_metricas(void) {
+    // Bloquear SIGUSR1 antes de crear otros hilos para que solo la atienda el hilo de dump
+    sigemptyset(&senales_dump);
+    sigaddset(&senales_dump, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &senales_dump, NULL);
 
-    memory_init(tam_memoria, tam_pagina, retardo, algoritmo);
+    pthread_t hilo;
+    if (pthread_create(&hilo, NULL, hilo_dump_metricas, NULL) != 0) {
+        log_warning(logger, "No se pudo crear el hilo de dump de métricas");
+        return;
+    }
+    pthread_detach(hilo);
+    log_info(logger, "Dump de métricas de memoria disponible con: kill -USR1 %d", getpid());
 }
 
 // Conectar y pedir block size al Storage
@@ -236,6 +328,7 @@ int handshake_storage_pedir_blocksize(void) {
     
     // USAR EL TAMAÑO REAL - NO EL CONFIGURADO
     WORKER_BLOCK_SIZE = block_size_recibido;
+    pool_buffers_configurar_pagina(WORKER_BLOCK_SIZE);
     
     log_info(logger, "Handshake Storage OK. BLOCK_SIZE = %u bytes (valor REAL del Storage)", 
              WORKER_BLOCK_SIZE);
@@ -266,6 +359,17 @@ int conectar_master(void) {
     return 0;
 }
 
+// QUERIES_SIMULTANEAS del config (1 si no está)
+static uint32_t queries_simultaneas(void) {
+    int cantidad = 1;
+    if (config && config_has_property(config, "QUERIES_SIMULTANEAS")) {
+        cantidad = config_get_int_value(config, "QUERIES_SIMULTANEAS");
+    }
+    if (cantidad < 1) cantidad = 1;
+    if (cantidad > MAX_QUERIES_SIMULTANEAS) cantidad = MAX_QUERIES_SIMULTANEAS;
+    return (uint32_t)cantidad;
+}
+
 int handshake_master_enviar_id(void) {
     //codigo para testear worker sin otros modulos
     if (IS_MOCK) {
@@ -300,8 +404,16 @@ int handshake_master_enviar_id(void) {
         log_error(logger, "Error al enviar ID al Master");
         return -1;
     }
+
+    // 3. Cuántas queries puede ejecutar a la vez: el Master le asigna hasta esa cantidad
+    uint32_t capacidad_network = htonl(queries_simultaneas());
+    if (send(socket_master, &capacidad_network, sizeof(uint32_t), MSG_NOSIGNAL) <= 0) {
+        log_error(logger, "Error al enviar capacidad al Master");
+        return -1;
+    }
     
-    log_info(logger, "Handshake enviado al Master con ID: %s (%ld bytes)", WORKER_ID, bytes_sent);
+    log_info(logger, "Handshake enviado al Master con ID: %s, %u queries simultáneas",
+             WORKER_ID, queries_simultaneas());
 
     // Esperar confirmación del Master
     op_code respuesta;
@@ -326,9 +438,205 @@ int handshake_master_enviar_id(void) {
     }
 }
 
+static void* hilo_ejecutar_queries(void* arg) {
+    while (1) {
+        sem_wait(&sem_queries_a_ejecutar);
+
+        pthread_mutex_lock(&mutex_ejecutor);
+        t_query* query = queue_is_empty(queries_a_ejecutar) ? NULL : queue_pop(queries_a_ejecutar);
+        pthread_mutex_unlock(&mutex_ejecutor);
+
+        // Sin query es la señal de detener_ejecutores
+        if (!query) break;
+
+        ejecutar_query(query);
+
+        pool_buffers_devolver(query->buffer);
+        free(query);
+    }
+    return NULL;
+}
+
+static void iniciar_ejecutores(void) {
+    queries_a_ejecutar = queue_create();
+    desalojos_pedidos = dictionary_create();
+    lecturas_pausadas = dictionary_create();
+    sem_init(&sem_queries_a_ejecutar, 0, 0);
+
+    uint32_t pedidos = queries_simultaneas();
+    hilos_ejecutores = malloc(pedidos * sizeof(pthread_t));
+    for (uint32_t i = 0; i < pedidos; i++) {
+        if (pthread_create(&hilos_ejecutores[cantidad_ejecutores], NULL, hilo_ejecutar_queries, NULL) != 0) {
+            log_error(logger, "No se pudo crear el hilo ejecutor de queries %u", i);
+            continue;
+        }
+        cantidad_ejecutores++;
+    }
+    log_info(logger, "%u ejecutores de queries (memoria compartida)", cantidad_ejecutores);
+}
+
+// Se perdió el Master: las queries en curso se cortan en la próxima instrucción y se
+// descartan las que no empezaron
+static void detener_ejecutores(void) {
+    if (cantidad_ejecutores == 0) return;
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    while (!queue_is_empty(queries_a_ejecutar)) {
+        t_query* query = queue_pop(queries_a_ejecutar);
+        pool_buffers_devolver(query->buffer);
+        free(query);
+    }
+    deteniendo_ejecutores = true;
+    pthread_cond_broadcast(&cond_lecturas);
+    pthread_mutex_unlock(&mutex_ejecutor);
+
+    for (uint32_t i = 0; i < cantidad_ejecutores; i++) {
+        sem_post(&sem_queries_a_ejecutar);
+    }
+    for (uint32_t i = 0; i < cantidad_ejecutores; i++) {
+        pthread_join(hilos_ejecutores[i], NULL);
+    }
+
+    free(hilos_ejecutores);
+    hilos_ejecutores = NULL;
+    cantidad_ejecutores = 0;
+    queue_destroy(queries_a_ejecutar);
+    dictionary_destroy(desalojos_pedidos);
+    dictionary_destroy(lecturas_pausadas);
+    sem_destroy(&sem_queries_a_ejecutar);
+}
+
+static void encolar_query(t_query* recibida) {
+    t_query* query = malloc(sizeof(t_query));
+    *query = *recibida;
+
+    if (cantidad_ejecutores == 0) {
+        // Sin hilos ejecutores se ejecuta acá mismo, como antes
+        ejecutar_query(query);
+        pool_buffers_devolver(query->buffer);
+        free(query);
+        return;
+    }
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query->id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    // Un desalojo o una pausa de una ejecución anterior de la misma query ya no valen
+    dictionary_remove(desalojos_pedidos, clave);
+    dictionary_remove(lecturas_pausadas, clave);
+    queue_push(queries_a_ejecutar, query);
+    pthread_mutex_unlock(&mutex_ejecutor);
+    sem_post(&sem_queries_a_ejecutar);
+}
+
+static void pedir_desalojo(uint32_t query_id) {
+    if (cantidad_ejecutores == 0) return;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    dictionary_put(desalojos_pedidos, clave, NULL);
+    pthread_mutex_unlock(&mutex_ejecutor);
+}
+
+// Lo consulta el ejecutor entre instrucciones. Un pedido para una query que ya terminó
+// queda sin efecto: se borra si la query vuelve a llegar.
+static bool desalojo_pedido(uint32_t query_id) {
+    if (cantidad_ejecutores == 0) return false;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    bool pedido = deteniendo_ejecutores || dictionary_has_key(desalojos_pedidos, clave);
+    pthread_mutex_unlock(&mutex_ejecutor);
+    return pedido;
+}
+
+static void olvidar_desalojo(uint32_t query_id) {
+    if (cantidad_ejecutores == 0) return;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    dictionary_remove(desalojos_pedidos, clave);
+    pthread_mutex_unlock(&mutex_ejecutor);
+}
+
+// PAUSAR_LECTURA / REANUDAR_LECTURA: el Master frena el READ de una sola query cuando su
+// Query Control no consume, y sigue leyendo el resto de los mensajes de este Worker
+static void cambiar_pausa_lectura(uint32_t query_id, bool pausar) {
+    if (cantidad_ejecutores == 0) return;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    if (pausar) {
+        dictionary_put(lecturas_pausadas, clave, NULL);
+    } else {
+        dictionary_remove(lecturas_pausadas, clave);
+        pthread_cond_broadcast(&cond_lecturas);
+    }
+    pthread_mutex_unlock(&mutex_ejecutor);
+}
+
+// La llama el ejecutor antes de cada tramo de READ, sin la memoria tomada. Sin hilos
+// ejecutores no hay quién reciba el REANUDAR_LECTURA, así que no se pausa.
+void esperar_lectura_habilitada(uint32_t query_id) {
+    if (cantidad_ejecutores == 0) return;
+
+    char clave[16];
+    snprintf(clave, sizeof(clave), "%u", query_id);
+
+    pthread_mutex_lock(&mutex_ejecutor);
+    while (!deteniendo_ejecutores && dictionary_has_key(lecturas_pausadas, clave)) {
+        pthread_cond_wait(&cond_lecturas, &mutex_ejecutor);
+    }
+    pthread_mutex_unlock(&mutex_ejecutor);
+}
+
+void enviar_paquete_master(t_paquete* paquete) {
+    pthread_mutex_lock(&mutex_envio_master);
+    enviar_paquete(paquete, socket_master);
+    pthread_mutex_unlock(&mutex_envio_master);
+}
+
+bool enviar_trama_master(t_trama* trama) {
+    pthread_mutex_lock(&mutex_envio_master);
+    bool enviada = trama_enviar(trama, socket_master);
+    pthread_mutex_unlock(&mutex_envio_master);
+    return enviada;
+}
+
+// Contexto de desalojo al Master: [pc][query_id], con pc la próxima instrucción a ejecutar.
+// Cada WRITE ya esperó el OK del Storage, así que al reanudar (en este u otro Worker) el
+// Storage tiene todo lo que la query escribió; solo se completan los prefetch en vuelo.
+static void devolver_contexto_desalojo(uint32_t query_id, uint32_t pc) {
+    prefetch_drenar();
+
+    log_info(logger, "## Query %u: Desalojada por pedido del Master", query_id);
+
+    t_paquete* paquete = crear_paquete(DESALOJAR_QUERY, logger);
+    if (paquete == NULL) {
+        log_error(logger, "Error al crear paquete de contexto de desalojo");
+        return;
+    }
+    agregar_a_paquete(paquete, &pc, sizeof(uint32_t));
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
+    enviar_paquete_master(paquete);
+    eliminar_paquete(paquete);
+
+    log_info(logger, "Contexto de desalojo enviado al Master - Query %u, PC=%u", query_id, pc);
+}
+
 // Placeholder: bucle para recibir mensajes del Master
 void bucle_escuchar_master(void) {
     log_info(logger, "Entrando al loop de escucha del Master...");
+    iniciar_ejecutores();
     
     while (1) {
         log_info(logger, "Esperando operación del Master...");
@@ -345,45 +653,43 @@ void bucle_escuchar_master(void) {
                 log_info(logger, "Recibida orden EJECUTAR_QUERY");
 
                 // Recibir el paquete con los campos serializados (query_id, pc, tam_path, path)
-                t_list* elementos = recibir_paquete(logger, socket_master);
-                if (elementos == NULL) {
+                // en un único buffer; los campos se leen sin copiarlos
+                int size = 0;
+                void* buffer = recibir_buffer(&size, socket_master);
+                if (buffer == NULL) {
                     log_error(logger, "Error al recibir paquete EJECUTAR_QUERY");
                     break;
                 }
 
                 // Esperamos 4 elementos: int id, int pc, int tam_path, char[path]
-                if (list_size(elementos) < 3) {
+                t_vista_paquete vista;
+                if (!paquete_decodificar_vista(buffer, size, &vista) || vista.cantidad < 3) {
                     log_error(logger, "Paquete EJECUTAR_QUERY incompleto");
-                    list_destroy_and_destroy_elements(elementos, free);
+                    pool_buffers_devolver(buffer);
                     break;
                 }
 
                 t_query query;
-                // Elemento 0: query id
-                void* el0 = list_get(elementos, 0);
-                memcpy(&query.id, el0, sizeof(int));
-
-                // Elemento 1: pc
-                void* el1 = list_get(elementos, 1);
-                memcpy(&query.pc, el1, sizeof(int));
+                // Elemento 0: query id, elemento 1: pc
+                if (!campo_leer_uint32(&vista.campos[0], &query.id) ||
+                    !campo_leer_uint32(&vista.campos[1], &query.pc)) {
+                    log_error(logger, "Query ID o PC inválidos en EJECUTAR_QUERY");
+                    pool_buffers_devolver(buffer);
+                    break;
+                }
 
                 // Elemento 2: puede ser tam_path o directamente el path (depende de cómo se serializó)
                 // En nuestro Master serializamos tam_path (uint32_t) y luego el path como elemento separado.
-                char* path_str = NULL;
-                if (list_size(elementos) >= 4) {
-                    // elemento 2 = tam_path, elemento 3 = path
-                    void* el2 = list_get(elementos, 2);
-                    uint32_t tam_path = 0;
-                    memcpy(&tam_path, el2, sizeof(uint32_t));
-                    void* el3 = list_get(elementos, 3);
-                    path_str = strdup((char*)el3);
-                } else {
-                    // Si no hay elemento de tam_path, tomar directamente el tercer elemento como string
-                    void* el2 = list_get(elementos, 2);
-                    path_str = strdup((char*)el2);
+                const char* path_str = campo_string(&vista.campos[vista.cantidad >= 4 ? 3 : 2]);
+                if (path_str == NULL) {
+                    log_error(logger, "Path de EJECUTAR_QUERY inválido");
+                    pool_buffers_devolver(buffer);
+                    break;
                 }
 
-                query.path = path_str;
+                // El path apunta al buffer recibido, que se libera al terminar la query
+                query.path = (char*)path_str;
+                query.buffer = buffer;
 
                 log_info(logger, "Query ID recibido: %u", query.id);
                 log_info(logger, "PC recibido: %u", query.pc);
@@ -392,22 +698,47 @@ void bucle_escuchar_master(void) {
                 log_info(logger, "## Query %u: Se recibe la Query. El path de operaciones es: %s", 
                          query.id, query.path);
 
-                // Ejecutar la query
-                ejecutar_query(&query);
+                // La ejecuta un hilo ejecutor; este hilo sigue atendiendo al Master
+                encolar_query(&query);
+                break;
+            }
 
-                free(query.path);
+            case DESALOJAR_QUERY: {
+                // [query_id]: el desalojo corresponde a esa query y no a otra que llegue después
+                int size = 0;
+                void* buffer = recibir_buffer(&size, socket_master);
+                t_vista_paquete vista;
+                uint32_t query_id;
+                if (buffer == NULL || !paquete_decodificar_vista(buffer, size, &vista) ||
+                    vista.cantidad < 1 || !campo_leer_uint32(&vista.campos[0], &query_id)) {
+                    log_error(logger, "Paquete DESALOJAR_QUERY inválido");
+                    pool_buffers_devolver(buffer);
+                    break;
+                }
+                pool_buffers_devolver(buffer);
 
-                // Liberar elementos
-                list_destroy_and_destroy_elements(elementos, free);
+                log_info(logger, "Recibida orden DESALOJAR_QUERY - Query %u", query_id);
+                pedir_desalojo(query_id);
                 break;
             }
 
-            case DESALOJAR_QUERY: {
-                log_info(logger, "Recibida orden DESALOJAR_QUERY");
-                // TODO: Implementar desalojo
-                // Enviar PC actual al Master
-                int pc_actual = 0; // Obtener PC real de la query en ejecución
-                send(socket_master, &pc_actual, sizeof(int), MSG_NOSIGNAL);
+            case PAUSAR_LECTURA:
+            case REANUDAR_LECTURA: {
+                // [query_id]
+                int size = 0;
+                void* buffer = recibir_buffer(&size, socket_master);
+                t_vista_paquete vista;
+                uint32_t query_id;
+                if (buffer == NULL || !paquete_decodificar_vista(buffer, size, &vista) ||
+                    vista.cantidad < 1 || !campo_leer_uint32(&vista.campos[0], &query_id)) {
+                    log_error(logger, "Paquete PAUSAR/REANUDAR_LECTURA inválido");
+                    pool_buffers_devolver(buffer);
+                    break;
+                }
+                pool_buffers_devolver(buffer);
+
+                log_debug(logger, "%s lectura de Query %u", cod == PAUSAR_LECTURA ? "Pausar" : "Reanudar", query_id);
+                cambiar_pausa_lectura(query_id, cod == PAUSAR_LECTURA);
                 break;
             }
 
@@ -416,6 +747,8 @@ void bucle_escuchar_master(void) {
                 break;
         }
     }
+
+    detener_ejecutores();
 }
 
 
@@ -433,7 +766,7 @@ void enviar_notificacion_lectura_master(uint32_t query_id) {
     // Agregar query_id a la notificación
     agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
     
-    enviar_paquete(paquete, socket_master);
+    enviar_paquete_master(paquete);
     eliminar_paquete(paquete);
     
     log_info(logger, "Notificación de lectura enviada al Master - Query %u", query_id);
@@ -449,11 +782,12 @@ void enviar_finalizacion_exitosa_master(uint32_t query_id) {
         return;
     }
     
-    // Agregar mensaje de éxito
+    // [query_id][mensaje]: con varias queries en el Worker, el Master ubica la que terminó
     char* mensaje = "Query ejecutada correctamente";
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
     agregar_a_paquete(paquete, mensaje, strlen(mensaje) + 1);
     
-    enviar_paquete(paquete, socket_master);
+    enviar_paquete_master(paquete);
     eliminar_paquete(paquete);
     
     log_info(logger, "Finalización exitosa enviada al Master - Query %u", query_id);
@@ -470,17 +804,36 @@ void enviar_error_a_master(uint32_t query_id, const char* mensaje_error) {
         return;
     }
     
-    // Agregar mensaje de error
+    // [query_id][mensaje]
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
     agregar_a_paquete(paquete, (void*)mensaje_error, strlen(mensaje_error) + 1);
     
-    enviar_paquete(paquete, socket_master);
+    enviar_paquete_master(paquete);
     eliminar_paquete(paquete);
     
     log_info(logger, "Error enviado al Master - Query %u", query_id);
 }
 
-// Ejecutar Query
-void ejecutar_query(t_query* q) {
+// Métricas de memoria de la query: [query_id][t_metricas_memoria][cantidad][file_tag, t_metricas_memoria]...
+void enviar_metricas_memoria_master(uint32_t query_id) {
+    t_paquete* paquete = crear_paquete(METRICAS_MEMORIA, logger);
+
+    if (paquete == NULL) {
+        log_error(logger, "Error al crear paquete de métricas de memoria");
+        return;
+    }
+
+    agregar_a_paquete(paquete, &query_id, sizeof(uint32_t));
+    memory_agregar_metricas_query_a_paquete(paquete);
+
+    enviar_paquete_master(paquete);
+    eliminar_paquete(paquete);
+
+    log_info(logger, "Métricas de memoria enviadas al Master - Query %u", query_id);
+}
+
+// Corre el script de la query desde q->pc hasta el final, un error o un desalojo
+static void ejecutar_script_query(t_query* q) {
     char fullpath[PATH_MAX];
     
     // DEBUG: Mostrar información
@@ -493,60 +846,78 @@ void ejecutar_query(t_query* q) {
     
     log_info(logger, "  - Path intentado: '%s'", fullpath);
     
-    FILE* file = fopen(fullpath, "r");
-    if (!file) {
+    t_script* script = script_obtener(fullpath);
+    if (!script) {
         log_error(logger, "No se pudo abrir la query: %s", fullpath);
         
         // Si el path es relativo (comienza con ..), intentar desde directorio actual
         if (strstr(q->path, "../") == q->path) {
             // Ya es relativo, intentar como está
-            file = fopen(q->path, "r");
+            script = script_obtener(q->path);
         }
         
-        if (!file) {
+        if (!script) {
             enviar_error_a_master(q->id, "No se pudo abrir archivo de query");
             return;
         }
     }
 
-    char* line = NULL;
-    size_t len = 0;
-    uint32_t pc = q->pc;
     bool query_exitosa = true;
+    bool desalojada = false;
 
     // Notificar inicio de query al Master
     enviar_notificacion_lectura_master(q->id);
+    memory_iniciar_metricas_query(q->id);
 
-    log_info(logger, "## Query %u: Iniciando ejecución desde PC=%u", q->id, pc);
+    log_info(logger, "## Query %u: Iniciando ejecución desde PC=%u", q->id, q->pc);
 
-    while (getline(&line, &len, file) != -1) {
-        line[strcspn(line, "\n")] = '\0';
-        
-        // Ignorar líneas vacías y comentarios
-        if (strlen(line) == 0 || line[0] == '#') continue;
-        
-        log_info(logger, "## Query %u: PC=%u - Instrucción: %s", q->id, pc, line);
-        
-        if (pc >= q->pc) {
-            current_pc = pc;
-            
-            // Solo detener si ejecutar_instruccion retorna false
-            if (!ejecutar_instruccion(q->id, line, pc)) {
+    // El PC indexa directamente la instrucción: reanudar no relee las anteriores
+    for (uint32_t pc = q->pc; pc < script->cantidad; pc++) {
+        const t_instruccion_compilada* inst = &script->instrucciones[pc];
+        current_pc = pc;
+        current_query_id = q->id;
+
+        // Punto de desalojo: la instrucción pc todavía no se ejecutó
+        if (desalojo_pedido(q->id)) {
+            desalojada = true;
+            break;
+        }
+
+        // WRITE consecutivos al mismo File:Tag viajan en un solo pedido al Storage
+        uint32_t agrupadas = writes_agrupables(inst, script->cantidad - pc);
+        if (agrupadas > 1) {
+            for (uint32_t i = 0; i < agrupadas; i++) {
+                log_info(logger, "## Query %u: PC=%u - Instrucción: %s", q->id, pc + i, inst[i].linea);
+            }
+            if (!ejecutar_WRITE_agrupado(q->id, inst, agrupadas)) {
                 log_error(logger, "## Query %u: Error crítico en instrucción, abortando ejecución", q->id);
                 query_exitosa = false;
                 break;
             }
-            
-            log_info(logger, "## Query %u: - Instrucción procesada: %s", q->id, line);
+            for (uint32_t i = 0; i < agrupadas; i++) {
+                log_info(logger, "## Query %u: - Instrucción procesada: %s", q->id, inst[i].linea);
+            }
+            pc += agrupadas - 1;
+            continue;
+        }
+
+        log_info(logger, "## Query %u: PC=%u - Instrucción: %s", q->id, pc, inst->linea);
+        
+        // Solo detener si ejecutar_instruccion retorna false
+        if (!ejecutar_instruccion(q->id, inst, pc)) {
+            log_error(logger, "## Query %u: Error crítico en instrucción, abortando ejecución", q->id);
+            query_exitosa = false;
+            break;
         }
         
-        pc++;
+        log_info(logger, "## Query %u: - Instrucción procesada: %s", q->id, inst->linea);
     }
 
-    free(line);
-    fclose(file);
+    script_liberar(script);
 
-    if (query_exitosa) {
+    if (desalojada) {
+        devolver_contexto_desalojo(q->id, current_pc);
+    } else if (query_exitosa) {
         log_info(logger, "## Query %u: Finalizada exitosamente.", q->id);
         // Enviar END normal al master
         ejecutar_END(q->id);
@@ -554,8 +925,20 @@ void ejecutar_query(t_query* q) {
         log_error(logger, "## Query %u: Finalizada con errores críticos.", q->id);
         // Ya se envió el error durante la ejecución
     }
-    
+}
+
+// Ejecutar Query. Corre con la memoria tomada (ver memory_tomar): los demás ejecutores
+// avanzan mientras esta espera al Storage o el retardo de memoria. El mismo lock
+// serializa los envíos al Master, que comparten socket.
+void ejecutar_query(t_query* q) {
+    memory_tomar();
+    current_query_id = q->id;
+    current_pc = q->pc;
+    ejecutar_script_query(q);
+    olvidar_desalojo(q->id);
     current_pc = 0;
+    current_query_id = 0;
+    memory_soltar();
 }
 
 // Cleanup
@@ -563,25 +946,211 @@ void finalizar_worker(void) {
     if (socket_master != -1) liberar_conexion(socket_master);
     if (socket_storage != -1) liberar_conexion(socket_storage);
 
+    prefetch_destroy();
+    script_cache_destroy();
     memory_destroy();
 
+    trama_destruir(trama_pedido_storage);
+    lector_destruir(lector_storage);
+
+    if (respuestas_adelantadas) {
+        dictionary_destroy_and_destroy_elements(respuestas_adelantadas, destruir_respuesta_storage_elemento);
+        dictionary_destroy(pedidos_sin_espera);
+        dictionary_destroy(pedidos_esperados);
+    }
+
     if (config) config_destroy(config);
     if (logger) log_destroy(logger);
     if (WORKER_ID) free(WORKER_ID);    
 }
 
-bool recibir_respuesta_storage_simple(t_log* logger, int socket) {
-    int respuesta_network;
-    ssize_t bytes_recv = recv(socket, &respuesta_network, sizeof(int), MSG_WAITALL);
+// PEDIDOS AL STORAGE
+// Cada pedido lleva un id que el Storage devuelve en la respuesta, así pueden
+// quedar varios en vuelo y las respuestas llegar en cualquier orden.
+static char* clave_pedido(uint32_t id_pedido) {
+    return string_from_format("%u", id_pedido);
+}
+
+// Empieza un pedido al Storage en la trama compartida (los pedidos se arman y
+// envían de a uno): reserva el encabezado y el llamador agrega el cuerpo.
+t_trama* iniciar_pedido_storage(int cod_op) {
+    if (!trama_pedido_storage) {
+        trama_pedido_storage = trama_crear(CAPACIDAD_PEDIDO_STORAGE);
+    }
+    trama_reiniciar(trama_pedido_storage);
+
+    int32_t cod_op_network = htonl(cod_op);
+    uint32_t inicio = trama_reservar(trama_pedido_storage, sizeof(t_encabezado_pedido_storage));
+    trama_escribir(trama_pedido_storage, inicio + offsetof(t_encabezado_pedido_storage, op),
+                   &cod_op_network, sizeof(int32_t));
+    return trama_pedido_storage;
+}
+
+// Completa el encabezado (query, PC, id, tamaño del cuerpo) y envía todo en un solo sendmsg
+bool enviar_pedido_storage(t_trama* pedido, uint32_t* id_pedido) {
+    if (proximo_id_pedido_storage == 0) proximo_id_pedido_storage = 1;  // 0 = sin pedido
+    uint32_t id = proximo_id_pedido_storage++;
+
+    t_encabezado_pedido_storage encabezado;
+    memcpy(&encabezado, pedido->datos, sizeof(encabezado));  // op cargado en iniciar_pedido_storage
+    encabezado.query_id = htonl(current_query_id);
+    encabezado.pc = htonl(current_pc);
+    encabezado.id_pedido = htonl(id);
+    encabezado.tam_payload = htonl(trama_tamanio(pedido) - sizeof(encabezado));
+    trama_escribir(pedido, 0, &encabezado, sizeof(encabezado));
+
+    if (!trama_enviar(pedido, socket_storage)) {
+        log_error(logger, "Error al enviar pedido %d al Storage: %s", (int)ntohl(encabezado.op), strerror(errno));
+        return false;
+    }
+
+    if (id_pedido) *id_pedido = id;
+    return true;
+}
+
+void destruir_respuesta_storage(t_respuesta_storage* respuesta) {
+    if (!respuesta) return;
+    if (respuesta->payload) {
+        pool_buffers_devolver(respuesta->payload->stream);
+        free(respuesta->payload);
+    }
+    free(respuesta);
+}
+
+static void destruir_respuesta_storage_elemento(void* respuesta) {
+    destruir_respuesta_storage(respuesta);
+}
+
+// Lee una respuesta completa del socket, sea del pedido que sea. Un recv puede
+// traer varias respuestas: lo que sobra queda en el lector para la siguiente.
+static t_respuesta_storage* recibir_respuesta_storage(void) {
+    if (!lector_storage) {
+        lector_storage = lector_crear(socket_storage, CAPACIDAD_LECTOR_STORAGE);
+    }
+
+    t_encabezado_respuesta_storage encabezado;
+    if (!lector_leer(lector_storage, &encabezado, sizeof(encabezado))) {
+        log_error(logger, "Error al recibir respuesta del Storage");
+        return NULL;
+    }
+
+    t_respuesta_storage* respuesta = malloc(sizeof(t_respuesta_storage));
+    respuesta->estado = ntohl(encabezado.estado);
+    respuesta->id_pedido = ntohl(encabezado.id_pedido);
+    respuesta->payload = NULL;
+
+    uint32_t tam_payload = ntohl(encabezado.tam_payload);
+    if (tam_payload > 1000000) {
+        log_error(logger, "Tamaño de respuesta excesivo: %u bytes", tam_payload);
+        free(respuesta);
+        return NULL;
+    }
+
+    if (tam_payload > 0) {
+        respuesta->payload = malloc(sizeof(t_buffer));
+        respuesta->payload->size = tam_payload;
+        respuesta->payload->stream = pool_buffers_obtener(tam_payload);
+        if (!lector_leer(lector_storage, respuesta->payload->stream, tam_payload)) {
+            log_error(logger, "Error al recibir datos: %u bytes", tam_payload);
+            destruir_respuesta_storage(respuesta);
+            return NULL;
+        }
+    }
+
+    return respuesta;
+}
+
+static void crear_diccionarios_respuestas(void) {
+    if (respuestas_adelantadas) return;
+    respuestas_adelantadas = dictionary_create();
+    pedidos_sin_espera = dictionary_create();
+    pedidos_esperados = dictionary_create();
+}
+
+// Entrega una respuesta leída del socket: a quien la espera, al prefetch, a la basura
+// o queda guardada para quien la espere después
+static void repartir_respuesta_storage(t_respuesta_storage* recibida) {
+    char* clave = clave_pedido(recibida->id_pedido);
+
+    if (dictionary_has_key(pedidos_esperados, clave)) {
+        dictionary_put(respuestas_adelantadas, clave, recibida);
+    } else if (prefetch_es_pedido(recibida->id_pedido)) {
+        prefetch_completar(recibida);
+    } else if (dictionary_has_key(pedidos_sin_espera, clave)) {
+        dictionary_remove(pedidos_sin_espera, clave);
+        destruir_respuesta_storage(recibida);
+    } else {
+        dictionary_put(respuestas_adelantadas, clave, recibida);
+    }
+    free(clave);
+}
+
+// Bloquea hasta tener la respuesta de 'id_pedido'. Se llama con la memoria tomada y la
+// suelta mientras espera. Lee del socket un ejecutor a la vez; los demás esperan a que
+// reparta lo que llegó, y el que lee toma el lugar cuando se libera.
+t_respuesta_storage* storage_esperar_respuesta(uint32_t id_pedido) {
+    crear_diccionarios_respuestas();
+
+    char* clave = clave_pedido(id_pedido);
+    dictionary_put(pedidos_esperados, clave, NULL);
+
+    t_respuesta_storage* respuesta;
+    while (!(respuesta = dictionary_remove(respuestas_adelantadas, clave))) {
+        if (lector_storage_ocupado) {
+            memory_esperar(&cond_respuestas_storage);
+            continue;
+        }
+
+        lector_storage_ocupado = true;
+        memory_soltar();
+        t_respuesta_storage* recibida = recibir_respuesta_storage();
+        memory_tomar();
+        lector_storage_ocupado = false;
+        pthread_cond_broadcast(&cond_respuestas_storage);
+
+        if (!recibida) break;
+        repartir_respuesta_storage(recibida);
+    }
+
+    dictionary_remove(pedidos_esperados, clave);
+    free(clave);
+    return respuesta;
+}
+
+// Espera (soltando la memoria) a que se reparta alguna respuesta del Storage
+void storage_esperar_novedad(void) {
+    memory_esperar(&cond_respuestas_storage);
+}
+
+void storage_avisar_novedad(void) {
+    pthread_cond_broadcast(&cond_respuestas_storage);
+}
+
+// El llamador no va a esperar esta respuesta: se libera cuando llegue
+void storage_descartar_respuesta(uint32_t id_pedido) {
+    crear_diccionarios_respuestas();
+
+    char* clave = clave_pedido(id_pedido);
+    if (dictionary_has_key(respuestas_adelantadas, clave)) {
+        dictionary_remove_and_destroy(respuestas_adelantadas, clave, destruir_respuesta_storage_elemento);
+    } else {
+        dictionary_put(pedidos_sin_espera, clave, NULL);
+    }
+    free(clave);
+}
+
+bool recibir_respuesta_storage_simple(t_log* logger, uint32_t id_pedido) {
+    t_respuesta_storage* respuesta_storage = storage_esperar_respuesta(id_pedido);
     
-    if (bytes_recv <= 0) {
+    if (!respuesta_storage) {
         log_error(logger, "Error al recibir respuesta del Storage");
         return false;
     }
 
-    int respuesta = ntohl(respuesta_network);
+    int respuesta = respuesta_storage->estado;
+    destruir_respuesta_storage(respuesta_storage);
     
-    log_info(logger, "Respuesta recibida del Storage: código %d (network: %d)", respuesta, respuesta_network);
+    log_info(logger, "Respuesta recibida del Storage: código %d (pedido %u)", respuesta, id_pedido);
     
     // Aceptar 209 (OP_OK) y 210 (OP_ERROR) según conexion.h
     if (respuesta == OP_OK || respuesta == 209) {  // 209 es el OP_OK del Storage
@@ -597,89 +1166,68 @@ bool recibir_respuesta_storage_simple(t_log* logger, int socket) {
     }
 }
 
+// Envía el pedido de una página (OP_READ + file_tag + nro de bloque) sin esperar la respuesta.
+// Devuelve el id del pedido, o 0 si no se pudo enviar.
+uint32_t enviar_pedido_pagina_storage(const char* file_tag, uint32_t nro_pagina) {
+    t_trama* pedido = iniciar_pedido_storage(OP_READ);
+    trama_agregar_string_red(pedido, file_tag);
+    trama_agregar_uint32_red(pedido, nro_pagina);
+
+    uint32_t id_pedido;
+    if (!enviar_pedido_storage(pedido, &id_pedido)) {
+        return 0;
+    }
+
+    log_debug(logger, "Solicitado bloque %u para %s (pedido %u)", nro_pagina, file_tag, id_pedido);
+    return id_pedido;
+}
+
 // Función para recibir página del Storage (para READ/WRITE)
-t_buffer* recibir_pagina_storage(t_log* logger, int socket) {
-    // Primero recibir el código de operación
-    int cod_op_network;
-    ssize_t bytes_recv = recv(socket, &cod_op_network, sizeof(int), MSG_WAITALL);
+t_buffer* recibir_pagina_storage(t_log* logger, uint32_t id_pedido) {
+    t_respuesta_storage* respuesta = storage_esperar_respuesta(id_pedido);
     
-    if (bytes_recv <= 0) {
+    if (!respuesta) {
         log_error(logger, "Error al recibir código OP del Storage");
         return NULL;
     }
     
-    int cod_op = ntohl(cod_op_network);
-    log_info(logger, "Storage respondió con código: %d", cod_op);
+    int cod_op = respuesta->estado;
+    log_info(logger, "Storage respondió con código: %d (pedido %u)", cod_op, id_pedido);
     
     if (cod_op == OP_ERROR) {
         log_warning(logger, "Storage respondió con error - operación no realizada");
+        destruir_respuesta_storage(respuesta);
         return NULL;
     }
     
     if (cod_op != OP_OK) {
         log_error(logger, "Código OP inesperado del Storage: %d (esperaba %d)", 
                  cod_op, OP_OK);
+        destruir_respuesta_storage(respuesta);
         return NULL;
     }
     
-    // Recibir tamaño del buffer
-    uint32_t size_network;
-    bytes_recv = recv(socket, &size_network, sizeof(uint32_t), MSG_WAITALL);
-    
-    if (bytes_recv <= 0) {
-        log_error(logger, "Error al recibir tamaño del buffer");
-        return NULL;
-    }
-    
-    uint32_t size = ntohl(size_network);
-    log_info(logger, "Tamaño de página recibida: %u bytes", size);
-    
-    // VERIFICACIÓN CRÍTICA: Si el tamaño es incorrecto, usar el tamaño esperado
-    uint32_t expected_size = WORKER_BLOCK_SIZE;
-    if (size != expected_size) {
-        log_error(logger, "Tamaño incorrecto: recibido=%u, esperado=%u. Usando tamaño esperado.", 
-                 size, expected_size);
-        size = expected_size; // Forzar el tamaño correcto
-    }
-    
-    if (size == 0) {
+    t_buffer* buffer = respuesta->payload;
+    respuesta->payload = NULL;
+    destruir_respuesta_storage(respuesta);
+
+    if (!buffer) {
         log_warning(logger, "Storage devolvió tamaño 0 - página vacía");
-        t_buffer* buffer = malloc(sizeof(t_buffer));
+        buffer = malloc(sizeof(t_buffer));
         buffer->size = 0;
         buffer->stream = NULL;
         return buffer;
     }
     
-    if (size > 1000000) {
-        log_error(logger, "Tamaño de página excesivo: %u bytes", size);
-        return NULL;
-    }
-    
-    // Recibir datos
-    t_buffer* buffer = malloc(sizeof(t_buffer));
-    if (!buffer) {
-        log_error(logger, "Error al allocar buffer");
-        return NULL;
-    }
-    
-    buffer->size = size;
-    buffer->stream = malloc(size);
-    
-    if (!buffer->stream) {
-        log_error(logger, "Error al allocar stream del buffer");
-        free(buffer);
-        return NULL;
-    }
-    
-    // RECIBIR EXACTAMENTE 'size' BYTES
-    bytes_recv = recv(socket, buffer->stream, size, MSG_WAITALL);
-    if (bytes_recv != (ssize_t)size) {
-        log_error(logger, "Error al recibir datos: %zd bytes de %u", bytes_recv, size);
-        free(buffer->stream);
+    // VERIFICACIÓN CRÍTICA: el bloque tiene que medir lo que anunció el Storage en el handshake
+    if (buffer->size != WORKER_BLOCK_SIZE) {
+        log_error(logger, "Tamaño incorrecto: recibido=%u, esperado=%u", 
+                 buffer->size, WORKER_BLOCK_SIZE);
+        pool_buffers_devolver(buffer->stream);
         free(buffer);
         return NULL;
     }
     
-    log_info(logger, "Página recibida exitosamente: %u bytes", size);
+    log_info(logger, "Página recibida exitosamente: %u bytes", buffer->size);
     return buffer;
 }